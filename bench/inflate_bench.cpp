@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include <wz/Canvas.hpp>
+#include <wz/File.hpp>
+#include <wz/Inflate.hpp>
+#include <wz/Node.hpp>
+#include <wz/Property.hpp>
+
+// 对比stock zlib与当前inflate后端在一个wz文件全部画布上的解压吞吐，后端为zlib时只测read_raw_data
+// 用法: wzinflatebench <file.wz> [iv: gms|kms|8位十六进制, 默认00000000] [iterations]
+
+namespace
+{
+    template <typename Fn>
+    double measure(int iterations, Fn&& fn)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+            fn();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / iterations;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::printf("usage: %s <file.wz> [iv] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    wz::File   file(wz::keys::parse_iv(argc > 2 ? argv[2] : "00000000"), argv[1]);
+    const auto iterations = argc > 3 ? std::atoi(argv[3]) : 3;
+    if (!file.parse())
+    {
+        std::printf("failed to parse %s\n", argv[1]);
+        return 1;
+    }
+
+    const auto canvases = wz::collect_canvases(file.get_root());
+
+    size_t compressed = 0, inflated = 0, plain = 0;
+    for (auto* canvas : canvases)
+    {
+        compressed += canvas->get().size;
+        inflated += canvas->get().uncompressed_size;
+        plain += canvas->get().is_encrypted ? 0 : 1;
+    }
+
+    std::vector<u8> buffer;
+    for (auto* canvas : canvases)
+    {
+        buffer.resize(std::max<size_t>(buffer.size(), canvas->get().uncompressed_size));
+    }
+
+    std::printf("canvases: %zu (%zu unencrypted), compressed %.2f MiB, inflated %.2f MiB\n",
+                canvases.size(),
+                plain,
+                compressed / 1048576.0,
+                inflated / 1048576.0);
+
+    size_t plain_inflated = 0;
+    for (auto* canvas : canvases)
+    {
+        plain_inflated += canvas->get().is_encrypted ? 0 : canvas->get().uncompressed_size;
+    }
+
+    // stock zlib与当前后端只比较未加密画布，输入完全相同；后端本身就是zlib时没有可比较的对象
+    const bool compare = std::string(wz::inflate::backend()) != "zlib";
+    if (!compare)
+    {
+        std::printf("inflate backend is zlib, skipping the stock zlib comparison "
+                    "(configure with -DWZLIB_INFLATE_BACKEND=libdeflate)\n");
+    }
+
+    const auto stock = !compare ? 0.0 : measure(iterations, [&] {
+        for (auto* canvas : canvases)
+        {
+            const auto& c = canvas->get();
+            if (c.is_encrypted)
+                continue;
+            uLongf out_len = c.uncompressed_size;
+            uncompress(buffer.data(), &out_len, canvas->reader->data(c.offset), c.size);
+        }
+    });
+
+    const auto backend = !compare ? 0.0 : measure(iterations, [&] {
+        for (auto* canvas : canvases)
+        {
+            const auto& c = canvas->get();
+            if (c.is_encrypted)
+                continue;
+            (void) wz::inflate::decompress(canvas->reader->data(c.offset), c.size, buffer.data(), c.uncompressed_size);
+        }
+    });
+
+    const auto all = measure(iterations, [&] {
+        for (auto* canvas : canvases)
+        {
+            (void) canvas->read_raw_data(buffer.data(), buffer.size());
+        }
+    });
+
+    if (compare)
+    {
+        std::printf(
+            "%-24s %10.3f ms %10.1f MiB/s\n", "zlib uncompress", stock * 1e3, plain_inflated / 1048576.0 / stock);
+        std::printf("%-24s %10.3f ms %10.1f MiB/s\n",
+                    (std::string("backend ") + wz::inflate::backend()).c_str(),
+                    backend * 1e3,
+                    plain_inflated / 1048576.0 / backend);
+    }
+    std::printf("%-24s %10.3f ms %10.1f MiB/s\n", "read_raw_data (all)", all * 1e3, inflated / 1048576.0 / all);
+
+    return 0;
+}
@@ -0,0 +1,494 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <wz/Canvas.hpp>
+#include <wz/Directory.hpp>
+#include <wz/File.hpp>
+#include <wz/Generate.hpp>
+#include <wz/Inflate.hpp>
+#include <wz/Pixel.hpp>
+#include <wz/Property.hpp>
+
+// 解析热点的微基准，运行在启动时生成的合成wz文件上
+// 用法: wzbench [Google Benchmark参数]；未指定--benchmark_format时输出JSON
+// 例如 wzbench --benchmark_filter=Canvas --benchmark_out=result.json --benchmark_out_format=json
+
+namespace
+{
+    const std::array<u8, 4> bench_iv {0x4D, 0x23, 0xC7, 0x2B};
+    constexpr i16           bench_version = 95;
+    constexpr i16           version_cases[] = {83, 176, 1000};
+
+    std::unique_ptr<wz::File> open(const std::string& path)
+    {
+        auto file = std::make_unique<wz::File>(bench_iv, path.c_str());
+        if (!file->parse())
+            return nullptr;
+        return file;
+    }
+
+    std::vector<u8> aes_key()
+    {
+        return {wz::AesKey2, wz::AesKey2 + 32};
+    }
+
+    // 启动时生成的测试数据，全部基准共用
+    struct Archives
+    {
+        std::filesystem::path directory;
+
+        std::string strings;    // 按长度与编码分段的wz字符串
+        std::string integers;   // 1字节与5字节的压缩整数
+        std::string directories; // 目录多、image小
+        std::string small;      // 每个image 1个画布
+        std::string large;      // 每个image 48个画布与4个声音
+
+        size_t directory_images = 0;
+
+        // 根目录下只有一个小image的归档，按文件头中的版本号，测量File::parse的版本探测
+        std::map<i64, std::string> headers;
+
+        static Archives& get()
+        {
+            static Archives archives;
+            return archives;
+        }
+    };
+
+    // 与Reader::read_wz_string对应的编码，只用于生成基准数据
+    void encode_string(std::vector<u8>& out, wz::MutableKey& key, size_t length, bool unicode)
+    {
+        if (!unicode)
+        {
+            if (length < 128)
+            {
+                out.push_back(static_cast<u8>(-static_cast<i8>(length)));
+            }
+            else
+            {
+                out.push_back(0x80);
+                const auto value = static_cast<i32>(length);
+                out.insert(out.end(), reinterpret_cast<const u8*>(&value), reinterpret_cast<const u8*>(&value) + 4);
+            }
+            u8 mask = 0xAA;
+            for (size_t i = 0; i < length; ++i)
+            {
+                out.push_back(static_cast<u8>(('a' + i % 26) ^ mask++ ^ key[i]));
+            }
+            return;
+        }
+
+        if (length < 127)
+        {
+            out.push_back(static_cast<u8>(length));
+        }
+        else
+        {
+            out.push_back(127);
+            const auto value = static_cast<i32>(length);
+            out.insert(out.end(), reinterpret_cast<const u8*>(&value), reinterpret_cast<const u8*>(&value) + 4);
+        }
+        u16 mask = 0xAAAA;
+        for (size_t i = 0; i < length; ++i)
+        {
+            const u16 unit = static_cast<u16>((0x4E00 + i) ^ mask++ ^ (key[2 * i] | (key[2 * i + 1] << 8)));
+            out.push_back(static_cast<u8>(unit));
+            out.push_back(static_cast<u8>(unit >> 8));
+        }
+    }
+
+    constexpr size_t string_count  = 1024;
+    constexpr size_t integer_count = 4096;
+    const size_t     string_lengths[] = {4, 16, 64, 256};
+
+    // 字符串文件中每段的起点：[编码][长度]
+    size_t string_offsets[2][std::size(string_lengths)];
+
+    bool prepare(Archives& archives)
+    {
+        archives.directory = std::filesystem::temp_directory_path() / ("wzbench-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        std::filesystem::create_directories(archives.directory);
+
+        wz::MutableKey key({bench_iv[0], bench_iv[1], bench_iv[2], bench_iv[3]}, aes_key());
+
+        std::vector<u8> strings;
+        for (int unicode = 0; unicode < 2; ++unicode)
+        {
+            for (size_t n = 0; n < std::size(string_lengths); ++n)
+            {
+                string_offsets[unicode][n] = strings.size();
+                for (size_t i = 0; i < string_count; ++i)
+                {
+                    encode_string(strings, key, string_lengths[n], unicode != 0);
+                }
+            }
+        }
+        archives.strings = (archives.directory / "strings.bin").string();
+        std::ofstream(archives.strings, std::ios::binary).write(reinterpret_cast<const char*>(strings.data()), strings.size());
+
+        // 前半为1字节形式，后半为5字节形式
+        std::vector<u8> integers;
+        for (size_t i = 0; i < integer_count; ++i)
+        {
+            integers.push_back(static_cast<u8>(i % 200 - 100));
+        }
+        for (size_t i = 0; i < integer_count; ++i)
+        {
+            const auto value = static_cast<i32>(i * 7919 + 1000);
+            integers.push_back(0x80);
+            integers.insert(integers.end(), reinterpret_cast<const u8*>(&value), reinterpret_cast<const u8*>(&value) + 4);
+        }
+        archives.integers = (archives.directory / "integers.bin").string();
+        std::ofstream(archives.integers, std::ios::binary).write(reinterpret_cast<const char*>(integers.data()), integers.size());
+
+        wz::GeneratorOptions options;
+        options.iv      = bench_iv;
+        options.version = bench_version;
+
+        for (const i16 version : version_cases)
+        {
+            auto header     = options;
+            header.version  = version;
+            header.depth    = 0;
+            header.images   = 1;
+            header.canvases = 0;
+            header.sounds   = 0;
+            archives.headers[version] = (archives.directory / ("header-" + std::to_string(version) + ".wz")).string();
+            if (!wz::generate_archive(archives.headers[version], header, nullptr))
+                return false;
+        }
+
+        auto tree     = options;
+        tree.depth    = 3;
+        tree.fanout   = 8;
+        tree.images   = 8;
+        tree.canvases = 1;
+        tree.sounds   = 0;
+        archives.directories = (archives.directory / "directories.wz").string();
+        wz::GeneratorResult result;
+        if (!wz::generate_archive(archives.directories, tree, &result))
+            return false;
+        archives.directory_images = result.images;
+
+        auto small     = options;
+        small.depth    = 1;
+        small.fanout   = 4;
+        small.images   = 16;
+        small.canvases = 1;
+        small.sounds   = 0;
+        archives.small = (archives.directory / "small.wz").string();
+        if (!wz::generate_archive(archives.small, small, nullptr))
+            return false;
+
+        auto large          = options;
+        large.depth         = 1;
+        large.fanout        = 2;
+        large.images        = 4;
+        large.canvases      = 48;
+        large.sounds        = 4;
+        large.canvas_width  = 256;
+        large.canvas_height = 256;
+        archives.large      = (archives.directory / "large.wz").string();
+        return wz::generate_archive(archives.large, large, nullptr);
+    }
+
+    // ---- Reader ----
+
+    void BM_ReadWzString(benchmark::State& state)
+    {
+        const auto     unicode = state.range(0) != 0;
+        const auto     index   = static_cast<size_t>(state.range(1));
+        wz::MutableKey key({bench_iv[0], bench_iv[1], bench_iv[2], bench_iv[3]}, aes_key());
+        wz::Reader     reader(key, Archives::get().strings.c_str());
+        key.ensure(string_lengths[index] * 2);
+
+        size_t units = 0;
+        for (auto _ : state)
+        {
+            reader.set_position(string_offsets[unicode][index]);
+            for (size_t i = 0; i < string_count; ++i)
+            {
+                auto text = reader.read_wz_string();
+                units += text.size();
+                benchmark::DoNotOptimize(text);
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * string_count));
+        state.counters["chars/s"] = benchmark::Counter(static_cast<double>(units), benchmark::Counter::kIsRate);
+        state.SetLabel(std::string(unicode ? "utf16/" : "ascii/") + std::to_string(string_lengths[index]));
+    }
+    BENCHMARK(BM_ReadWzString)->ArgsProduct({{0, 1}, {0, 1, 2, 3}});
+
+    void BM_ReadCompressedInt(benchmark::State& state)
+    {
+        const auto     wide = state.range(0) != 0;
+        wz::MutableKey key;
+        wz::Reader     reader(key, Archives::get().integers.c_str());
+
+        for (auto _ : state)
+        {
+            reader.set_position(wide ? integer_count : 0);
+            i64 sum = 0;
+            for (size_t i = 0; i < integer_count; ++i)
+            {
+                sum += reader.read_compressed_int();
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * integer_count));
+        state.SetLabel(wide ? "5 bytes" : "1 byte");
+    }
+    BENCHMARK(BM_ReadCompressedInt)->Arg(0)->Arg(1);
+
+    // ---- 密钥与版本 ----
+
+    // 从空密钥流扩展到range(0)字节，AES生成的开销
+    void BM_MutableKeyGrowth(benchmark::State& state)
+    {
+        const auto size = static_cast<size_t>(state.range(0));
+        const auto aes  = aes_key();
+        for (auto _ : state)
+        {
+            wz::MutableKey key({bench_iv[0], bench_iv[1], bench_iv[2], bench_iv[3]}, aes);
+            key.ensure(size);
+            benchmark::DoNotOptimize(key[size - 1]);
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+    }
+    BENCHMARK(BM_MutableKeyGrowth)->Arg(0x10000)->Arg(0x40000)->Arg(0x100000)->Unit(benchmark::kMicrosecond);
+
+    void BM_GetVersionHash(benchmark::State& state)
+    {
+        i32 version = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(wz::get_version_hash(0x40, version));
+            version = (version + 1) & 0x7FFF;
+        }
+    }
+    BENCHMARK(BM_GetVersionHash);
+
+    // File::parse的版本探测：对每个版本哈希吻合的候选版本试解析目录表，直到成功
+    // 根目录只有一个小image，计时主要是探测本身；不含File的构造
+    void BM_VersionDetection(benchmark::State& state)
+    {
+        const auto& path = Archives::get().headers.at(state.range(0));
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            wz::File file(bench_iv, path.c_str());
+            state.ResumeTiming();
+
+            if (!file.parse())
+            {
+                state.SkipWithError("parse failed");
+                break;
+            }
+            benchmark::DoNotOptimize(file.get_root());
+        }
+    }
+    BENCHMARK(BM_VersionDetection)
+        ->Arg(version_cases[0])
+        ->Arg(version_cases[1])
+        ->Arg(version_cases[2])
+        ->Unit(benchmark::kMillisecond);
+
+    // ---- 目录与image ----
+
+    // File::parse：读取文件头、版本探测与完整的目录表解析
+    void BM_ParseDirectories(benchmark::State& state)
+    {
+        const auto& archives = Archives::get();
+        for (auto _ : state)
+        {
+            auto file = open(archives.directories);
+            if (file == nullptr)
+            {
+                state.SkipWithError("parse failed");
+                break;
+            }
+            benchmark::DoNotOptimize(file->get_root());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * archives.directory_images));
+        state.SetLabel(std::to_string(archives.directory_images) + " images");
+    }
+    BENCHMARK(BM_ParseDirectories)->Unit(benchmark::kMillisecond);
+
+    // Node::parse_property_list：每次解析到临时节点树，不经过File的image缓存
+    void BM_ParsePropertyList(benchmark::State& state)
+    {
+        const auto large = state.range(0) != 0;
+        auto       file  = open(large ? Archives::get().large : Archives::get().small);
+        if (file == nullptr)
+        {
+            state.SkipWithError("parse failed");
+            return;
+        }
+        const auto list = wz::collect_images(file->get_root());
+
+        size_t n = 0, bytes = 0;
+        for (auto _ : state)
+        {
+            auto*    dir = list[n++ % list.size()];
+            wz::Node image;
+            image.file = file.get();
+            if (!dir->parse_image(&image))
+            {
+                state.SkipWithError("parse_image failed");
+                break;
+            }
+            bytes += dir->get_size();
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(bytes));
+        state.SetLabel(large ? "large" : "small");
+    }
+    BENCHMARK(BM_ParsePropertyList)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+    // find_from_path：image已缓存，只测路径拆分与逐级查找
+    void BM_FindFromPath(benchmark::State& state)
+    {
+        auto file = open(Archives::get().directories);
+        if (file == nullptr)
+        {
+            state.SkipWithError("parse failed");
+            return;
+        }
+
+        std::vector<std::u16string> paths;
+        for (auto* dir : wz::collect_images(file->get_root()))
+        {
+            // 去掉根节点名称，得到相对根节点的路径
+            auto path = dir->path.substr(dir->path.find(u'/') + 1);
+            paths.push_back(path + u"/frames/0/origin");
+            paths.push_back(path + u"/info/name");
+            (void) file->load_image(dir);
+        }
+
+        size_t n = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(file->get_root()->find_from_path(paths[n++ % paths.size()]));
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+    BENCHMARK(BM_FindFromPath);
+
+    // ---- 画布 ----
+
+    struct CanvasCase
+    {
+        std::unique_ptr<wz::File>             file;
+        std::vector<wz::Property<wz::WzCanvas>*> canvases;
+    };
+
+    CanvasCase& canvas_case()
+    {
+        static CanvasCase instance = [] {
+            CanvasCase result;
+            result.file = open(Archives::get().large);
+            if (result.file != nullptr)
+                result.canvases = wz::collect_canvases(result.file->get_root());
+            return result;
+        }();
+        return instance;
+    }
+
+    wz::Property<wz::WzCanvas>* find_canvas(i32 format, bool encrypted)
+    {
+        for (auto* canvas : canvas_case().canvases)
+        {
+            const auto& info = canvas->get();
+            if (info.format + info.format2 == format && info.is_encrypted == encrypted)
+                return canvas;
+        }
+        return nullptr;
+    }
+
+    // 只解压，输出原始像素格式
+    void BM_CanvasInflate(benchmark::State& state)
+    {
+        auto* canvas = find_canvas(static_cast<i32>(state.range(0)), state.range(1) != 0);
+        if (canvas == nullptr)
+        {
+            state.SkipWithError("no canvas with this format");
+            return;
+        }
+
+        std::vector<u8> raw(canvas->get().uncompressed_size);
+        for (auto _ : state)
+        {
+            if (!canvas->read_raw_data(raw.data(), raw.size()))
+            {
+                state.SkipWithError("inflate failed");
+                break;
+            }
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * raw.size()));
+        state.SetLabel(std::string(wz::inflate::backend()) + (state.range(1) != 0 ? " encrypted" : " plain"));
+    }
+    BENCHMARK(BM_CanvasInflate)->ArgsProduct({{1, 2, 513, 517, 1026, 2050}, {0, 1}})->Unit(benchmark::kMicrosecond);
+
+    // 解压并转换为RGBA8888，吞吐按输出字节计
+    void BM_CanvasDecode(benchmark::State& state)
+    {
+        auto* canvas = find_canvas(static_cast<i32>(state.range(0)), false);
+        if (canvas == nullptr)
+        {
+            state.SkipWithError("no canvas with this format");
+            return;
+        }
+
+        std::vector<u8> pixels(wz::pixel::decoded_size(canvas->get()));
+        for (auto _ : state)
+        {
+            if (!canvas->decode(pixels.data(), pixels.size()))
+            {
+                state.SkipWithError("decode failed");
+                break;
+            }
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * pixels.size()));
+    }
+    BENCHMARK(BM_CanvasDecode)->Arg(1)->Arg(2)->Arg(513)->Arg(517)->Arg(1026)->Arg(2050)->Unit(benchmark::kMicrosecond);
+}
+
+int main(int argc, char** argv)
+{
+    // 默认输出JSON，便于在不同版本之间比较
+    std::vector<char*> args(argv, argv + argc);
+    std::string        json = "--benchmark_format=json";
+    if (std::none_of(args.begin(), args.end(), [](const char* arg) { return std::strncmp(arg, "--benchmark_format", 18) == 0; }))
+        args.push_back(json.data());
+    int count = static_cast<int>(args.size());
+
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+        return 1;
+
+    auto& archives = Archives::get();
+    if (!prepare(archives))
+    {
+        std::fprintf(stderr, "failed to generate benchmark archives in %s\n", archives.directory.string().c_str());
+        return 1;
+    }
+
+    benchmark::AddCustomContext("inflate_backend", wz::inflate::backend());
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    std::error_code error;
+    std::filesystem::remove_all(archives.directory, error);
+    return 0;
+}
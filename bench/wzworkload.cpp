@@ -0,0 +1,743 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <wz/Canvas.hpp>
+#include <wz/Directory.hpp>
+#include <wz/File.hpp>
+#include <wz/Generate.hpp>
+#include <wz/Hash.hpp>
+#include <wz/Inflate.hpp>
+#include <wz/Json.hpp>
+#include <wz/Pixel.hpp>
+#include <wz/Property.hpp>
+
+// 模拟真实访问模式的端到端负载，报告延迟分位数、吞吐、峰值RSS与缺页次数
+// 用法: wzworkload [file.wz ...] [--iv gms|kms|<hex>] [--threads N] [--paths N] [--maps N] [--mobs N]
+//                  [--seed N] [--workloads resolve,map,mob,scan] [--text]
+// 未给出文件时在临时目录中生成Map.wz、Mob.wz与Character.wz。
+// 地图从文件名以Map开头的文件中选取，怪物从以Mob开头的文件中选取，没有这样的文件时从全部文件中选取。
+// 每个负载分别以1个线程与N个线程在独立的子进程中运行，从打开文件开始，除页缓存外不共享任何状态。
+//
+// resolve: 打开全部文件，按路径查找N个随机image
+// map:     加载地图image，以及它通过bS、tS、oS或同名字符串引用的Back、Tile、Obj image，解码引用到的全部画布
+// mob:     加载K个怪物image并解码全部动画帧
+// scan:    加载全部文件的每个image，解压全部画布并读取全部声音数据
+
+namespace
+{
+    struct Options
+    {
+        std::vector<std::string> archives;
+        std::array<u8, 4>        iv {0, 0, 0, 0};
+        size_t                   threads = std::max(1u, std::thread::hardware_concurrency());
+        size_t                   paths   = 1000;
+        size_t                   maps    = 20;
+        size_t                   mobs    = 20;
+        u64                      seed    = 1;
+        std::vector<std::string> workloads {"resolve", "map", "mob", "scan"};
+        bool                     text = false;
+    };
+
+    // 子进程通过管道按字节传回，只含数值字段
+    struct Result
+    {
+        size_t threads    = 0;
+        size_t operations = 0;
+        double open_ms    = 0;
+        double wall_ms    = 0;
+        u64    input_bytes   = 0; // 访问到的image字节数(目录项记录的大小)
+        u64    decoded_bytes = 0; // 解码或解压得到的字节数
+        double p50_us  = 0;
+        double p99_us  = 0;
+        double max_us  = 0;
+        double mean_us = 0;
+        long   peak_rss_kib = 0;
+        long   minor_faults = 0;
+        long   major_faults = 0;
+        bool   ok           = false;
+    };
+
+    struct Report
+    {
+        std::string workload;
+        Result      result;
+    };
+
+    struct Image
+    {
+        wz::Directory *dir;
+        wz::wzstring       path; // 相对文件根目录，可直接用于find_from_path
+    };
+
+    struct Archive
+    {
+        std::string               path;
+        std::string               name; // 不含目录的文件名
+        std::unique_ptr<wz::File> file;
+        std::vector<Image>        images;
+
+        // 按名称(不含.img)与按"所在目录/名称"索引image，同名时保留先出现的
+        std::unordered_map<wz::wzstring, wz::Directory *> by_stem;
+        std::unordered_map<wz::wzstring, wz::Directory *> by_category;
+    };
+
+    std::vector<std::string> split(const std::string& text, char separator)
+    {
+        std::vector<std::string> parts;
+        size_t                   start = 0;
+        while (start <= text.size())
+        {
+            const auto end = std::min(text.find(separator, start), text.size());
+            if (end > start)
+                parts.push_back(text.substr(start, end - start));
+            start = end + 1;
+        }
+        return parts;
+    }
+
+    wz::wzstring widen(const std::string& text)
+    {
+        return {text.begin(), text.end()};
+    }
+
+    wz::wzstring stem(const wz::wzstring& name)
+    {
+        return name.size() > 4 && name.compare(name.size() - 4, 4, u".img") == 0 ? name.substr(0, name.size() - 4) : name;
+    }
+
+    void collect_images(wz::Node* node, const wz::wzstring& prefix, const wz::wzstring& category, Archive& archive)
+    {
+        for (auto& [name, list] : *node)
+        {
+            for (auto* child : list)
+            {
+                auto* dir = dynamic_cast<wz::Directory*>(child);
+                if (dir == nullptr)
+                    continue;
+
+                const auto path = prefix.empty() ? name : prefix + u"/" + name;
+                if (dir->is_image())
+                {
+                    archive.images.push_back({dir, path});
+                    archive.by_stem.try_emplace(stem(name), dir);
+                    archive.by_category.try_emplace(category + u"/" + stem(name), dir);
+                }
+                else
+                {
+                    collect_images(dir, path, name, archive);
+                }
+            }
+        }
+    }
+
+    bool open_archives(const Options& options, std::vector<Archive>& archives, wz::ThreadPool& pool)
+    {
+        archives.resize(options.archives.size());
+        std::vector<char> opened(archives.size(), 0);
+        pool.parallel_for(archives.size(), [&](size_t i) {
+            auto& archive = archives[i];
+            archive.path  = options.archives[i];
+            archive.name  = std::filesystem::path(archive.path).filename().string();
+            archive.file  = std::make_unique<wz::File>(options.iv, archive.path.c_str());
+            if (!archive.file->parse())
+                return;
+            collect_images(archive.file->get_root(), u"", u"", archive);
+            opened[i] = 1;
+        });
+        return std::all_of(opened.begin(), opened.end(), [](char ok) { return ok != 0; });
+    }
+
+    // 文件名以prefix开头的文件中的全部image；没有这样的文件时返回全部image
+    std::vector<std::pair<Archive*, const Image*>> role_images(std::vector<Archive>& archives, const std::string& prefix)
+    {
+        std::vector<std::pair<Archive*, const Image*>> all, matched;
+        for (auto& archive : archives)
+        {
+            const bool match = archive.name.compare(0, prefix.size(), prefix) == 0;
+            for (const auto& image : archive.images)
+            {
+                all.emplace_back(&archive, &image);
+                if (match)
+                    matched.emplace_back(&archive, &image);
+            }
+        }
+        return matched.empty() ? all : matched;
+    }
+
+    template <typename T>
+    std::vector<T> pick(const std::vector<T>& items, size_t count, u64 seed)
+    {
+        std::vector<T> picked;
+        if (items.empty())
+            return picked;
+        std::mt19937_64 random(seed);
+        for (size_t i = 0; i < count; ++i)
+        {
+            picked.push_back(items[random() % items.size()]);
+        }
+        return picked;
+    }
+
+    wz::wzstring string_value(wz::Node* node, const wz::wzstring& name)
+    {
+        auto* child = node->get_child(name);
+        if (child == nullptr)
+            return {};
+        if (child->type == wz::Type::String)
+            return dynamic_cast<wz::Property<wz::wzstring>*>(child)->get();
+        if (child->type == wz::Type::Int)
+            return widen(std::to_string(dynamic_cast<wz::Property<i32>*>(child)->get()));
+        if (child->type == wz::Type::UnsignedShort)
+            return widen(std::to_string(dynamic_cast<wz::Property<u16>*>(child)->get()));
+        return {};
+    }
+
+    // 地图引用的素材：分类(Back/Tile/Obj，为空时只按名称查找)、image名称与image内的路径(为空表示整个image)
+    struct Reference
+    {
+        wz::wzstring category;
+        wz::wzstring name;
+        wz::wzstring subpath;
+
+        bool operator<(const Reference& other) const
+        {
+            return std::tie(category, name, subpath) < std::tie(other.category, other.name, other.subpath);
+        }
+    };
+
+    void collect_generic_references(wz::Node* node, std::set<Reference>& out)
+    {
+        for (auto& [name, list] : *node)
+        {
+            for (auto* child : list)
+            {
+                if (child->type == wz::Type::String && name != u"bS" && name != u"tS" && name != u"oS")
+                    out.insert({u"", dynamic_cast<wz::Property<wz::wzstring>*>(child)->get(), u""});
+                collect_generic_references(child, out);
+            }
+        }
+    }
+
+    // Map.wz的地图image：back/N/{bS,ani,no}、层N/info/tS与tile/N/{u,no}、层N/obj/N/{oS,l0,l1,l2}；
+    // 其他字符串值与某个image同名时视为对整个image的引用
+    std::set<Reference> collect_references(wz::Node* map)
+    {
+        std::set<Reference> references;
+        if (auto* back = map->get_child(u"back"))
+        {
+            for (auto& [_, list] : *back)
+            {
+                for (auto* item : list)
+                {
+                    const auto name = string_value(item, u"bS");
+                    if (!name.empty())
+                        references.insert({u"Back", name, (string_value(item, u"ani") == u"1" ? u"ani/" : u"back/") + string_value(item, u"no")});
+                }
+            }
+        }
+        for (int layer = 0; layer < 8; ++layer)
+        {
+            auto* node = map->get_child(std::to_string(layer));
+            if (node == nullptr)
+                continue;
+
+            const auto tile_set = node->get_child(u"info") ? string_value(node->get_child(u"info"), u"tS") : wz::wzstring {};
+            if (auto* tiles = node->get_child(u"tile"); tiles != nullptr && !tile_set.empty())
+            {
+                for (auto& [_, list] : *tiles)
+                {
+                    for (auto* tile : list)
+                        references.insert({u"Tile", tile_set, string_value(tile, u"u") + u"/" + string_value(tile, u"no")});
+                }
+            }
+            if (auto* objects = node->get_child(u"obj"))
+            {
+                for (auto& [_, list] : *objects)
+                {
+                    for (auto* object : list)
+                    {
+                        const auto name = string_value(object, u"oS");
+                        if (!name.empty())
+                            references.insert({u"Obj", name,
+                                               string_value(object, u"l0") + u"/" + string_value(object, u"l1") + u"/" +
+                                                   string_value(object, u"l2")});
+                    }
+                }
+            }
+        }
+        collect_generic_references(map, references);
+        return references;
+    }
+
+    // 先在地图所在的文件中查找，再按顺序查找其他文件
+    wz::Directory* find_reference(std::vector<Archive>& archives, Archive& home, const Reference& reference)
+    {
+        const auto key = reference.category.empty() ? reference.name : reference.category + u"/" + reference.name;
+        auto       find = [&](Archive& archive) -> wz::Directory* {
+            auto& index = reference.category.empty() ? archive.by_stem : archive.by_category;
+            auto  it    = index.find(key);
+            return it == index.end() ? nullptr : it->second;
+        };
+
+        if (auto* dir = find(home))
+            return dir;
+        for (auto& archive : archives)
+        {
+            if (&archive == &home)
+                continue;
+            if (auto* dir = find(archive))
+                return dir;
+        }
+        return nullptr;
+    }
+
+    // 通过File的画布缓存解码，与客户端绘制时相同；返回解码字节数
+    u64 decode_all(wz::Node* node)
+    {
+        u64 bytes = 0;
+        for (auto* canvas : wz::collect_canvases(node))
+        {
+            if (auto pixels = canvas->get_pixels())
+                bytes += pixels->size();
+        }
+        return bytes;
+    }
+
+    struct Measurement
+    {
+        std::vector<double> latencies; // 秒
+        std::vector<u64>    input;
+        std::vector<u64>    decoded;
+        double              wall = 0;
+
+        explicit Measurement(size_t count) : latencies(count), input(count), decoded(count) {}
+    };
+
+    template <typename Fn>
+    Measurement measure(size_t count, wz::ThreadPool& pool, Fn&& op)
+    {
+        Measurement result(count);
+        const auto  start = std::chrono::steady_clock::now();
+        pool.parallel_for(count, [&](size_t i) {
+            const auto                          begin   = std::chrono::steady_clock::now();
+            op(i, result.input[i], result.decoded[i]);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+            result.latencies[i]                         = elapsed.count();
+        });
+        const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+        result.wall                              = wall.count();
+        return result;
+    }
+
+    Measurement run_resolve(const Options& options, std::vector<Archive>& archives, wz::ThreadPool& pool)
+    {
+        const auto targets = pick(role_images(archives, ""), options.paths, options.seed);
+        return measure(targets.size(), pool, [&](size_t i, u64& input, u64&) {
+            auto [archive, image] = targets[i];
+            if (archive->file->get_root()->find_from_path(image->path) != nullptr)
+                input = static_cast<u64>(image->dir->get_size());
+        });
+    }
+
+    Measurement run_map(const Options& options, std::vector<Archive>& archives, wz::ThreadPool& pool)
+    {
+        const auto maps = pick(role_images(archives, "Map"), options.maps, options.seed);
+        return measure(maps.size(), pool, [&](size_t i, u64& input, u64& decoded) {
+            auto [archive, image] = maps[i];
+            auto* map             = archive->file->load_image(image->dir);
+            if (map == nullptr)
+                return;
+            input   = static_cast<u64>(image->dir->get_size());
+            decoded = decode_all(map);
+
+            std::set<wz::Directory*> loaded;
+            for (const auto& reference : collect_references(map))
+            {
+                auto* dir = find_reference(archives, *archive, reference);
+                if (dir == nullptr)
+                    continue;
+                auto* asset = dir->file->load_image(dir);
+                if (asset == nullptr)
+                    continue;
+                if (loaded.insert(dir).second)
+                    input += static_cast<u64>(dir->get_size());
+
+                auto* node = reference.subpath.empty() ? asset : asset->find_from_path(reference.subpath);
+                if (node != nullptr)
+                    decoded += decode_all(node);
+            }
+        });
+    }
+
+    Measurement run_mob(const Options& options, std::vector<Archive>& archives, wz::ThreadPool& pool)
+    {
+        const auto mobs = pick(role_images(archives, "Mob"), options.mobs, options.seed + 1);
+        return measure(mobs.size(), pool, [&](size_t i, u64& input, u64& decoded) {
+            auto [archive, image] = mobs[i];
+            auto* mob             = archive->file->load_image(image->dir);
+            if (mob == nullptr)
+                return;
+            input   = static_cast<u64>(image->dir->get_size());
+            decoded = decode_all(mob);
+        });
+    }
+
+    // 不经过画布缓存，只解压，避免缓存淘汰掩盖解压与解析本身的开销
+    Measurement run_scan(const Options&, std::vector<Archive>& archives, wz::ThreadPool& pool)
+    {
+        const auto images = role_images(archives, "");
+        return measure(images.size(), pool, [&](size_t i, u64& input, u64& decoded) {
+            auto [archive, image] = images[i];
+            auto* node            = archive->file->load_image(image->dir);
+            if (node == nullptr)
+                return;
+            input = static_cast<u64>(image->dir->get_size());
+
+            thread_local std::vector<u8> buffer;
+            for (auto* canvas : wz::collect_canvases(node))
+            {
+                const auto size = canvas->get().uncompressed_size;
+                buffer.resize(std::max<size_t>(buffer.size(), size));
+                if (canvas->read_raw_data(buffer.data(), buffer.size()))
+                    decoded += size;
+            }
+
+            // 声音只读取数据，哈希保证每一页都被访问
+            std::vector<wz::Node*> pending {node};
+            while (!pending.empty())
+            {
+                auto* current = pending.back();
+                pending.pop_back();
+                for (auto& [_, list] : *current)
+                {
+                    for (auto* child : list)
+                    {
+                        if (child->type == wz::Type::Sound)
+                        {
+                            const auto view = dynamic_cast<wz::Property<wz::WzSound>*>(child)->get_view();
+                            (void) wz::hash::xxh64(view.data, view.size);
+                            decoded += view.size;
+                        }
+                        pending.push_back(child);
+                    }
+                }
+            }
+        });
+    }
+
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+        const auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+        return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    Result run(const Options& options, const std::string& workload, size_t threads)
+    {
+        Result result;
+        result.threads = threads;
+
+        wz::ThreadPool       pool(threads);
+        std::vector<Archive> archives;
+
+        const auto open_start = std::chrono::steady_clock::now();
+        if (!open_archives(options, archives, pool))
+            return result;
+        const std::chrono::duration<double, std::milli> open = std::chrono::steady_clock::now() - open_start;
+        result.open_ms                                       = open.count();
+
+        Measurement measurement(0);
+        if (workload == "resolve")
+            measurement = run_resolve(options, archives, pool);
+        else if (workload == "map")
+            measurement = run_map(options, archives, pool);
+        else if (workload == "mob")
+            measurement = run_mob(options, archives, pool);
+        else if (workload == "scan")
+            measurement = run_scan(options, archives, pool);
+        else
+            return result;
+
+        auto latencies = measurement.latencies;
+        std::sort(latencies.begin(), latencies.end());
+        result.operations = latencies.size();
+        result.wall_ms    = measurement.wall * 1e3;
+        result.p50_us     = percentile(latencies, 0.50) * 1e6;
+        result.p99_us     = percentile(latencies, 0.99) * 1e6;
+        result.max_us     = latencies.empty() ? 0 : latencies.back() * 1e6;
+        for (auto latency : latencies)
+            result.mean_us += latency * 1e6 / static_cast<double>(latencies.size());
+        for (size_t i = 0; i < latencies.size(); ++i)
+        {
+            result.input_bytes += measurement.input[i];
+            result.decoded_bytes += measurement.decoded[i];
+        }
+
+#ifdef __linux__
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+        result.peak_rss_kib = usage.ru_maxrss;
+        result.minor_faults = usage.ru_minflt;
+        result.major_faults = usage.ru_majflt;
+#endif
+        result.ok = true;
+        return result;
+    }
+
+    // 在子进程中运行，峰值RSS与缺页次数只属于这一次运行
+    Result run_isolated(const Options& options, const std::string& workload, size_t threads)
+    {
+#ifdef __linux__
+        int fds[2];
+        if (pipe(fds) != 0)
+            return run(options, workload, threads);
+
+        const auto pid = fork();
+        if (pid == 0)
+        {
+            close(fds[0]);
+            const auto result = run(options, workload, threads);
+            (void) !write(fds[1], &result, sizeof(result));
+            close(fds[1]);
+            _exit(0);
+        }
+        close(fds[1]);
+
+        Result  result;
+        auto*   bytes = reinterpret_cast<char*>(&result);
+        size_t  total = 0;
+        ssize_t count = 0;
+        while (total < sizeof(result) && (count = read(fds[0], bytes + total, sizeof(result) - total)) > 0)
+            total += static_cast<size_t>(count);
+        close(fds[0]);
+
+        int status = 0;
+        if (pid > 0)
+            waitpid(pid, &status, 0);
+        if (pid < 0 || total != sizeof(result))
+        {
+            result         = Result {};
+            result.threads = threads;
+        }
+        return result;
+#else
+        return run(options, workload, threads);
+#endif
+    }
+
+    bool generate(const std::filesystem::path& directory, Options& options)
+    {
+        struct Spec
+        {
+            const char* name;
+            u32         depth, fanout, images, canvases, size, sounds;
+        };
+        // Map: 许多小image，互相引用；Mob: 每个image有较多动画帧；Character: 目录深、image多
+        const Spec specs[] = {
+            {"Map.wz", 2, 4, 12, 6, 64, 0},
+            {"Mob.wz", 1, 4, 16, 24, 128, 2},
+            {"Character.wz", 3, 6, 6, 3, 96, 0},
+        };
+
+        // 生成用的线程池在fork之前销毁
+        wz::ThreadPool pool;
+        for (const auto& spec : specs)
+        {
+            wz::GeneratorOptions generator;
+            generator.iv            = options.iv;
+            generator.depth         = spec.depth;
+            generator.fanout        = spec.fanout;
+            generator.images        = spec.images;
+            generator.canvases      = spec.canvases;
+            generator.canvas_width  = static_cast<i32>(spec.size);
+            generator.canvas_height = static_cast<i32>(spec.size);
+            generator.sounds        = spec.sounds;
+            generator.seed          = options.seed;
+
+            const auto path = (directory / spec.name).string();
+            if (!wz::generate_archive(path, generator, nullptr, pool))
+                return false;
+            options.archives.push_back(path);
+        }
+        return true;
+    }
+
+    void write_json(const Options& options, const std::vector<Report>& reports)
+    {
+        std::string out = "{\"context\":{\"archives\":[";
+        for (size_t i = 0; i < options.archives.size(); ++i)
+        {
+            if (i != 0)
+                out += ',';
+            wz::json::append_string(out, options.archives[i]);
+        }
+        out += "],\"threads\":" + std::to_string(options.threads) + ",\"seed\":" + std::to_string(options.seed) +
+               ",\"inflate_backend\":";
+        wz::json::append_string(out, std::string(wz::inflate::backend()));
+        out += "},\"results\":[";
+
+        for (size_t i = 0; i < reports.size(); ++i)
+        {
+            const auto& r       = reports[i].result;
+            const auto  seconds = r.wall_ms / 1e3;
+            if (i != 0)
+                out += ',';
+            out += "\n{\"workload\":";
+            wz::json::append_string(out, reports[i].workload);
+            out += ",\"threads\":" + std::to_string(r.threads) + ",\"ok\":" + (r.ok ? "true" : "false") +
+                   ",\"operations\":" + std::to_string(r.operations) + ",\"open_ms\":";
+            wz::json::append_number(out, r.open_ms, 6);
+            out += ",\"wall_ms\":";
+            wz::json::append_number(out, r.wall_ms, 6);
+            out += ",\"ops_per_second\":";
+            wz::json::append_number(out, seconds > 0 ? static_cast<double>(r.operations) / seconds : 0, 6);
+            out += ",\"input_bytes\":" + std::to_string(r.input_bytes) + ",\"decoded_bytes\":" + std::to_string(r.decoded_bytes) +
+                   ",\"input_mib_per_second\":";
+            wz::json::append_number(out, seconds > 0 ? static_cast<double>(r.input_bytes) / 1048576.0 / seconds : 0, 6);
+            out += ",\"latency_us\":{\"p50\":";
+            wz::json::append_number(out, r.p50_us, 6);
+            out += ",\"p99\":";
+            wz::json::append_number(out, r.p99_us, 6);
+            out += ",\"max\":";
+            wz::json::append_number(out, r.max_us, 6);
+            out += ",\"mean\":";
+            wz::json::append_number(out, r.mean_us, 6);
+            out += "},\"peak_rss_kib\":" + std::to_string(r.peak_rss_kib) + ",\"minor_faults\":" + std::to_string(r.minor_faults) +
+                   ",\"major_faults\":" + std::to_string(r.major_faults) + "}";
+        }
+        out += "\n]}\n";
+        std::fwrite(out.data(), 1, out.size(), stdout);
+    }
+
+    void write_text(const std::vector<Report>& reports)
+    {
+        std::printf("%-8s %7s %8s %10s %10s %10s %11s %11s %10s %10s %8s %10s\n", "workload", "threads", "ops", "open ms",
+                    "wall ms", "ops/s", "p50 us", "p99 us", "MiB/s", "RSS MiB", "majflt", "minflt");
+        for (const auto& [workload, r] : reports)
+        {
+            if (!r.ok)
+            {
+                std::printf("%-8s %7zu failed\n", workload.c_str(), r.threads);
+                continue;
+            }
+            const auto seconds = r.wall_ms / 1e3;
+            std::printf("%-8s %7zu %8zu %10.1f %10.1f %10.1f %11.1f %11.1f %10.1f %10.1f %8ld %10ld\n", workload.c_str(),
+                        r.threads, r.operations, r.open_ms, r.wall_ms,
+                        seconds > 0 ? static_cast<double>(r.operations) / seconds : 0, r.p50_us, r.p99_us,
+                        seconds > 0 ? static_cast<double>(r.input_bytes) / 1048576.0 / seconds : 0,
+                        static_cast<double>(r.peak_rss_kib) / 1024.0, r.major_faults, r.minor_faults);
+        }
+    }
+
+    void usage(const char* program)
+    {
+        std::printf("usage: %s [file.wz ...] [--iv gms|kms|<hex>] [--threads N] [--paths N] [--maps N] [--mobs N]\n"
+                    "       [--seed N] [--workloads resolve,map,mob,scan] [--text]\n",
+                    program);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--text")
+        {
+            options.text = true;
+            continue;
+        }
+        if (arg.compare(0, 2, "--") != 0)
+        {
+            options.archives.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+
+        const std::string value  = argv[++i];
+        const auto        number = std::strtoull(value.c_str(), nullptr, 10);
+        if (arg == "--iv")
+            options.iv = wz::keys::parse_iv(value);
+        else if (arg == "--threads")
+            options.threads = std::max<size_t>(1, number);
+        else if (arg == "--paths")
+            options.paths = number;
+        else if (arg == "--maps")
+            options.maps = number;
+        else if (arg == "--mobs")
+            options.mobs = number;
+        else if (arg == "--seed")
+            options.seed = number;
+        else if (arg == "--workloads")
+            options.workloads = split(value, ',');
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::filesystem::path generated;
+    if (options.archives.empty())
+    {
+        generated = std::filesystem::temp_directory_path() /
+                    ("wzworkload-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        std::filesystem::create_directories(generated);
+        if (!generate(generated, options))
+        {
+            std::fprintf(stderr, "failed to generate archives in %s\n", generated.string().c_str());
+            return 1;
+        }
+    }
+
+    std::vector<size_t> thread_counts {1};
+    if (options.threads > 1)
+        thread_counts.push_back(options.threads);
+
+    std::vector<Report> reports;
+    for (const auto& workload : options.workloads)
+    {
+        for (auto threads : thread_counts)
+        {
+            reports.push_back({workload, run_isolated(options, workload, threads)});
+        }
+    }
+
+    if (options.text)
+        write_text(reports);
+    else
+        write_json(options, reports);
+
+    if (!generated.empty())
+    {
+        std::error_code error;
+        std::filesystem::remove_all(generated, error);
+    }
+    return std::all_of(reports.begin(), reports.end(), [](const Report& r) { return r.result.ok; }) ? 0 : 1;
+}
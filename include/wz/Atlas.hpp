@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#include "Pixel.hpp"
+#include "Property.hpp"
+#include "ThreadPool.hpp"
+
+namespace wz
+{
+    struct AtlasOptions
+    {
+        i32         max_width  = 2048;
+        i32         max_height = 2048;
+        i32         padding    = 1; // 相邻画布之间留出的透明像素
+        PixelFormat format     = PixelFormat::RGBA8888;
+    };
+
+    // 一个画布在图集中的位置
+    struct AtlasEntry
+    {
+        Property<WzCanvas> *canvas = nullptr;
+        u32                 page   = 0;
+        i32                 x      = 0;
+        i32                 y      = 0;
+        i32                 width  = 0;
+        i32                 height = 0;
+        f32                 u0     = 0;
+        f32                 v0     = 0;
+        f32                 u1     = 0;
+        f32                 v1     = 0;
+        WzVec2D             origin; // 画布的origin子节点，不存在时为(0, 0)
+        bool                decoded = false;
+    };
+
+    struct AtlasPage
+    {
+        i32             width  = 0;
+        i32             height = 0;
+        std::vector<u8> pixels;
+    };
+
+    struct Atlas
+    {
+        std::vector<AtlasPage>  pages;
+        std::vector<AtlasEntry> entries; // 与输入的画布顺序一致
+    };
+
+    /**
+     * 将一组画布打包进一张或多张RGBA图集。
+     * 使用skyline算法，画布按(高, 宽, 文件偏移)排序后依次放置，相同输入总是得到相同的图集。
+     * 单个超过max_width/max_height的画布独占一页。解码与拷贝在线程池中并行进行，直接写入页面缓冲区。
+     */
+    [[nodiscard]] Atlas build_atlas(const std::vector<Property<WzCanvas> *> &canvases,
+                                    const AtlasOptions                      &options = {},
+                                    ThreadPool                              &pool    = ThreadPool::shared());
+}
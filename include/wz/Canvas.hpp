@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "Pixel.hpp"
+#include "Property.hpp"
+#include "ThreadPool.hpp"
+
+namespace wz
+{
+    class Directory;
+    class File;
+
+    // 压缩数据完全相同的画布统计
+    struct DuplicateReport
+    {
+        size_t canvases         = 0;
+        size_t unique           = 0; // 去重后剩余的不同内容数
+        u64    compressed_bytes = 0;
+        u64    compressed_saved = 0; // 重复画布的压缩数据字节数
+        u64    decoded_bytes    = 0;
+        u64    decoded_saved    = 0; // 共享像素缓冲区后省下的RGBA字节数
+    };
+
+    /**
+     * 并行解码一批画布。
+     * 每个输出缓冲区按width * height * 4预先分配，画布按其在文件中的偏移排序后分给线程池，
+     * 各线程直接从共享的mmap读取压缩数据，互不共享读取游标。
+     * @param canvases 要解码的画布节点
+     * @param outputs 与canvases一一对应的输出，解码失败的项被清空
+     * @param format 输出像素格式
+     * @param pool 执行解码的线程池
+     * @return 成功解码的画布数量
+     */
+    size_t decode_canvases(const std::vector<Property<WzCanvas> *> &canvases,
+                           std::vector<std::vector<u8>>            &outputs,
+                           PixelFormat                              format = PixelFormat::RGBA8888,
+                           ThreadPool                              &pool   = ThreadPool::shared());
+
+    // 收集node之下的所有画布，遇到image目录时通过File::load_image加载
+    [[nodiscard]] std::vector<Property<WzCanvas> *> collect_canvases(Node *node);
+
+    // 按目录树顺序收集node之下的所有image目录，不加载image
+    [[nodiscard]] std::vector<Directory *> collect_images(Node *node);
+
+    // 并行计算每个画布的content_hash，按(哈希, 压缩长度, 宽高, 原始格式)分组统计重复
+    [[nodiscard]] DuplicateReport find_duplicates(const std::vector<Property<WzCanvas> *> &canvases,
+                                                  ThreadPool                              &pool = ThreadPool::shared());
+
+    // 统计整个wz文件中的重复画布，会加载文件中的全部image
+    [[nodiscard]] DuplicateReport find_duplicates(File &file, ThreadPool &pool = ThreadPool::shared());
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "File.hpp"
+#include "ThreadPool.hpp"
+
+namespace wz
+{
+    enum class ChangeKind : u8
+    {
+        Added,
+        Removed,
+        Modified,
+    };
+
+    // 属性级别的变化，before/after为JSON值片段，新增或删除时对应一侧为空
+    struct PropertyChange
+    {
+        wzstring    path;
+        ChangeKind  kind;
+        std::string before;
+        std::string after;
+    };
+
+    struct ImageChange
+    {
+        wzstring   path;
+        ChangeKind kind;
+        i32        old_size     = 0;
+        i32        new_size     = 0;
+        i32        old_checksum = 0;
+        i32        new_checksum = 0;
+
+        // 仅对Modified且开启deep时填充；为空表示字节不同但属性完全一致
+        std::vector<PropertyChange> properties;
+        bool                        parse_failed = false;
+    };
+
+    struct DiffOptions
+    {
+        // 对大小或校验和不同的image逐属性比较
+        bool deep = true;
+    };
+
+    struct DiffResult
+    {
+        std::vector<ImageChange> images; // 按路径排序
+        size_t                   compared  = 0; // 两边都存在的image数
+        size_t                   unchanged = 0; // 大小与校验和都相同而未解析的image数
+    };
+
+    /**
+     * 比较两个wz文件的目录树。
+     * 先按名称、大小与校验和比较目录项，不解析image；
+     * 开启deep时再在线程池中并行解析候选image，逐属性比较。
+     * 画布与声音按压缩数据的哈希比较，不解压。
+     */
+    [[nodiscard]] DiffResult diff(File &before, File &after, const DiffOptions &options = {}, ThreadPool &pool = ThreadPool::shared());
+
+    // 以JSON输出变更集
+    void write_json(const DiffResult &result, std::ostream &out);
+}
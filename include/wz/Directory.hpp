@@ -1,5 +1,8 @@
 #pragma once
 
+#include <functional>
+#include <vector>
+
 #include "Node.hpp"
 #include "NumTypes.hpp"
 
@@ -14,13 +17,32 @@ namespace wz {
         [[nodiscard]]
         bool is_image() const;
 
+        // 目录项记录的image字节数
+        [[nodiscard]]
+        i32 get_size() const;
+
+        // 目录项记录的image校验和(image全部字节之和)
+        [[nodiscard]]
+        i32 get_checksum() const;
+
         [[maybe_unused]]
         bool parse_image(Node* node);
 
     private:
+        friend class File;
+
         bool image;
         int size;
         int checksum;
         unsigned int offset;
     };
+
+    // list中的Directory节点，保持原顺序
+    [[nodiscard]]
+    std::vector<Directory*> child_directories(const WzList& list);
+
+    // 按名称与同名节点中的下标配对两个节点的子目录，一侧没有对应的目录时传入nullptr。
+    // 名称按字典序访问；visit可以移除或添加当前名称下的子节点。比较两棵目录树(diff、reload)时用它逐层配对
+    void pair_directories(Node* before, Node* after,
+                          const std::function<void(const wzstring& name, Directory* before, Directory* after)>& visit);
 }
\ No newline at end of file
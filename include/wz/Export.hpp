@@ -0,0 +1,49 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+#include "File.hpp"
+#include "ThreadPool.hpp"
+
+namespace wz
+{
+    enum class ExportLayout : u8
+    {
+        ImagePerLine,    // 每行一个image，属性嵌套为JSON对象
+        PropertyPerLine, // 每行一个属性，带完整路径
+    };
+
+    // 画布与声音数据的输出方式；画布数据为解密后的zlib流，声音为原始数据
+    enum class PayloadMode : u8
+    {
+        None,     // 只输出属性信息
+        Base64,   // 以base64内嵌在JSON中
+        External, // 写到payload_dir下的文件，JSON中记录相对路径
+    };
+
+    struct ExportOptions
+    {
+        ExportLayout layout   = ExportLayout::ImagePerLine;
+        PayloadMode  payloads = PayloadMode::None;
+        std::string  payload_dir;
+
+        // 同时解析与序列化的image数上限，0表示线程数的两倍；峰值内存与它成正比
+        size_t max_in_flight = 0;
+    };
+
+    struct ExportResult
+    {
+        size_t images = 0;
+        size_t failed = 0; // 解析或写出数据失败的image；解析失败的image输出一行带"error"的记录
+        u64    bytes  = 0;
+    };
+
+    /**
+     * 将整个wz文件导出为NDJSON。
+     * image按目录树顺序分批在线程池中解析并序列化，每批完成后按原顺序写出，输出与线程数无关。
+     * image只解析到临时节点树中，写出后立即释放，不进入File的image缓存。
+     * 同名的兄弟节点在嵌套布局中从第二个起以name~1、name~2等为键；外部数据文件的路径与collect_raw_assets一样去重。
+     */
+    ExportResult export_ndjson(File &file, std::ostream &out, const ExportOptions &options = {}, ThreadPool &pool = ThreadPool::shared());
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "File.hpp"
+#include "ThreadPool.hpp"
+
+namespace wz
+{
+    // 将文件中[offset, offset + size)的原始字节写到path
+    struct ExtractTask
+    {
+        size_t      offset = 0;
+        size_t      size   = 0;
+        std::string path;
+    };
+
+    struct ExtractResult
+    {
+        size_t written = 0;
+        size_t failed  = 0;
+        u64    bytes   = 0;
+    };
+
+    // 节点路径对应的相对文件路径，"."与".."段被替换，保证结果不会跑到输出目录之外
+    [[nodiscard]] std::string asset_path(const wzstring &node_path, const char *extension);
+
+    // 将path登记到used中并返回；path已被使用时在扩展名前依次尝试~1、~2等。输出路径的去重都使用它
+    [[nodiscard]] std::string unique_path(const std::string &path, std::unordered_set<std::string> &used);
+
+    /**
+     * 收集文件中所有声音与画布的原始数据范围，会加载文件中的全部image。
+     * 输出路径为out_dir加上节点路径：声音按编码使用.mp3/.pcm/.bin后缀，画布使用.canvas后缀(未解压、可能加密的原始数据)。
+     * 路径相同的节点(例如同名的兄弟节点)从第二个起在扩展名前加上~1、~2等，保证每个任务的输出路径不同。
+     */
+    [[nodiscard]] std::vector<ExtractTask> collect_raw_assets(File              &file,
+                                                              const std::string &out_dir,
+                                                              bool               sounds   = true,
+                                                              bool               canvases = true);
+
+    /**
+     * 将一批原始数据范围写成文件，不经过用户态缓冲区。
+     * Linux下优先使用copy_file_range，不支持时退回sendfile，最后退回从mmap直接write；
+     * 其他平台直接从mmap写出。任务按偏移排序后在线程池中并行执行，父目录会自动创建。
+     * 输出路径重复的任务只执行第一个，其余计入failed。
+     * 数据总是取自File当前映射的文件，磁盘上的文件已被rename替换时也不会读到新文件。
+     */
+    ExtractResult extract(const File &file, const std::vector<ExtractTask> &tasks, ThreadPool &pool = ThreadPool::shared());
+}
@@ -1,12 +1,29 @@
 #pragma once
 
+#include <mutex>
+
 #include "Node.hpp"
 #include "Reader.hpp"
 #include "Wz.hpp"
 #include "Keys.hpp"
+#include "Memory.hpp"
+#include "Stats.hpp"
+#include "TextureCache.hpp"
 
 namespace wz
 {
+    class Directory;
+
+    // reload的结果，按image计数
+    struct ReloadStats
+    {
+        size_t unchanged = 0; // 大小、校验和与偏移都未变
+        size_t moved     = 0; // 内容未变但偏移改变，已缓存的节点就地修正偏移
+        size_t modified  = 0; // 大小或校验和改变，缓存失效
+        size_t added     = 0;
+        size_t removed   = 0;
+    };
+
     class File final
     {
 
@@ -17,16 +34,81 @@ namespace wz
 
         [[maybe_unused]] explicit File(u8 *new_iv, const char *path);
 
+        // 例如 File(keys::parse_iv(argv[2]), argv[1])
+        [[maybe_unused]] explicit File(const std::array<u8, 4> &new_iv, const char *path);
+
         ~File();
 
         [[maybe_unused]] bool parse(const wzstring &name = u"");
 
+        /**
+         * 将已解析的目录树(名称、类型、大小、校验和、偏移)写成快照文件。
+         * 快照记录wz文件的大小、修改时间、文件头哈希与IV，用于load_index时校验。
+         */
+        [[maybe_unused]] bool save_index(const char *index_path) const;
+
+        /**
+         * 从快照重建目录树，代替parse中的版本探测与目录解析。
+         * 快照不存在、损坏或与当前wz文件不匹配时返回false，目录树保持不变，调用者应改用parse。
+         * 典型用法：if (!file.load_index(p)) { file.parse(); file.save_index(p); }
+         */
+        [[maybe_unused]] bool load_index(const char *index_path, const wzstring &name = u"");
+
+        /**
+         * 重新映射磁盘上的wz文件(通常是替换后的补丁文件)，只重新解析目录表，
+         * 按路径与旧目录树比较每个image的大小、校验和与偏移：
+         * 未变的image保留已缓存的节点与画布，偏移改变的就地修正；
+         * 改变或删除的image从image缓存与画布缓存中移除，下次访问时重新解析。
+         * 旧目录树中的Directory节点与未变image的节点保持有效；
+         * 失效的节点与旧映射保留到release_retired或File析构，已取得的指针与ByteView不会悬空，但不再被更新。
+         * 新文件必须以rename替换旧文件(新的inode)：就地截断或改写会改变旧映射背后的页面，
+         * 保留的节点与ByteView可能读到不完整的数据或触发SIGBUS。
+         * 不能与该File上的其他访问同时进行。失败时文件与目录树保持原状。
+         */
+        [[maybe_unused]] bool reload(ReloadStats *stats = nullptr);
+
+        /**
+         * 释放reload保留的失效节点与旧映射。每次reload都会保留被替换的文件，
+         * 长期运行并反复reload的进程应在确认不再持有旧的节点指针、ByteView与SoundStream后调用。
+         * 不能与该File上的其他访问同时进行。
+         */
+        [[maybe_unused]] void release_retired();
+
         [[maybe_unused]] [[nodiscard]] Node *get_root() const;
         Node &get_child(const wzstring &name);
 
+        // 解析image目录对应的节点树并缓存；可在多个线程中同时调用，同一image只保留一份
+        Node *load_image(Directory *dir);
+
+        // 该文件的已解码画布缓存
+        TextureCache &get_texture_cache();
+
+        // 只读访问底层Reader，用于零拷贝读取mmap；不要通过它移动游标
+        [[nodiscard]] const Reader &get_reader() const;
+
+        /**
+         * 解析统计的快照：读取的字节、解密的字符串、按类型分配的节点、image解析与画布解压的次数与耗时、
+         * 已生成的密钥流以及image缓存与画布缓存的命中情况。
+         * 计数器始终开启，可以在任意线程中随时调用，例如由指标导出器定期采集。
+         */
+        [[nodiscard]] ParseStats get_stats() const;
+
+        // 解析过程中累加的计数器，供Node、Directory与画布解码使用
+        StatsCounters &get_counters();
+
+        /**
+         * 该文件占用的内存：目录树、已缓存的image、reload后保留的失效image、密钥流与画布缓存。
+         * 每个image的占用在加载时计算一次，查询时只遍历目录树。
+         * @param largest_images 返回占用最多的image数量，用于决定淘汰或延迟加载哪些image
+         */
+        [[nodiscard]] MemoryReport get_memory_usage(size_t largest_images = 16);
+
         MutableKey key;
 
     private:
+        // 在root之前构造，root的构造会计入节点数
+        StatsCounters counters;
+
         // u8* key;
         u8 *iv;
 
@@ -36,12 +118,37 @@ namespace wz
 
         Reader reader;
 
+        // 已解析的image缓存，键为image目录的路径
+        std::map<wzstring, Node *> images;
+        std::mutex                 images_mutex;
+
+        // 每个已缓存image加载时的内存占用，与images同步增删；retire_image把它转入retired_memory
+        std::map<wzstring, NodeMemory> image_memory;
+        NodeMemory                     retired_memory;
+
+        TextureCache textures;
+
+        // reload后不再使用的映射与节点，release_retired或析构时释放
+        std::vector<Reader::Mapping> retired_mappings;
+        std::vector<Node *>          retired_nodes;
+
         bool parse_directories(Node *node);
 
         u32 get_wz_offset();
 
+        // 文件头(PKG1至加密版本号)的哈希，文件过小时返回false
+        bool header_hash(u64 &hash) const;
+
         void init_key();
 
+        // 将新目录树合并进旧目录树，见reload
+        void merge_directories(Node *current, Node *updated, ReloadStats &stats);
+
+        // image被删除或内容改变：移除缓存的节点与其画布
+        void retire_image(Directory *dir, ReloadStats &stats, bool removed);
+
+        void retire_subtree(Directory *dir, ReloadStats &stats);
+
         friend class Node;
     };
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "NumTypes.hpp"
+#include "ThreadPool.hpp"
+#include "Types.hpp"
+
+namespace wz
+{
+    struct GeneratorOptions
+    {
+        std::array<u8, 4> iv {0, 0, 0, 0};
+        i16               version = 95; // 写入文件头的版本号，决定偏移加密使用的版本哈希
+
+        // 目录树：根目录下depth层子目录，每个目录fanout个子目录与images个image
+        u32 depth   = 2;
+        u32 fanout  = 4;
+        u32 images  = 8;
+
+        // 每个image中的画布与声音；画布依次使用全部格式，加密与未加密交替
+        u32 canvases      = 4;
+        i32 canvas_width  = 64;
+        i32 canvas_height = 64;
+        u32 sounds        = 1;
+        u32 sound_bytes   = 16384;
+
+        // 画布数据的zlib压缩级别，0为不压缩的存储块，生成数GB的文件时最快
+        int compression = 1;
+
+        // 相同的seed与参数生成完全相同的文件，与线程数无关
+        u64 seed = 1;
+
+        // 路径(如u"Dir1/Dir0")以此开头的image改用seed + 1生成，其余image的字节不变，
+        // 用于生成只修改了部分image的补丁；为空时不使用
+        wzstring reseed_path;
+
+        // 同时在内存中生成的image数上限，0表示线程数的两倍
+        size_t max_in_flight = 0;
+    };
+
+    struct GeneratorResult
+    {
+        size_t directories = 0;
+        size_t images      = 0;
+        size_t canvases    = 0;
+        size_t sounds      = 0;
+        u64    bytes       = 0;
+    };
+
+    /**
+     * 生成一个合成的PKG1格式wz文件，用于测试与性能测量。
+     * image覆盖parse_property_list能解析的全部属性类型：整数、u16、float、double、字符串、
+     * 字符串块回引、SubProperty、画布(全部格式，加密与未加密)、向量、凸包、声音(PCM与MP3)与UOL；
+     * info/ref以名称(不含.img)引用前8个image之一，模拟地图对Back、Tile与Obj素材的引用。
+     * 目录表中重复的名称使用偏移引用。
+     * image在线程池中分批生成并按顺序写出，内存占用与文件大小无关。
+     * 格式中的偏移是32位的，文件超过4GiB时返回false。
+     */
+    bool generate_archive(const std::string &path, const GeneratorOptions &options, GeneratorResult *result = nullptr,
+                          ThreadPool &pool = ThreadPool::shared());
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+#include "NumTypes.hpp"
+
+namespace wz::hash
+{
+    // XXH64，用于识别内容相同的画布等非加密场景，结果与官方xxHash实现一致
+    [[nodiscard]] u64 xxh64(const u8 *data, size_t size, u64 seed = 0);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include "NumTypes.hpp"
+
+// 画布解压使用的inflate接口，具体实现由CMake选项WZLIB_INFLATE_BACKEND在编译时决定
+namespace wz::inflate
+{
+    // 当前使用的解压后端名称
+    [[nodiscard]] const char *backend();
+
+    // 一次性解压完整的zlib流，解压结果必须恰好为dst_size字节
+    [[nodiscard]] bool decompress(const u8 *src, size_t src_size, u8 *dst, size_t dst_size);
+
+    // 分段送入输入的解压器，用于逐块解密的加密画布
+    class Stream final
+    {
+    public:
+        explicit Stream(u8 *dst, size_t dst_size);
+        ~Stream();
+
+        Stream(const Stream &)            = delete;
+        Stream &operator=(const Stream &) = delete;
+
+        // 送入一段输入，数据损坏或输出溢出时返回false
+        bool write(const u8 *src, size_t size);
+
+        // 结束输入，解压结果恰好为dst_size字节时返回true
+        [[nodiscard]] bool finish();
+
+    private:
+        struct State;
+        std::unique_ptr<State> state;
+    };
+
+    // 按需取出解压结果的解压器，用于按行解码时提前结束
+    class Pull final
+    {
+    public:
+        // 需要更多输入时调用next_input，返回false表示输入已结束；total_size为完整的解压大小
+        Pull(std::function<bool(const u8 *&data, size_t &size)> next_input, size_t total_size);
+        ~Pull();
+
+        Pull(const Pull &)            = delete;
+        Pull &operator=(const Pull &) = delete;
+
+        // 解压接下来的size字节到dst，数据不足或损坏时返回false
+        bool read(u8 *dst, size_t size);
+
+    private:
+        struct State;
+        std::unique_ptr<State> state;
+    };
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+
+#include "NumTypes.hpp"
+#include "Types.hpp"
+
+namespace wz::json
+{
+    // 追加一个带引号并转义的JSON字符串
+    void append_string(std::string &out, const std::string &text);
+
+    // wzstring先转换为UTF-8
+    void append_string(std::string &out, const wzstring &text);
+
+    // 追加数字，NaN与无穷大写为null
+    void append_number(std::string &out, f64 value, int precision = 17);
+
+    // 追加带引号的base64字符串
+    void append_base64(std::string &out, const u8 *data, size_t size);
+}
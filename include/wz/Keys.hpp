@@ -1,8 +1,12 @@
 #pragma once
 
 #include "NumTypes.hpp"
-#include <vector>
 #include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace wz {
     static const u8 AesKey1[] = {
@@ -99,6 +103,7 @@ namespace wz {
     }
 
     // 可变秘钥
+    // 密钥流按batch_size分批生成，已生成的批次不会移动，因此可以在多个线程中并发读取
     class MutableKey final {
     public:
         explicit MutableKey() = default;
@@ -106,15 +111,29 @@ namespace wz {
         // 用于从给定的IV（初始化向量）和AES密钥创建一个MutableKey对象。
         explicit MutableKey(const std::array<u8, 4>& new_iv, std::vector<u8> new_aes_key);
 
-        // 用于访问MutableKey对象的密钥数组中的元素。
-        u8& operator[] (size_t index);
+        MutableKey(const MutableKey& other);
+        MutableKey& operator=(const MutableKey& other);
+
+        // 用于访问MutableKey对象的密钥数组中的元素，必要时生成更多密钥。
+        const u8& operator[] (size_t index);
+
+        // 预先生成至少size字节的密钥
+        void ensure(size_t size);
+
+        // 已生成的密钥字节数
+        [[nodiscard]] size_t size() const;
 
     private:
-        // 表示密钥数组的最大大小。
-        static constexpr auto batch_size = 0x10000;
+        // 每批生成的密钥字节数。
+        static constexpr size_t batch_size = 0x10000;
+        // 密钥流的最大批次数(64 MiB)，批次表预先分配以保证并发读取时不会重新分配。
+        static constexpr size_t max_batches = 0x400;
+
         std::array<u8, 4> iv {0, 0, 0, 0};
         std::vector<u8> aes_key;
-        std::vector<u8> keys;
+        std::unique_ptr<std::unique_ptr<u8[]>[]> batches;
+        std::atomic<size_t> generated {0};
+        mutable std::mutex mutex;
 
         // 用于确保密钥数组的大小至少为给定的size。
         void ensure_key_size(size_t size);
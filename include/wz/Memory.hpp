@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include "Node.hpp"
+
+namespace wz
+{
+    /**
+     * 节点树占用的堆内存估算，按对象本身的大小、容器的节点与容量、字符串的堆缓冲区累加，
+     * 不计分配器的额外开销；短字符串优化内联的字符串不计入。
+     */
+    struct NodeMemory
+    {
+        size_t nodes        = 0;
+        size_t node_bytes   = 0; // 节点对象、子节点表的树节点与WzList的容量
+        size_t name_bytes   = 0; // 子节点表中的名称
+        size_t string_bytes = 0; // 字符串属性与UOL的值
+        size_t path_bytes   = 0; // 每个节点的完整路径
+
+        [[nodiscard]] size_t total() const { return node_bytes + name_bytes + string_bytes + path_bytes; }
+
+        NodeMemory &operator+=(const NodeMemory &other)
+        {
+            nodes += other.nodes;
+            node_bytes += other.node_bytes;
+            name_bytes += other.name_bytes;
+            string_bytes += other.string_bytes;
+            path_bytes += other.path_bytes;
+            return *this;
+        }
+    };
+
+    struct ImageMemory
+    {
+        wzstring   path;
+        NodeMemory memory;
+    };
+
+    // File::get_memory_usage的结果
+    struct MemoryReport
+    {
+        NodeMemory directories; // 目录树，不含已解析的image
+        NodeMemory images;      // 已缓存的全部image
+        size_t     image_count = 0;
+        NodeMemory retired;     // reload后失效、保留到release_retired或File析构的image
+
+        size_t keystream_bytes = 0;
+        size_t texture_bytes   = 0; // 画布缓存中常驻的像素字节数
+        size_t texture_budget  = 0;
+
+        std::vector<ImageMemory> largest; // 占用最多的image，按total降序
+
+        [[nodiscard]] size_t total() const
+        {
+            return directories.total() + images.total() + retired.total() + keystream_bytes + texture_bytes;
+        }
+    };
+
+    // 估算node及其子树的内存；遇到image目录时不加载image
+    [[nodiscard]] NodeMemory measure_tree(const Node *node);
+
+    // 以文本输出各部分的占用与最大的image
+    void write_text(const MemoryReport &report, std::ostream &out);
+}
@@ -51,6 +51,12 @@ namespace wz
 
         Node *find_from_path(const std::string &path);
 
+        // 批量查找路径，同一image只解析一次，返回结果与paths顺序一致
+        std::vector<Node *> resolve_many(const std::vector<wzstring> &paths);
+
+        // 解析子树中所有UOL的链接，返回悬空或成环的UOL节点
+        std::vector<Node *> link_uols();
+
     public:
         Type type;
 
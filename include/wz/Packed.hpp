@@ -0,0 +1,238 @@
+#pragma once
+
+#include <iterator>
+#include <string_view>
+
+#include <mio/mmap.hpp>
+
+#include "NumTypes.hpp"
+#include "Pixel.hpp"
+#include "Types.hpp"
+#include "Wz.hpp"
+
+namespace wz
+{
+    class File;
+    class PackedFile;
+
+    /**
+     * 预先解析好的只读归档格式(.wzp)，所有数据都可直接从mmap访问：
+     * [Header][画布/声音数据，16字节对齐][节点记录][字符串偏移表][UTF-16字符串数据]
+     * 节点按广度优先顺序存放，同一节点的子节点连续且按名称排序，根节点下标为0。
+     */
+    namespace packed
+    {
+        constexpr u32 magic      = 0x50575A57; // "WZWP"
+        constexpr u32 version    = 1;
+        constexpr u32 blob_align = 16;
+        constexpr u32 no_parent  = 0xFFFFFFFF;
+
+        struct Header
+        {
+            u32 magic;
+            u32 version;
+            u32 node_count;
+            u32 string_count;
+            u64 blob_offset;
+            u64 blob_size;
+            u64 node_offset;
+            u64 string_offset; // u32[string_count + 1]，以u16为单位的偏移
+            u64 string_data_offset;
+            u64 string_data_size; // 字节数
+        };
+
+        struct CanvasValue
+        {
+            i32 width;
+            i32 height;
+            u32 size; // 解密后的zlib流字节数
+            u16 format;
+            u8  format2;
+            u8  reserved;
+            u64 blob;
+        };
+
+        struct SoundValue
+        {
+            i32 length;
+            i32 frequency;
+            u32 size;
+            u16 codec;
+            u16 channels;
+            u64 blob;
+        };
+
+        struct VectorValue
+        {
+            i32 x;
+            i32 y;
+        };
+
+        // 固定48字节的节点记录
+        struct Record
+        {
+            u32 name;
+            u32 parent;
+            u32 first_child;
+            u32 child_count;
+            u8  type;
+            u8  reserved;
+            u16 aux;   // 声音：bits_per_sample
+            u32 extra; // 画布：uncompressed_size；声音：byte_rate
+
+            union
+            {
+                i64         integer; // Int、UnsignedShort
+                f64         real;    // Float、Double
+                u32         string;  // String、UOL的字符串下标
+                VectorValue vector;
+                CanvasValue canvas;
+                SoundValue  sound;
+            };
+        };
+
+        static_assert(sizeof(Header) == 64, "packed header layout");
+        static_assert(sizeof(Record) == 48, "packed record layout");
+    }
+
+    // 指向PackedFile中一个节点的轻量句柄，可按值传递；所属PackedFile释放后失效
+    class PackedNode final
+    {
+    public:
+        PackedNode() = default;
+
+        [[nodiscard]] bool valid() const { return file != nullptr; }
+
+        explicit operator bool() const { return valid(); }
+
+        [[nodiscard]] Type get_type() const;
+
+        [[nodiscard]] std::u16string_view get_name() const;
+
+        [[nodiscard]] PackedNode get_parent() const;
+
+        [[nodiscard]] size_t children_count() const;
+
+        // 第i个子节点，O(1)
+        [[nodiscard]] PackedNode child_at(size_t i) const;
+
+        // 按名称二分查找子节点，不存在时返回无效节点
+        [[nodiscard]] PackedNode get_child(std::u16string_view name) const;
+
+        [[nodiscard]] PackedNode operator[](std::u16string_view name) const { return get_child(name); }
+
+        // 以'/'分隔的相对路径查找
+        [[nodiscard]] PackedNode find_from_path(std::u16string_view path) const;
+
+        [[nodiscard]] i64 get_int() const;
+
+        [[nodiscard]] f64 get_double() const;
+
+        // String与UOL节点的字符串
+        [[nodiscard]] std::u16string_view get_string() const;
+
+        [[nodiscard]] WzVec2D get_vector() const;
+
+        // 解析UOL，目标不存在或链接成环时返回无效节点
+        [[nodiscard]] PackedNode resolve_uol() const;
+
+        // 画布属性，offset为数据在.wzp中的位置，is_encrypted总为false
+        [[nodiscard]] WzCanvas get_canvas() const;
+
+        // 画布的zlib压缩流
+        [[nodiscard]] ByteView get_canvas_data() const;
+
+        // 解压并解码画布，dst至少pixel::decoded_size(get_canvas())字节
+        [[nodiscard]] bool decode(u8 *dst, size_t dst_size, PixelFormat format = PixelFormat::RGBA8888) const;
+
+        // 声音属性，offset为数据在.wzp中的位置，header_offset/header_size为0
+        [[nodiscard]] WzSound get_sound() const;
+
+        [[nodiscard]] ByteView get_sound_data() const;
+
+        [[nodiscard]] u32 index() const { return node; }
+
+        bool operator==(const PackedNode &other) const { return file == other.file && node == other.node; }
+
+        bool operator!=(const PackedNode &other) const { return !(*this == other); }
+
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = PackedNode;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const PackedNode *;
+            using reference         = PackedNode;
+
+            Iterator(const PackedFile *file, u32 node) : file(file), node(node) {}
+
+            PackedNode operator*() const { return {file, node}; }
+
+            Iterator &operator++()
+            {
+                ++node;
+                return *this;
+            }
+
+            bool operator==(const Iterator &other) const { return file == other.file && node == other.node; }
+
+            bool operator!=(const Iterator &other) const { return !(*this == other); }
+
+        private:
+            const PackedFile *file;
+            u32               node;
+        };
+
+        [[nodiscard]] Iterator begin() const;
+
+        [[nodiscard]] Iterator end() const;
+
+    private:
+        PackedNode(const PackedFile *file, u32 node) : file(file), node(node) {}
+
+        const PackedFile *file = nullptr;
+        u32               node = 0;
+
+        [[nodiscard]] const packed::Record &record() const;
+
+        friend class PackedFile;
+    };
+
+    // 以mmap方式打开.wzp文件，load只校验文件头与各段边界，不解析节点
+    class PackedFile final
+    {
+    public:
+        explicit PackedFile(const char *path);
+
+        PackedFile(const PackedFile &)            = delete;
+        PackedFile &operator=(const PackedFile &) = delete;
+
+        [[nodiscard]] bool load();
+
+        [[nodiscard]] PackedNode get_root() const;
+
+        [[nodiscard]] size_t node_count() const;
+
+    private:
+        mio::mmap_source      mmap;
+        const packed::Header *header      = nullptr;
+        const packed::Record *records     = nullptr;
+        const u32            *strings     = nullptr;
+        const char16_t       *string_data = nullptr;
+        const u8             *blobs       = nullptr;
+
+        [[nodiscard]] std::u16string_view string(u32 index) const;
+
+        [[nodiscard]] ByteView blob(u64 offset, u64 size) const;
+
+        friend class PackedNode;
+    };
+
+    /**
+     * 将已解析的wz文件转换为.wzp，会加载文件中的全部image。
+     * 加密画布在转换时解密，声音只保留数据与格式信息。
+     * @return 写入失败或有画布数据损坏时返回false
+     */
+    [[nodiscard]] bool write_packed(File &file, const char *path);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "NumTypes.hpp"
+#include "Types.hpp"
+
+namespace wz
+{
+    // 解码输出的像素格式，每像素4字节
+    enum class PixelFormat : u8
+    {
+        RGBA8888,
+        BGRA8888,
+    };
+
+    // 画布原始数据格式，取值为 format + format2
+    enum class CanvasFormat : i32
+    {
+        BGRA4444    = 1,
+        BGRA8888    = 2,
+        RGB565      = 513,
+        RGB565Block = 517, // 每个RGB565值覆盖16x16像素
+        DXT3        = 1026,
+        DXT5        = 2050,
+    };
+
+    // GPU可直接使用的块压缩格式
+    enum class CompressedFormat : u8
+    {
+        None,
+        BC2, // DXT3
+        BC3, // DXT5
+    };
+
+    // 块压缩纹理的格式描述与原生块数据
+    struct CompressedTexture
+    {
+        CompressedFormat format     = CompressedFormat::None;
+        i32              width      = 0;
+        i32              height     = 0;
+        u32              block_size = 16; // 每个4x4块的字节数
+        u32              blocks_x   = 0;
+        u32              blocks_y   = 0;
+        size_t           row_pitch  = 0; // 一行块的字节数
+        std::vector<u8>  blocks;
+    };
+
+    // 画布上的矩形区域，以像素为单位
+    struct CanvasRect
+    {
+        i32 x      = 0;
+        i32 y      = 0;
+        i32 width  = 0;
+        i32 height = 0;
+    };
+
+    // 按行解码的回调：y为画布中的行号，row指向裁剪后该行的第一个像素
+    using RowCallback = std::function<void(i32 y, const u8 *row)>;
+
+    namespace pixel
+    {
+        // 解码后RGBA8888/BGRA8888缓冲区所需的字节数
+        [[nodiscard]] size_t decoded_size(const WzCanvas &canvas);
+
+        // 画布对应的块压缩格式描述，blocks留空；非DXT格式的format为None
+        [[nodiscard]] CompressedTexture compressed_layout(const WzCanvas &canvas);
+
+        /**
+         * 将画布解压后的原始数据转换为RGBA8888或BGRA8888，写入调用者提供的缓冲区。
+         * 根据编译目标自动选择AVX2/SSE2/NEON实现，剩余像素由标量实现处理。
+         * @param canvas 画布属性，提供宽高与格式
+         * @param src 解压后的原始数据
+         * @param src_size 原始数据字节数
+         * @param dst 输出缓冲区，至少decoded_size(canvas)字节
+         * @param dst_size 输出缓冲区字节数
+         * @param format 输出像素格式
+         * @return 格式不支持或缓冲区大小不足时返回false
+         */
+        [[nodiscard]] bool decode(const WzCanvas &canvas,
+                                  const u8       *src,
+                                  size_t          src_size,
+                                  u8             *dst,
+                                  size_t          dst_size,
+                                  PixelFormat     format);
+
+        // 单行像素转换，count为像素数
+        void convert_bgra4444(const u8 *src, u8 *dst, size_t count, PixelFormat format);
+        void convert_bgra8888(const u8 *src, u8 *dst, size_t count, PixelFormat format);
+        void convert_rgb565(const u8 *src, u8 *dst, size_t count, PixelFormat format);
+
+        // 标量参考实现，SIMD实现的结果必须与之逐字节一致
+        namespace scalar
+        {
+            void convert_bgra4444(const u8 *src, u8 *dst, size_t count, PixelFormat format);
+            void convert_bgra8888(const u8 *src, u8 *dst, size_t count, PixelFormat format);
+            void convert_rgb565(const u8 *src, u8 *dst, size_t count, PixelFormat format);
+            void decode_dxt3(const u8 *src, i32 width, i32 height, u8 *dst, PixelFormat format);
+            void decode_dxt5(const u8 *src, i32 width, i32 height, u8 *dst, PixelFormat format);
+        }
+    }
+}
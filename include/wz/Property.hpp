@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Node.hpp"
+#include "Pixel.hpp"
+#include "TextureCache.hpp"
 
 namespace wz
 {
@@ -25,6 +27,44 @@ namespace wz
 
         [[nodiscard]] [[maybe_unused]] std::vector<u8> get_raw_data();
 
+        // 直接从mmap解压到调用者提供的缓冲区，不做中间分配；解压结果与uncompressed_size不符时返回false
+        [[nodiscard]] [[maybe_unused]] bool read_raw_data(u8 *dst, size_t dst_size);
+
+        // 画布的zlib压缩流，加密画布会先解密；out被清空后写入
+        [[nodiscard]] [[maybe_unused]] bool read_compressed(std::vector<u8> &out);
+
+        // 将画布解码为RGBA8888/BGRA8888写入dst，dst至少pixel::decoded_size(get())字节
+        [[nodiscard]] [[maybe_unused]] bool decode(u8 *dst, size_t dst_size, PixelFormat format = PixelFormat::RGBA8888);
+
+        /**
+         * 按行流式解码，只转换clip内的像素，解压到clip底部后立即停止。
+         * @param callback 每解码一行调用一次，行数据只在回调期间有效
+         * @param format 输出像素格式
+         * @param clip 裁剪区域，为nullptr时解码整个画布
+         */
+        [[maybe_unused]] bool decode_rows(const RowCallback &callback,
+                                          PixelFormat        format = PixelFormat::RGBA8888,
+                                          const CanvasRect  *clip   = nullptr);
+
+        // 将clip区域解码到带行步长的目标缓冲区，dst对应clip的左上角
+        [[maybe_unused]] bool decode_region(u8 *dst, size_t stride, const CanvasRect &clip, PixelFormat format = PixelFormat::RGBA8888);
+
+        // DXT3/DXT5画布直接给出解压后的BC2/BC3块数据，不在CPU上展开；其他格式返回false
+        [[nodiscard]] [[maybe_unused]] bool get_compressed(CompressedTexture &texture);
+
+        // 画布压缩数据(mmap中offset起size字节)的XXH64，内容相同的画布哈希相同
+        [[nodiscard]] [[maybe_unused]] u64 content_hash() const;
+
+        // 通过所属File的TextureCache获取解码后的像素，命中时不再解压；解码失败返回nullptr
+        // 缓存开启去重时，会先按content_hash、宽高与原始格式查找内容相同的已解码画布
+        [[nodiscard]] [[maybe_unused]] TextureCache::Pixels get_pixels(PixelFormat format = PixelFormat::RGBA8888);
+
+        // 声音数据在mmap中的只读视图，不做拷贝
+        [[nodiscard]] [[maybe_unused]] ByteView get_view() const;
+
+        // 声音头(媒体类型GUID + WAVEFORMATEX)的原始字节
+        [[nodiscard]] [[maybe_unused]] ByteView get_header() const;
+
         [[nodiscard]] [[maybe_unused]] wz::Node *get_uol();
 
     private:
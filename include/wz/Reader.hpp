@@ -1,8 +1,11 @@
 #pragma once
 
+#include <memory>
 #include <mio/mmap.hpp>
+#include <string>
 #include "NumTypes.hpp"
 #include "Keys.hpp"
+#include "Stats.hpp"
 
 namespace wz
 {
@@ -15,12 +18,15 @@ namespace wz
         explicit Reader() = delete;
         explicit Reader(wz::MutableKey &new_key, const char *file_path);
 
+        // 复制得到的Reader与原Reader共享同一个mmap，但有各自的游标，可在不同线程中同时读取
+        Reader(const Reader &other) = default;
+
         // 使用模板方法 read() 来读取不同类型的数据。
         // 例如read<u8>() 用于读取一个字节，read<i32>() 用于读取一个整数
         template <typename T>
         [[nodiscard]] T read()
         {
-            T result = *reinterpret_cast<T *>(&mmap[cursor]);
+            T result = *reinterpret_cast<const T *>(mmap->data() + cursor);
             cursor += sizeof(decltype(result));
             return result;
         }
@@ -96,19 +102,42 @@ namespace wz
         // 获取文件大小
         [[nodiscard]] mio::mmap_source::size_type size() const;
 
+        // 获取mmap中offset处的只读指针，用于零拷贝访问
+        [[nodiscard]] const u8 *data(const size_t &offset) const;
+
+        // 打开时使用的文件路径
+        [[nodiscard]] const std::string &get_path() const;
+
+        using Mapping = std::shared_ptr<const mio::mmap_source>;
+
+        // 当前的文件映射，持有它可以让旧映射在remap之后继续有效
+        [[nodiscard]] const Mapping &get_mapping() const;
+
+        void set_mapping(Mapping mapping);
+
+        // 重新映射同一路径的文件并把游标移到开头，失败时保持原映射不变
+        [[nodiscard]] bool remap();
+
         // 判断是否是wz图片
         [[nodiscard]] bool is_wz_image();
 
         // 设置key
         void set_key(const MutableKey &new_key);
 
+        // 字符串解密与字符串块回引计入counters，复制得到的Reader共享同一组计数器；为空时不计数
+        void set_counters(StatsCounters *new_counters);
+
     private:
         MutableKey &key;
 
         // 文件指针游标
         size_t cursor = 0;
 
-        mio::mmap_source mmap;
+        std::string path;
+
+        Mapping mmap;
+
+        StatsCounters *counters = nullptr;
 
         friend class Node;
     };
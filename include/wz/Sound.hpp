@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Property.hpp"
+
+namespace wz
+{
+    /**
+     * 按块读取声音数据，持有独立的读取游标，不影响所属File的Reader。
+     * 数据直接来自mmap，多个SoundStream可以在不同线程中同时读取同一个文件。
+     */
+    class SoundStream final
+    {
+    public:
+        explicit SoundStream(const Property<WzSound> &property);
+
+        // 复制最多size字节到dst，返回实际复制的字节数，到达末尾时返回0
+        size_t read(u8 *dst, size_t size);
+
+        // 返回从当前位置开始最多max_size字节的视图并前移游标，不做拷贝
+        ByteView next_chunk(size_t max_size);
+
+        // 将游标移到position，超出末尾时停在末尾
+        void seek(size_t position);
+
+        [[nodiscard]] size_t tell() const;
+
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] bool eof() const;
+
+        [[nodiscard]] const WzSound &format() const;
+
+    private:
+        WzSound  sound;
+        ByteView view;
+        size_t   cursor = 0;
+    };
+}
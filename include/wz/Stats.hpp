@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "NumTypes.hpp"
+#include "Wz.hpp"
+
+namespace wz
+{
+    // Type的取值不连续，按此下标存放各类型的节点计数
+    constexpr size_t node_type_count = 17;
+
+    constexpr size_t node_type_index(Type type)
+    {
+        switch (type)
+        {
+            case Type::NotSet:
+                return 0;
+            case Type::Directory:
+                return 1;
+            case Type::Image:
+                return 2;
+            case Type::Property:
+                return 3;
+            default:
+                return bit(type) >= bit(Type::Null) && bit(type) <= bit(Type::UOL) ? 4 + bit(type) - bit(Type::Null) : 0;
+        }
+    }
+
+    // 某一时刻各计数器的值，均为File创建以来的累计值
+    struct ParseStats
+    {
+        u64 directory_bytes   = 0; // 目录表的字节数
+        u64 image_bytes       = 0; // 解析过的image字节数(目录项记录的大小，包括其中画布与声音的数据)
+        u64 strings_decrypted = 0;
+        u64 string_bytes      = 0; // 解密的字符串字节数，UTF-16按每字符2字节
+        u64 string_block_refs = 0; // 字符串块回引(1或0x1B)的次数
+
+        std::array<u64, node_type_count> nodes {}; // 按类型分配的节点数，下标见node_type_index
+
+        u64 images_parsed        = 0;
+        u64 image_parse_failures = 0;
+        u64 image_parse_ns       = 0;
+
+        u64 canvases_inflated       = 0;
+        u64 canvas_compressed_bytes = 0; // 送入解压器的压缩字节数
+        u64 canvas_bytes_inflated   = 0; // 解压得到的字节数
+        u64 inflate_ns              = 0;
+
+        u64 keystream_bytes = 0; // 已生成的密钥流字节数
+
+        u64 image_cache_hits     = 0; // load_image命中已解析的image
+        u64 image_cache_misses   = 0;
+        u64 texture_cache_hits   = 0; // 见TextureCache::Stats
+        u64 texture_cache_misses = 0;
+
+        [[nodiscard]] u64 nodes_of(Type type) const { return nodes[node_type_index(type)]; }
+
+        [[nodiscard]] u64 total_nodes() const
+        {
+            u64 total = 0;
+            for (auto count : nodes)
+                total += count;
+            return total;
+        }
+
+        // 解析读取的字节：目录表与image
+        [[nodiscard]] u64 bytes_read() const { return directory_bytes + image_bytes; }
+    };
+
+    enum class Counter : u8
+    {
+        DirectoryBytes,
+        ImageBytes,
+        StringsDecrypted,
+        StringBytes,
+        StringBlockRefs,
+        ImagesParsed,
+        ImageParseFailures,
+        ImageParseNs,
+        CanvasesInflated,
+        CanvasCompressedBytes,
+        CanvasBytesInflated,
+        InflateNs,
+        ImageCacheHits,
+        ImageCacheMisses,
+        Nodes, // 之后node_type_count个计数器按节点类型排列
+    };
+
+    /**
+     * File的解析计数器，可在多个线程中同时累加。
+     * 计数器按线程分散到若干缓存行对齐的分片上，每次累加只是一次无竞争的relaxed原子加法；
+     * snapshot时把所有分片相加，与累加同时进行时得到的是近似一致的值。
+     */
+    class StatsCounters final
+    {
+    public:
+        void add(Counter counter, u64 value = 1)
+        {
+            shard().values[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+        }
+
+        void add_node(Type type)
+        {
+            shard().values[static_cast<size_t>(Counter::Nodes) + node_type_index(type)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // 不含密钥流与纹理缓存，这两项由File::get_stats填写
+        [[nodiscard]] ParseStats snapshot() const;
+
+    private:
+        static constexpr size_t counter_count = static_cast<size_t>(Counter::Nodes) + node_type_count;
+        static constexpr size_t shard_count   = 16;
+
+        struct alignas(64) Shard
+        {
+            std::array<std::atomic<u64>, counter_count> values {};
+        };
+
+        std::array<Shard, shard_count> shards {};
+
+        // 每个线程第一次累加时分配一个分片，之后固定使用
+        Shard &shard()
+        {
+            static std::atomic<size_t> next {0};
+            thread_local const size_t  index = next.fetch_add(1, std::memory_order_relaxed) % shard_count;
+            return shards[index];
+        }
+    };
+}
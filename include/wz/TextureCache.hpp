@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "NumTypes.hpp"
+#include "Pixel.hpp"
+
+namespace wz
+{
+    // 已解码画布像素的缓存，键为画布在文件中的偏移(WzCanvas::offset)与输出像素格式
+    // 超出内存预算时按LRU淘汰；像素以shared_ptr共享，被淘汰的缓冲区在最后一个使用者释放前保持有效
+    // 开启去重后，压缩数据、宽高与原始格式都相同的画布共享同一个像素缓冲区
+    class TextureCache final
+    {
+    public:
+        using Pixels = std::shared_ptr<const std::vector<u8>>;
+
+        // 决定解码结果的画布内容；压缩数据相同但宽高或原始格式不同的画布，解码结果也不同
+        struct Content
+        {
+            u64 hash            = 0; // 压缩数据的哈希，见Property<WzCanvas>::content_hash
+            u32 compressed_size = 0;
+            i32 width           = 0;
+            i32 height          = 0;
+            i32 format          = 0; // format + format2
+
+            [[nodiscard]] static Content of(const WzCanvas &canvas, u64 hash);
+
+            bool operator==(const Content &other) const
+            {
+                return hash == other.hash && compressed_size == other.compressed_size && width == other.width &&
+                       height == other.height && format == other.format;
+            }
+        };
+
+        struct Stats
+        {
+            u64    hits           = 0;
+            u64    misses         = 0;
+            u64    evictions      = 0;
+            size_t entries        = 0;
+            size_t resident_bytes = 0;
+            size_t budget_bytes   = 0;
+            u64    dedup_hits     = 0; // 通过内容哈希命中、省去解码的次数
+            u64    dedup_bytes    = 0; // 去重省下的解码字节数
+
+            [[nodiscard]] double hit_rate() const
+            {
+                return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+            }
+        };
+
+        explicit TextureCache(size_t budget_bytes = 256u << 20);
+
+        // 查找缓存，未命中返回nullptr
+        [[nodiscard]] Pixels find(size_t offset, PixelFormat format);
+
+        // 插入解码结果并返回共享的缓冲区；已有相同键时返回已缓存的缓冲区
+        Pixels insert(size_t offset, PixelFormat format, std::vector<u8> &&pixels);
+
+        /**
+         * 按画布内容查找已解码的相同画布，命中时以offset登记同一个缓冲区。
+         * 内容的全部字段都必须一致，缓冲区大小也必须等于width * height * 4。
+         * @return 未开启去重或未命中时返回nullptr
+         */
+        [[nodiscard]] Pixels find_duplicate(size_t offset, PixelFormat format, const Content &content);
+
+        // 插入解码结果并记录其内容，供之后的find_duplicate使用
+        Pixels insert(size_t offset, PixelFormat format, std::vector<u8> &&pixels, const Content &content);
+
+        // 是否按内容去重，默认关闭
+        void set_deduplicate(bool enabled);
+
+        [[nodiscard]] bool deduplicate() const;
+
+        // 移除某个偏移处画布的所有格式
+        void erase(size_t offset);
+
+        void clear();
+
+        // 调整内存预算，超出部分立即淘汰
+        void set_budget(size_t budget_bytes);
+
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        struct Entry
+        {
+            u64    key;
+            Pixels pixels;
+        };
+
+        // 一个缓冲区可能被多个偏移引用，只在第一次进入缓存时计入内存
+        struct Resident
+        {
+            size_t refs        = 0;
+            u64    content_key = 0;
+            bool   has_content = false;
+        };
+
+        struct ContentEntry
+        {
+            Content                              content;
+            std::weak_ptr<const std::vector<u8>> pixels;
+        };
+
+        mutable std::mutex                                  mutex;
+        std::list<Entry>                                    lru; // 队首为最近使用
+        std::unordered_map<u64, std::list<Entry>::iterator> index;
+        std::unordered_map<const std::vector<u8> *, Resident> residents;
+        std::unordered_map<u64, ContentEntry>                 contents;
+        Stats                                               counters;
+        bool                                                dedup = false;
+
+        static u64 make_key(size_t offset, PixelFormat format);
+
+        static u64 make_content_key(const Content &content, PixelFormat format);
+
+        // 在持有锁时将缓冲区以key登记到LRU队首
+        Pixels link(u64 key, Pixels pixels);
+
+        void unlink(std::list<Entry>::iterator it);
+
+        void evict();
+    };
+}
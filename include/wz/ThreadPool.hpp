@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wz
+{
+    // 工作窃取线程池：每个线程有自己的任务队列，按顺序从队首取任务，空闲时从其他队列尾部窃取
+    class ThreadPool final
+    {
+    public:
+        // threads为0时使用硬件线程数
+        explicit ThreadPool(size_t threads = 0);
+
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &)            = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // 参与执行任务的线程数（包括调用parallel_for的线程）
+        [[nodiscard]] size_t size() const;
+
+        /**
+         * 并行执行fn(0) ... fn(count - 1)，阻塞直到全部完成。
+         * 下标按连续区间分给各线程，每个线程内部按升序执行。
+         * 在线程池的工作线程内再次调用时直接在当前线程顺序执行。
+         * fn抛出的第一个异常会在所有任务结束后重新抛出。
+         */
+        void parallel_for(size_t count, const std::function<void(size_t)> &fn);
+
+        // 进程内共享的默认线程池
+        static ThreadPool &shared();
+
+    private:
+        struct Queue
+        {
+            std::mutex         mutex;
+            std::deque<size_t> items;
+        };
+
+        std::vector<std::thread>            workers;
+        std::vector<std::unique_ptr<Queue>> queues;
+
+        // 同一时间只执行一个parallel_for
+        std::mutex job_mutex;
+
+        std::mutex                         state_mutex;
+        std::condition_variable            wake;
+        std::condition_variable            done;
+        size_t                             generation = 0;
+        bool                               stopping   = false;
+        const std::function<void(size_t)> *job        = nullptr;
+        std::atomic<size_t>                remaining {0};
+        std::exception_ptr                 error;
+
+        void worker_loop(size_t index);
+
+        // 从自己的队列或其他队列取出任务并执行，直到没有任务可取
+        void drain(size_t index);
+
+        bool pop(size_t index, size_t &item);
+
+        bool steal(size_t index, size_t &item);
+    };
+}
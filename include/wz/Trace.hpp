@@ -0,0 +1,131 @@
+#pragma once
+
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "NumTypes.hpp"
+#include "Reader.hpp"
+
+namespace wz::trace
+{
+    // 一个已结束的阶段
+    struct Span
+    {
+        const char *name = nullptr; // 阶段名，静态字符串
+        std::string path;           // 文件、目录、image或属性的路径(UTF-8)，可能为空
+        u64         bytes        = 0; // 读取的字节数
+        u64         output_bytes = 0; // 解码输出的字节数
+        u64         start_ns     = 0; // 相对进程内第一次取时间的偏移
+        u64         duration_ns  = 0;
+        u32         thread       = 0; // 进程内按首次记录顺序分配的线程序号
+    };
+
+    // 接收span的用户接口，record可能在多个线程中同时调用
+    class Sink
+    {
+    public:
+        virtual ~Sink() = default;
+
+        virtual void record(const Span &span) = 0;
+    };
+
+    /**
+     * 设置接收span的sink，nullptr表示停止记录。
+     * sink必须在设置为其他值、且所有进行中的解析结束之后才能销毁。
+     * 未开启WZLIB_TRACING编译时库内部不产生span，设置sink没有效果。
+     */
+    void set_sink(Sink *sink);
+
+    [[nodiscard]] Sink *get_sink();
+
+    // 编译时是否开启了WZLIB_TRACING
+    constexpr bool enabled()
+    {
+#ifdef WZLIB_TRACING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // 在内存中收集span，写成chrome://tracing与Perfetto可以打开的Chrome trace JSON
+    class ChromeTraceSink final : public Sink
+    {
+    public:
+        void record(const Span &span) override;
+
+        // 以{"traceEvents":[...]}格式写出已收集的span，每个span为一个"X"事件
+        void write(std::ostream &out) const;
+
+        [[nodiscard]] size_t size() const;
+
+        void clear();
+
+    private:
+        mutable std::mutex mutex;
+        std::vector<Span>  spans;
+    };
+
+    // 记录一个阶段的RAII对象：构造时取得当前sink并开始计时，finish或析构时把span交给sink
+    class Scope final
+    {
+    public:
+        explicit Scope(const char *name);
+
+        ~Scope();
+
+        Scope(const Scope &)            = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        // 没有sink时其余方法都不做任何事；构造路径字符串等开销较大的参数前应先检查
+        [[nodiscard]] bool active() const { return sink != nullptr; }
+
+        void set_name(const char *name);
+
+        void set_path(const wzstring &path);
+
+        void set_path(const std::string &path);
+
+        void set_bytes(u64 bytes, u64 output_bytes = 0);
+
+        // 提前结束并记录，之后的finish与析构不再记录
+        void finish();
+
+        // 放弃记录
+        void cancel();
+
+    private:
+        Sink *sink;
+        Span  span;
+    };
+
+    // 与Scope接口相同的空实现，编译器会把它完全消除
+    class NoopScope final
+    {
+    public:
+        explicit NoopScope(const char *) {}
+
+        [[nodiscard]] constexpr bool active() const { return false; }
+
+        void set_name(const char *) {}
+
+        void set_path(const wzstring &) {}
+
+        void set_path(const std::string &) {}
+
+        void set_bytes(u64, u64 = 0) {}
+
+        void finish() {}
+
+        void cancel() {}
+    };
+
+    // 库内部使用的span：开启WZLIB_TRACING时为Scope，否则为NoopScope
+#ifdef WZLIB_TRACING
+    using LibraryScope = Scope;
+#else
+    using LibraryScope = NoopScope;
+#endif
+}
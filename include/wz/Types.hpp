@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include "NumTypes.hpp"
 
@@ -16,9 +17,24 @@ namespace wz {
     struct WzConvex {
     };
 
+    class Node;
+
+    // UOL链接的解析状态
+    enum class UolState : u8 {
+        Unresolved,
+        Resolving,
+        Resolved,
+        Dangling, // 目标路径不存在
+        Cyclic,   // 解析过程中遇到循环引用
+    };
+
     struct WzUOL {
         [[maybe_unused]]
         wzstring uol;
+
+        // 解析后的目标节点，仅在state为Resolved时有效
+        Node* target = nullptr;
+        UolState state = UolState::Unresolved;
     };
 
     struct WzCanvas {
@@ -38,13 +54,46 @@ namespace wz {
                   offset(0) {}
     };
 
+    // 指向mmap中一段只读数据，不持有内存，生命周期与所属File相同
+    struct ByteView {
+        const u8* data = nullptr;
+        size_t size = 0;
+
+        [[nodiscard]] const u8* begin() const { return data; }
+        [[nodiscard]] const u8* end() const { return data + size; }
+        [[nodiscard]] bool empty() const { return size == 0; }
+    };
+
+    // 声音数据的编码，取值为WAVEFORMATEX的wFormatTag
+    enum class SoundCodec : u16 {
+        Unknown = 0,
+        PCM = 0x0001,
+        MP3 = 0x0055,
+    };
+
     struct WzSound {
-        i32 length;
-        i32 frequency;
+        i32 length;         // 时长，毫秒
+        i32 frequency;      // 采样率
         i32 size;
         size_t offset;
 
-        WzSound() : length(0), frequency(0), size(0), offset(0) {}
+        // 声音头中WAVEFORMATEX的内容，头缺失时保持为0
+        SoundCodec codec;
+        u16 channels;
+        u32 byte_rate;      // 每秒字节数，比特率为byte_rate * 8
+        u16 block_align;
+        u16 bits_per_sample;
+
+        // 声音头(媒体类型GUID + WAVEFORMATEX)在文件中的位置
+        size_t header_offset;
+        u32 header_size;
+
+        WzSound()
+                : length(0), frequency(0), size(0), offset(0),
+                  codec(SoundCodec::Unknown), channels(0), byte_rate(0), block_align(0), bits_per_sample(0),
+                  header_offset(0), header_size(0) {}
+
+        [[nodiscard]] u32 bit_rate() const { return byte_rate * 8; }
     };
 
     struct WzVec2D {
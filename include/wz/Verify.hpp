@@ -0,0 +1,52 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "File.hpp"
+#include "ThreadPool.hpp"
+
+namespace wz
+{
+    // 校验和不符或数据范围超出文件末尾的image
+    struct VerifyIssue
+    {
+        wzstring path;
+        u32      offset       = 0;
+        i32      size         = 0;
+        i32      expected     = 0;
+        i32      actual       = 0;
+        bool     out_of_range = false; // 文件被截断
+    };
+
+    struct VerifyProgress
+    {
+        size_t images_done  = 0;
+        size_t images_total = 0;
+        u64    bytes_done   = 0;
+        u64    bytes_total  = 0;
+        size_t issues       = 0;
+    };
+
+    // 进度回调，调用是串行的，但可能来自任意工作线程
+    using VerifyCallback = std::function<void(const VerifyProgress &)>;
+
+    struct VerifyResult
+    {
+        size_t                   images = 0;
+        u64                      bytes  = 0;
+        std::vector<VerifyIssue> issues; // 按偏移排序
+
+        [[nodiscard]] bool ok() const { return issues.empty(); }
+    };
+
+    // image的校验和：[offset, offset + size)内全部字节之和
+    [[nodiscard]] i32 image_checksum(const u8 *data, size_t size);
+
+    /**
+     * 校验文件中每个image的字节范围与目录项记录的校验和，不解析image。
+     * image按偏移排序后分成连续区间交给线程池，对mmap的访问保持顺序。
+     * @param progress 每完成约1/256的数据量调用一次，最后一次调用时images_done等于images_total
+     */
+    [[nodiscard]] VerifyResult verify(const File &file, const VerifyCallback &progress = nullptr, ThreadPool &pool = ThreadPool::shared());
+}
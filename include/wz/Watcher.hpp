@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "File.hpp"
+
+namespace wz
+{
+    /**
+     * 监视wz文件的替换：新文件被rename到原路径后，在后台线程中调用File::reload。
+     * 只支持rename替换，就地截断或改写的文件不会触发reload，原因见File::reload。
+     * 仅在Linux上以inotify实现，其他平台上start返回false。
+     * reload期间持有guard，其他线程访问该File时也应持有同一个互斥量。
+     */
+    class FileWatcher final
+    {
+    public:
+        using Callback = std::function<void(bool ok, const ReloadStats &stats)>;
+
+        FileWatcher(File &file, std::mutex &guard, Callback on_reload = {});
+
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher &)            = delete;
+        FileWatcher &operator=(const FileWatcher &) = delete;
+
+        // settle: 最后一次事件之后等待的时间，补丁文件分多次写入时只触发一次reload
+        bool start(std::chrono::milliseconds settle = std::chrono::milliseconds(200));
+
+        void stop();
+
+        [[nodiscard]] bool running() const;
+
+        // 后台线程因poll出错而停止监视时的errno，0表示没有出错；出错后仍需调用stop回收线程
+        [[nodiscard]] int error() const;
+
+    private:
+        File       &file;
+        std::mutex &guard;
+        Callback    on_reload;
+
+        std::thread               worker;
+        std::chrono::milliseconds settle {};
+        int                       notify_fd = -1;
+        int                       stop_fd   = -1;
+        std::atomic<int>          failure {0};
+
+        void run();
+    };
+}
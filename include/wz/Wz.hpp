@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <string>
+
 #include "Types.hpp"
 
 //////////////////////////////////////////////////////////////////////////
@@ -33,6 +36,9 @@ namespace wz {
         return static_cast<u8>(type);
     }
 
+    // 属性类型在JSON输出(export_ndjson、diff)中的名称，如"int"、"canvas"；目录与未知类型为"node"
+    [[nodiscard]] const char* type_name(Type type);
+
     namespace keys {
         [[maybe_unused]]
         const unsigned char gms[4] = {
@@ -43,6 +49,9 @@ namespace wz {
         const unsigned char kms[4] = {
             0xB9, 0x7D, 0x63, 0xE9
         };
+
+        // 解析命令行中的IV："gms"、"kms"或8位十六进制数(按字节顺序，如4D23C72B)
+        [[nodiscard]] std::array<u8, 4> parse_iv(const std::string& text);
     }
 }
 
@@ -62,6 +71,9 @@ namespace wz {
 
     u32 get_version_hash(i32 encryptedVersion, i32 realVersion);
 
+    // 将节点名/路径转换为UTF-8，用于输出文件名与文本格式
+    std::string to_utf8(const wzstring& text);
+
     [[deprecated]]
     void initAES(const u8* iv);
 
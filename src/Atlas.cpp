@@ -0,0 +1,209 @@
+#include "Atlas.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace wz
+{
+    namespace
+    {
+        // skyline装箱：维护每段水平轮廓(x, y, width)，新矩形放在使其顶部最低的位置
+        class Skyline
+        {
+        public:
+            Skyline(i32 width, i32 height) : width(width), height(height) { segments.push_back({0, 0, width}); }
+
+            bool insert(i32 w, i32 h, i32 &out_x, i32 &out_y)
+            {
+                size_t best       = segments.size();
+                i32    best_y     = 0;
+                i32    best_width = 0;
+
+                for (size_t i = 0; i < segments.size(); ++i)
+                {
+                    const auto y = fit(i, w, h);
+                    if (y < 0)
+                        continue;
+                    if (best == segments.size() || y < best_y ||
+                        (y == best_y && segments[i].width < best_width))
+                    {
+                        best       = i;
+                        best_y     = y;
+                        best_width = segments[i].width;
+                    }
+                }
+
+                if (best == segments.size())
+                    return false;
+
+                out_x = segments[best].x;
+                out_y = best_y;
+                place(best, out_x, out_y + h, w);
+                used_width  = std::max(used_width, out_x + w);
+                used_height = std::max(used_height, out_y + h);
+                return true;
+            }
+
+            i32 used_width  = 0;
+            i32 used_height = 0;
+
+        private:
+            struct Segment
+            {
+                i32 x, y, width;
+            };
+
+            i32                  width;
+            i32                  height;
+            std::vector<Segment> segments;
+
+            // 矩形左边对齐第i段时的底部y坐标，放不下返回-1
+            i32 fit(size_t i, i32 w, i32 h) const
+            {
+                if (segments[i].x + w > width)
+                    return -1;
+
+                i32 y         = 0;
+                i32 remaining = w;
+                for (size_t j = i; remaining > 0; ++j)
+                {
+                    y = std::max(y, segments[j].y);
+                    if (y + h > height)
+                        return -1;
+                    remaining -= segments[j].width;
+                }
+                return y;
+            }
+
+            void place(size_t i, i32 x, i32 top, i32 w)
+            {
+                segments.insert(segments.begin() + static_cast<std::ptrdiff_t>(i), {x, top, w});
+
+                // 裁掉被新段覆盖的部分
+                for (size_t j = i + 1; j < segments.size();)
+                {
+                    const auto end = x + w;
+                    if (segments[j].x >= end)
+                        break;
+                    const auto overlap = end - segments[j].x;
+                    if (overlap >= segments[j].width)
+                    {
+                        segments.erase(segments.begin() + static_cast<std::ptrdiff_t>(j));
+                        continue;
+                    }
+                    segments[j].x += overlap;
+                    segments[j].width -= overlap;
+                    break;
+                }
+
+                // 合并高度相同的相邻段
+                for (size_t j = 0; j + 1 < segments.size();)
+                {
+                    if (segments[j].y == segments[j + 1].y)
+                    {
+                        segments[j].width += segments[j + 1].width;
+                        segments.erase(segments.begin() + static_cast<std::ptrdiff_t>(j + 1));
+                        continue;
+                    }
+                    ++j;
+                }
+            }
+        };
+    }
+
+    Atlas build_atlas(const std::vector<Property<WzCanvas> *> &canvases, const AtlasOptions &options, ThreadPool &pool)
+    {
+        Atlas atlas;
+        atlas.entries.resize(canvases.size());
+
+        for (size_t i = 0; i < canvases.size(); ++i)
+        {
+            auto &entry  = atlas.entries[i];
+            entry.canvas = canvases[i];
+            entry.width  = canvases[i]->get().width;
+            entry.height = canvases[i]->get().height;
+
+            auto *origin = canvases[i]->get_child(u"origin");
+            if (origin != nullptr && origin->type == Type::Vector2D)
+            {
+                entry.origin = dynamic_cast<Property<WzVec2D> *>(origin)->get();
+            }
+        }
+
+        // 排序键完全由画布本身决定，保证输出可复现
+        std::vector<size_t> order(canvases.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            const auto &ea = atlas.entries[a];
+            const auto &eb = atlas.entries[b];
+            if (ea.height != eb.height)
+                return ea.height > eb.height;
+            if (ea.width != eb.width)
+                return ea.width > eb.width;
+            return ea.canvas->get().offset < eb.canvas->get().offset;
+        });
+
+        std::vector<Skyline> skylines;
+        for (auto i : order)
+        {
+            auto      &entry = atlas.entries[i];
+            const auto w     = entry.width + options.padding;
+            const auto h     = entry.height + options.padding;
+
+            if (w > options.max_width || h > options.max_height)
+            {
+                // 超大画布独占一页
+                Skyline single(w, h);
+                single.insert(w, h, entry.x, entry.y);
+                entry.page = static_cast<u32>(skylines.size());
+                skylines.push_back(single);
+                continue;
+            }
+
+            bool placed = false;
+            for (size_t page = 0; page < skylines.size() && !placed; ++page)
+            {
+                if (skylines[page].insert(w, h, entry.x, entry.y))
+                {
+                    entry.page = static_cast<u32>(page);
+                    placed     = true;
+                }
+            }
+            if (!placed)
+            {
+                entry.page = static_cast<u32>(skylines.size());
+                skylines.emplace_back(options.max_width, options.max_height);
+                skylines.back().insert(w, h, entry.x, entry.y);
+            }
+        }
+
+        atlas.pages.resize(skylines.size());
+        for (size_t page = 0; page < skylines.size(); ++page)
+        {
+            auto &p  = atlas.pages[page];
+            p.width  = skylines[page].used_width;
+            p.height = skylines[page].used_height;
+            p.pixels.assign(static_cast<size_t>(p.width) * p.height * 4, 0);
+        }
+
+        for (auto &entry : atlas.entries)
+        {
+            const auto &p = atlas.pages[entry.page];
+            entry.u0      = static_cast<f32>(entry.x) / static_cast<f32>(p.width);
+            entry.v0      = static_cast<f32>(entry.y) / static_cast<f32>(p.height);
+            entry.u1      = static_cast<f32>(entry.x + entry.width) / static_cast<f32>(p.width);
+            entry.v1      = static_cast<f32>(entry.y + entry.height) / static_cast<f32>(p.height);
+        }
+
+        // 各画布在页面上互不重叠，可以直接并行解码到页面缓冲区
+        pool.parallel_for(order.size(), [&](size_t n) {
+            auto       &entry  = atlas.entries[order[n]];
+            auto       &page   = atlas.pages[entry.page];
+            const auto  stride = static_cast<size_t>(page.width) * 4;
+            auto       *dst    = page.pixels.data() + entry.y * stride + static_cast<size_t>(entry.x) * 4;
+            entry.decoded      = entry.canvas->decode_region(dst, stride, {0, 0, entry.width, entry.height}, options.format);
+        });
+
+        return atlas;
+    }
+}
@@ -0,0 +1,146 @@
+#include "Canvas.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <unordered_map>
+
+#include "Directory.hpp"
+#include "File.hpp"
+
+namespace wz
+{
+    size_t decode_canvases(const std::vector<Property<WzCanvas> *> &canvases,
+                           std::vector<std::vector<u8>>            &outputs,
+                           PixelFormat                              format,
+                           ThreadPool                              &pool)
+    {
+        outputs.resize(canvases.size());
+
+        // 分配输出并预先生成加密画布需要的密钥，避免工作线程在密钥生成上互相等待
+        for (size_t i = 0; i < canvases.size(); ++i)
+        {
+            const auto &canvas = canvases[i]->get();
+            outputs[i].resize(pixel::decoded_size(canvas));
+            if (canvas.is_encrypted)
+            {
+                canvases[i]->get_key().ensure(canvas.size);
+            }
+        }
+
+        // 按文件偏移排序，使每个线程对mmap的访问尽量顺序
+        std::vector<size_t> order(canvases.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return canvases[a]->get().offset < canvases[b]->get().offset;
+        });
+
+        std::atomic<size_t> decoded {0};
+        pool.parallel_for(order.size(), [&](size_t n) {
+            const auto i = order[n];
+            if (canvases[i]->decode(outputs[i].data(), outputs[i].size(), format))
+            {
+                decoded.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                outputs[i].clear();
+            }
+        });
+
+        return decoded.load();
+    }
+
+    namespace
+    {
+        void collect(Node *node, std::vector<Property<WzCanvas> *> &out)
+        {
+            for (auto &[_, children] : *node)
+            {
+                for (auto *child : children)
+                {
+                    if (child->type == Type::Image)
+                    {
+                        auto *image = child->file->load_image(dynamic_cast<Directory *>(child));
+                        if (image != nullptr)
+                            collect(image, out);
+                        continue;
+                    }
+                    if (child->type == Type::Canvas)
+                    {
+                        out.push_back(dynamic_cast<Property<WzCanvas> *>(child));
+                    }
+                    collect(child, out);
+                }
+            }
+        }
+
+        void collect(Node *node, std::vector<Directory *> &out)
+        {
+            for (auto &[_, children] : *node)
+            {
+                for (auto *child : children)
+                {
+                    auto *dir = dynamic_cast<Directory *>(child);
+                    if (dir == nullptr)
+                        continue;
+                    if (dir->is_image())
+                        out.push_back(dir);
+                    else
+                        collect(dir, out);
+                }
+            }
+        }
+    }
+
+    std::vector<Property<WzCanvas> *> collect_canvases(Node *node)
+    {
+        std::vector<Property<WzCanvas> *> canvases;
+        collect(node, canvases);
+        return canvases;
+    }
+
+    std::vector<Directory *> collect_images(Node *node)
+    {
+        std::vector<Directory *> images;
+        collect(node, images);
+        return images;
+    }
+
+    DuplicateReport find_duplicates(const std::vector<Property<WzCanvas> *> &canvases, ThreadPool &pool)
+    {
+        std::vector<u64> hashes(canvases.size());
+        pool.parallel_for(canvases.size(), [&](size_t i) { hashes[i] = canvases[i]->content_hash(); });
+
+        DuplicateReport report;
+        report.canvases = canvases.size();
+
+        // 以哈希为键，值为该内容第一次出现时的完整内容；长度、宽高或原始格式不同视为不同内容
+        std::unordered_multimap<u64, TextureCache::Content> seen;
+        for (size_t i = 0; i < canvases.size(); ++i)
+        {
+            const auto &canvas  = canvases[i]->get();
+            const auto  content = TextureCache::Content::of(canvas, hashes[i]);
+            const auto  decoded = pixel::decoded_size(canvas);
+            report.compressed_bytes += content.compressed_size;
+            report.decoded_bytes += decoded;
+
+            auto [first, last] = seen.equal_range(content.hash);
+            if (std::any_of(first, last, [&](const auto &entry) { return entry.second == content; }))
+            {
+                report.compressed_saved += content.compressed_size;
+                report.decoded_saved += decoded;
+                continue;
+            }
+            seen.emplace(content.hash, content);
+            ++report.unique;
+        }
+
+        return report;
+    }
+
+    DuplicateReport find_duplicates(File &file, ThreadPool &pool)
+    {
+        return find_duplicates(collect_canvases(file.get_root()), pool);
+    }
+}
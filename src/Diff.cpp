@@ -0,0 +1,317 @@
+#include "Diff.hpp"
+
+#include <algorithm>
+#include <set>
+
+#include "Directory.hpp"
+#include "Hash.hpp"
+#include "Json.hpp"
+#include "Property.hpp"
+
+namespace wz
+{
+    namespace
+    {
+        const char *kind_name(ChangeKind kind)
+        {
+            switch (kind)
+            {
+                case ChangeKind::Added:
+                    return "added";
+                case ChangeKind::Removed:
+                    return "removed";
+                default:
+                    return "modified";
+            }
+        }
+
+        void add_subtree(Directory *dir, ChangeKind kind, std::vector<ImageChange> &out)
+        {
+            if (dir->is_image())
+            {
+                ImageChange change;
+                change.path = dir->path;
+                change.kind = kind;
+                if (kind == ChangeKind::Added)
+                {
+                    change.new_size     = dir->get_size();
+                    change.new_checksum = dir->get_checksum();
+                }
+                else
+                {
+                    change.old_size     = dir->get_size();
+                    change.old_checksum = dir->get_checksum();
+                }
+                out.push_back(std::move(change));
+                return;
+            }
+
+            for (auto &[_, list] : *dir)
+            {
+                for (auto *child : child_directories(list))
+                {
+                    add_subtree(child, kind, out);
+                }
+            }
+        }
+
+        struct DirectoryDiff
+        {
+            std::vector<ImageChange>                        &changes;
+            std::vector<std::pair<Directory *, Directory *>> &candidates;
+            DiffResult                                      &result;
+
+            void compare(Node *before, Node *after)
+            {
+                pair_directories(before, after, [this](const wzstring &, Directory *old_dir, Directory *new_dir) {
+                    if (old_dir == nullptr)
+                    {
+                        add_subtree(new_dir, ChangeKind::Added, changes);
+                    }
+                    else if (new_dir == nullptr)
+                    {
+                        add_subtree(old_dir, ChangeKind::Removed, changes);
+                    }
+                    else if (old_dir->is_image() != new_dir->is_image())
+                    {
+                        add_subtree(old_dir, ChangeKind::Removed, changes);
+                        add_subtree(new_dir, ChangeKind::Added, changes);
+                    }
+                    else if (!old_dir->is_image())
+                    {
+                        compare(old_dir, new_dir);
+                    }
+                    else
+                    {
+                        ++result.compared;
+                        if (old_dir->get_size() == new_dir->get_size() &&
+                            old_dir->get_checksum() == new_dir->get_checksum())
+                        {
+                            ++result.unchanged;
+                            return;
+                        }
+
+                        ImageChange change;
+                        change.path         = new_dir->path;
+                        change.kind         = ChangeKind::Modified;
+                        change.old_size     = old_dir->get_size();
+                        change.new_size     = new_dir->get_size();
+                        change.old_checksum = old_dir->get_checksum();
+                        change.new_checksum = new_dir->get_checksum();
+                        changes.push_back(std::move(change));
+                        candidates.emplace_back(old_dir, new_dir);
+                    }
+                });
+            }
+        };
+
+        // 属性值的JSON片段；画布与声音只记录格式与压缩数据的哈希
+        std::string describe(Node *node)
+        {
+            std::string out;
+            switch (node->type)
+            {
+                case Type::Int:
+                    out = std::to_string(dynamic_cast<Property<i32> *>(node)->get());
+                    break;
+                case Type::UnsignedShort:
+                    out = std::to_string(dynamic_cast<Property<u16> *>(node)->get());
+                    break;
+                case Type::Float:
+                    json::append_number(out, dynamic_cast<Property<f32> *>(node)->get(), 9);
+                    break;
+                case Type::Double:
+                    json::append_number(out, dynamic_cast<Property<f64> *>(node)->get(), 17);
+                    break;
+                case Type::String:
+                    json::append_string(out, dynamic_cast<Property<wzstring> *>(node)->get());
+                    break;
+                case Type::UOL:
+                    out = "{\"uol\":";
+                    json::append_string(out, dynamic_cast<Property<WzUOL> *>(node)->get().uol);
+                    out += '}';
+                    break;
+                case Type::Vector2D: {
+                    const auto &vector = dynamic_cast<Property<WzVec2D> *>(node)->get();
+                    out = "{\"x\":" + std::to_string(vector.x) + ",\"y\":" + std::to_string(vector.y) + "}";
+                }
+                break;
+                case Type::Canvas: {
+                    auto       *canvas = dynamic_cast<Property<WzCanvas> *>(node);
+                    const auto &info   = canvas->get();
+                    out = "{\"width\":" + std::to_string(info.width) + ",\"height\":" + std::to_string(info.height) +
+                          ",\"format\":" + std::to_string(info.format + info.format2) +
+                          ",\"size\":" + std::to_string(info.size) + ",\"hash\":\"" +
+                          std::to_string(canvas->content_hash()) + "\"}";
+                }
+                break;
+                case Type::Sound: {
+                    auto       *sound = dynamic_cast<Property<WzSound> *>(node);
+                    const auto &info  = sound->get();
+                    const auto  view  = sound->get_view();
+                    out = "{\"length\":" + std::to_string(info.length) + ",\"size\":" + std::to_string(info.size) +
+                          ",\"hash\":\"" + std::to_string(hash::xxh64(view.data, view.size)) + "\"}";
+                }
+                break;
+                case Type::Null:
+                    out = "null";
+                    break;
+                default:
+                    // 容器节点本身没有值，只比较类型
+                    out = "{}";
+                    break;
+            }
+            return out;
+        }
+
+        std::string typed(Node *node)
+        {
+            return std::string("{\"type\":\"") + type_name(node->type) + "\",\"value\":" + describe(node) + "}";
+        }
+
+        void compare_properties(Node *before, Node *after, std::vector<PropertyChange> &out)
+        {
+            std::set<wzstring> names;
+            for (auto &[name, _] : *before)
+                names.insert(name);
+            for (auto &[name, _] : *after)
+                names.insert(name);
+
+            static const WzList empty;
+            for (const auto &name : names)
+            {
+                auto        old_it   = before->children.find(name);
+                auto        new_it   = after->children.find(name);
+                const auto &old_list = old_it == before->children.end() ? empty : old_it->second;
+                const auto &new_list = new_it == after->children.end() ? empty : new_it->second;
+
+                for (size_t i = 0; i < std::max(old_list.size(), new_list.size()); ++i)
+                {
+                    auto *old_node = i < old_list.size() ? old_list[i] : nullptr;
+                    auto *new_node = i < new_list.size() ? new_list[i] : nullptr;
+
+                    if (old_node == nullptr)
+                    {
+                        out.push_back({new_node->path, ChangeKind::Added, {}, typed(new_node)});
+                        continue;
+                    }
+                    if (new_node == nullptr)
+                    {
+                        out.push_back({old_node->path, ChangeKind::Removed, typed(old_node), {}});
+                        continue;
+                    }
+
+                    auto old_value = typed(old_node);
+                    auto new_value = typed(new_node);
+                    if (old_node->type != new_node->type)
+                    {
+                        // 类型不同时子树不再逐项比较
+                        out.push_back({new_node->path, ChangeKind::Modified, std::move(old_value), std::move(new_value)});
+                        continue;
+                    }
+                    if (old_value != new_value)
+                    {
+                        out.push_back({new_node->path, ChangeKind::Modified, std::move(old_value), std::move(new_value)});
+                    }
+                    compare_properties(old_node, new_node, out);
+                }
+            }
+        }
+    }
+
+    DiffResult diff(File &before, File &after, const DiffOptions &options, ThreadPool &pool)
+    {
+        DiffResult                                       result;
+        std::vector<std::pair<Directory *, Directory *>> candidates;
+        DirectoryDiff                                    walker {result.images, candidates, result};
+        walker.compare(before.get_root(), after.get_root());
+
+        if (options.deep)
+        {
+            // candidates与Modified项一一对应，按出现顺序查找
+            std::vector<ImageChange *> modified;
+            for (auto &change : result.images)
+            {
+                if (change.kind == ChangeKind::Modified)
+                    modified.push_back(&change);
+            }
+
+            pool.parallel_for(candidates.size(), [&](size_t i) {
+                auto [old_dir, new_dir] = candidates[i];
+
+                // 解析到临时节点树，不进入File的image缓存
+                Node old_image;
+                Node new_image;
+                old_image.file = &before;
+                new_image.file = &after;
+                if (!old_dir->parse_image(&old_image) || !new_dir->parse_image(&new_image))
+                {
+                    modified[i]->parse_failed = true;
+                    return;
+                }
+                compare_properties(&old_image, &new_image, modified[i]->properties);
+            });
+        }
+
+        std::sort(result.images.begin(), result.images.end(), [](const ImageChange &a, const ImageChange &b) {
+            return a.path != b.path ? a.path < b.path : a.kind < b.kind;
+        });
+        return result;
+    }
+
+    void write_json(const DiffResult &result, std::ostream &out)
+    {
+        std::string text = "{\"compared\":" + std::to_string(result.compared) +
+                           ",\"unchanged\":" + std::to_string(result.unchanged) + ",\"images\":[";
+
+        for (size_t i = 0; i < result.images.size(); ++i)
+        {
+            const auto &image = result.images[i];
+            if (i != 0)
+                text += ',';
+
+            text += "\n{\"path\":";
+            json::append_string(text, image.path);
+            text += ",\"change\":\"";
+            text += kind_name(image.kind);
+            text += '"';
+            if (image.kind != ChangeKind::Added)
+                text += ",\"before\":{\"size\":" + std::to_string(image.old_size) +
+                        ",\"checksum\":" + std::to_string(image.old_checksum) + "}";
+            if (image.kind != ChangeKind::Removed)
+                text += ",\"after\":{\"size\":" + std::to_string(image.new_size) +
+                        ",\"checksum\":" + std::to_string(image.new_checksum) + "}";
+            if (image.parse_failed)
+                text += ",\"error\":\"parse failed\"";
+
+            if (image.kind == ChangeKind::Modified)
+            {
+                text += ",\"properties\":[";
+                for (size_t j = 0; j < image.properties.size(); ++j)
+                {
+                    const auto &property = image.properties[j];
+                    if (j != 0)
+                        text += ',';
+                    text += "{\"path\":";
+                    json::append_string(text, property.path);
+                    text += ",\"change\":\"";
+                    text += kind_name(property.kind);
+                    text += '"';
+                    if (!property.before.empty())
+                        text += ",\"before\":" + property.before;
+                    if (!property.after.empty())
+                        text += ",\"after\":" + property.after;
+                    text += '}';
+                }
+                text += ']';
+            }
+            text += '}';
+
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+            text.clear();
+        }
+
+        text += "\n]}\n";
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+}
@@ -1,4 +1,9 @@
 #include "Directory.hpp"
+#include "File.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <chrono>
 
 wz::Directory::Directory(File *root_file, bool img, int new_size, int new_checksum, unsigned int new_offset)
     : image(img), size(new_size), checksum(new_checksum), offset(new_offset), Node(img ? Type::Image : Type::Directory, root_file)
@@ -15,18 +20,89 @@ bool wz::Directory::is_image() const
     return image;
 }
 
+i32 wz::Directory::get_size() const
+{
+    return size;
+}
+
+i32 wz::Directory::get_checksum() const
+{
+    return checksum;
+}
+
 bool wz::Directory::parse_image(Node *node)
 {
     if (is_image())
     {
+        trace::LibraryScope span("parse_image");
+        if (span.active())
+        {
+            span.set_path(path);
+            span.set_bytes(static_cast<u64>(std::max(size, 0)));
+        }
+
         node->reader = reader;
         node->path = this->path;
         const auto current_offset = get_offset();
-        reader->set_position(current_offset);
-        if (reader->is_wz_image())
+
+        // 使用独立游标解析，不同image可以在多个线程中同时解析
+        Reader cursor(*reader);
+        Node   parser(Type::NotSet, file);
+        parser.reader = &cursor;
+
+        const auto start = std::chrono::steady_clock::now();
+        cursor.set_position(current_offset);
+        const bool parsed = cursor.is_wz_image() && parser.parse_property_list(node, current_offset);
+
+        auto &counters = file->get_counters();
+        counters.add(parsed ? Counter::ImagesParsed : Counter::ImageParseFailures);
+        counters.add(Counter::ImageBytes, static_cast<u64>(std::max(size, 0)));
+        counters.add(Counter::ImageParseNs, static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                std::chrono::steady_clock::now() - start).count()));
+        return parsed;
+    }
+    return false;
+}
+
+std::vector<wz::Directory *> wz::child_directories(const WzList &list)
+{
+    std::vector<Directory *> result;
+    for (auto *node : list)
+    {
+        if (auto *dir = dynamic_cast<Directory *>(node))
+            result.push_back(dir);
+    }
+    return result;
+}
+
+void wz::pair_directories(Node *before, Node *after,
+                          const std::function<void(const wzstring &, Directory *, Directory *)> &visit)
+{
+    static const WzList empty;
+
+    auto old_it = before->children.begin();
+    auto new_it = after->children.begin();
+    while (old_it != before->children.end() || new_it != after->children.end())
+    {
+        // 两个WzMap都按名称排序，同时推进即可得到名称的并集
+        const bool has_old = old_it != before->children.end() &&
+                             (new_it == after->children.end() || old_it->first <= new_it->first);
+        const bool has_new = new_it != after->children.end() &&
+                             (old_it == before->children.end() || new_it->first <= old_it->first);
+
+        const auto name     = has_old ? old_it->first : new_it->first;
+        const auto old_dirs = child_directories(has_old ? old_it->second : empty);
+        const auto new_dirs = child_directories(has_new ? new_it->second : empty);
+
+        // 先推进迭代器：visit可能删除或重新插入当前名称的项，std::map的其他迭代器不受影响
+        if (has_old)
+            ++old_it;
+        if (has_new)
+            ++new_it;
+
+        for (size_t i = 0; i < std::max(old_dirs.size(), new_dirs.size()); ++i)
         {
-            return parse_property_list(node, current_offset);
+            visit(name, i < old_dirs.size() ? old_dirs[i] : nullptr, i < new_dirs.size() ? new_dirs[i] : nullptr);
         }
     }
-    return false;
-}
\ No newline at end of file
+}
@@ -0,0 +1,337 @@
+#include "Export.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <unordered_set>
+
+#include "Canvas.hpp"
+#include "Directory.hpp"
+#include "Extract.hpp"
+#include "Json.hpp"
+#include "Property.hpp"
+
+namespace wz
+{
+    namespace
+    {
+        using json::append_base64;
+        using json::append_number;
+        using json::append_string;
+
+        wzstring number(size_t value)
+        {
+            const auto text = std::to_string(value);
+            return {text.begin(), text.end()};
+        }
+
+        // 序列化一个image，每个工作线程各自持有
+        class ImageSerializer
+        {
+        public:
+            // prefix: 该image的外部数据目录(相对payload_dir)，只在PayloadMode::External时使用
+            ImageSerializer(const ExportOptions &options, std::string &out, const wzstring &image_path,
+                            const std::string &prefix)
+                : options(options), out(out), image_path(image_path), prefix(prefix)
+            {
+            }
+
+            bool failed = false;
+
+            void image(Directory *dir, Node *root)
+            {
+                if (options.layout == ExportLayout::ImagePerLine)
+                {
+                    out += "{\"path\":";
+                    append_string(out, dir->path);
+                    out += ",\"size\":" + std::to_string(dir->get_size());
+                    out += ",\"checksum\":" + std::to_string(dir->get_checksum());
+                    out += ",\"properties\":";
+                    children(root);
+                    out += "}\n";
+                }
+                else
+                {
+                    lines(root);
+                }
+            }
+
+        private:
+            const ExportOptions &options;
+            std::string         &out;
+            std::vector<u8>      scratch;
+            const wzstring      &image_path;
+            const std::string   &prefix;
+
+            // 该image中已写出的外部数据文件
+            std::unordered_set<std::string> files;
+
+            // 嵌套布局：SubProperty为普通对象，其余复合类型带"$type"
+            void value(Node *node)
+            {
+                switch (node->type)
+                {
+                    case Type::Null:
+                        out += "null";
+                        break;
+                    case Type::Int:
+                        out += std::to_string(dynamic_cast<Property<i32> *>(node)->get());
+                        break;
+                    case Type::UnsignedShort:
+                        out += std::to_string(dynamic_cast<Property<u16> *>(node)->get());
+                        break;
+                    case Type::Float:
+                        append_number(out, dynamic_cast<Property<f32> *>(node)->get(), 9);
+                        break;
+                    case Type::Double:
+                        append_number(out, dynamic_cast<Property<f64> *>(node)->get(), 17);
+                        break;
+                    case Type::String:
+                        append_string(out, dynamic_cast<Property<wzstring> *>(node)->get());
+                        break;
+                    case Type::Canvas:
+                    case Type::Vector2D:
+                    case Type::Sound:
+                    case Type::UOL:
+                        out += "{\"$type\":\"";
+                        out += type_name(node->type);
+                        out += '"';
+                        fields(node);
+                        if (node->type == Type::Canvas)
+                        {
+                            out += ",\"children\":";
+                            children(node);
+                        }
+                        out += '}';
+                        break;
+                    case Type::Convex2D: {
+                        out += "{\"$type\":\"convex\",\"points\":[";
+                        bool first = true;
+                        for (auto &[_, list] : *node)
+                        {
+                            for (auto *child : list)
+                            {
+                                if (!first)
+                                    out += ',';
+                                first = false;
+                                value(child);
+                            }
+                        }
+                        out += "]}";
+                    }
+                    break;
+                    default:
+                        children(node);
+                        break;
+                }
+            }
+
+            // 同名的兄弟节点从第二个起以name~1、name~2等为键，跳过已有的名称，保证对象中的键不重复
+            void children(Node *node)
+            {
+                out += '{';
+                bool                         first = true;
+                std::unordered_set<wzstring> renamed;
+                for (auto &[name, list] : *node)
+                {
+                    for (size_t i = 0, n = 1; i < list.size(); ++i)
+                    {
+                        if (!first)
+                            out += ',';
+                        first = false;
+
+                        if (i == 0)
+                        {
+                            append_string(out, name);
+                        }
+                        else
+                        {
+                            auto key = name + u"~" + number(n++);
+                            while (node->get_child(key) != nullptr || !renamed.insert(key).second)
+                            {
+                                key = name + u"~" + number(n++);
+                            }
+                            append_string(out, key);
+                        }
+                        out += ':';
+                        value(list[i]);
+                    }
+                }
+                out += '}';
+            }
+
+            // 画布、向量、声音、UOL的字段，以逗号开头
+            void fields(Node *node)
+            {
+                switch (node->type)
+                {
+                    case Type::Canvas: {
+                        auto       *canvas = dynamic_cast<Property<WzCanvas> *>(node);
+                        const auto &info   = canvas->get();
+                        out += ",\"width\":" + std::to_string(info.width);
+                        out += ",\"height\":" + std::to_string(info.height);
+                        out += ",\"format\":" + std::to_string(info.format + info.format2);
+                        if (options.payloads != PayloadMode::None)
+                        {
+                            if (canvas->read_compressed(scratch))
+                                payload(node, scratch.data(), scratch.size(), ".zlib");
+                            else
+                                failed = true;
+                        }
+                    }
+                    break;
+                    case Type::Vector2D: {
+                        const auto &vector = dynamic_cast<Property<WzVec2D> *>(node)->get();
+                        out += ",\"x\":" + std::to_string(vector.x);
+                        out += ",\"y\":" + std::to_string(vector.y);
+                    }
+                    break;
+                    case Type::Sound: {
+                        auto       *sound = dynamic_cast<Property<WzSound> *>(node);
+                        const auto &info  = sound->get();
+                        out += ",\"length\":" + std::to_string(info.length);
+                        out += ",\"frequency\":" + std::to_string(info.frequency);
+                        out += ",\"codec\":" + std::to_string(static_cast<u16>(info.codec));
+                        out += ",\"channels\":" + std::to_string(info.channels);
+                        out += ",\"bit_rate\":" + std::to_string(info.bit_rate());
+                        if (options.payloads != PayloadMode::None)
+                        {
+                            const auto view = sound->get_view();
+                            payload(node, view.data, view.size, info.codec == SoundCodec::MP3 ? ".mp3" : ".bin");
+                        }
+                    }
+                    break;
+                    case Type::UOL:
+                        out += ",\"path\":";
+                        append_string(out, dynamic_cast<Property<WzUOL> *>(node)->get().uol);
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            void payload(Node *node, const u8 *data, size_t size, const char *extension)
+            {
+                if (options.payloads == PayloadMode::Base64)
+                {
+                    out += ",\"data\":";
+                    append_base64(out, data, size);
+                    return;
+                }
+
+                // 与collect_raw_assets相同，同名的兄弟节点在扩展名前加上~序号；image之间的去重由prefix保证
+                const auto relative =
+                    unique_path(prefix + '/' + asset_path(node->path.substr(image_path.size()), extension), files);
+                std::filesystem::path target   = std::filesystem::path(options.payload_dir) / relative;
+                std::error_code       error;
+                std::filesystem::create_directories(target.parent_path(), error);
+
+                std::ofstream file(target, std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+                if (!file)
+                    failed = true;
+
+                out += ",\"file\":";
+                append_string(out, relative);
+            }
+
+            // 逐属性布局：除SubProperty外每个节点一行
+            void lines(Node *node)
+            {
+                for (auto &[_, list] : *node)
+                {
+                    for (auto *child : list)
+                    {
+                        if (child->type != Type::SubProperty)
+                        {
+                            out += "{\"path\":";
+                            append_string(out, child->path);
+                            out += ",\"type\":\"";
+                            out += type_name(child->type);
+                            out += '"';
+                            switch (child->type)
+                            {
+                                case Type::Canvas:
+                                case Type::Vector2D:
+                                case Type::Sound:
+                                case Type::UOL:
+                                    fields(child);
+                                    break;
+                                case Type::Convex2D:
+                                    break;
+                                default:
+                                    out += ",\"value\":";
+                                    value(child);
+                                    break;
+                            }
+                            out += "}\n";
+                        }
+
+                        // 画布与凸包的子节点也各占一行
+                        lines(child);
+                    }
+                }
+            }
+        };
+    }
+
+    ExportResult export_ndjson(File &file, std::ostream &out, const ExportOptions &options, ThreadPool &pool)
+    {
+        const auto images = collect_images(file.get_root());
+
+        // 外部数据按image分目录，重名的image(例如替换"."、".."之后)按目录树顺序加上~序号，与线程数无关
+        std::vector<std::string> prefixes(options.payloads == PayloadMode::External ? images.size() : 0);
+        {
+            std::unordered_set<std::string> used;
+            for (size_t i = 0; i < prefixes.size(); ++i)
+            {
+                prefixes[i] = unique_path(asset_path(images[i]->path, ""), used);
+            }
+        }
+        const std::string no_prefix;
+
+        const auto window = options.max_in_flight != 0 ? options.max_in_flight : pool.size() * 2;
+
+        ExportResult             result;
+        std::vector<std::string> lines(std::min(window, images.size()));
+        std::vector<char>        failed(lines.size());
+
+        for (size_t begin = 0; begin < images.size(); begin += window)
+        {
+            const auto count = std::min(window, images.size() - begin);
+
+            pool.parallel_for(count, [&](size_t n) {
+                auto *dir  = images[begin + n];
+                auto &line = lines[n];
+                line.clear();
+
+                // 解析到临时节点树，序列化完成后随即释放
+                Node image;
+                image.file = &file;
+                if (!dir->parse_image(&image))
+                {
+                    line += "{\"path\":";
+                    append_string(line, dir->path);
+                    line += ",\"error\":\"parse failed\"}\n";
+                    failed[n] = 1;
+                    return;
+                }
+
+                ImageSerializer serializer(options, line, dir->path, prefixes.empty() ? no_prefix : prefixes[begin + n]);
+                serializer.image(dir, &image);
+                failed[n] = serializer.failed ? 1 : 0;
+            });
+
+            for (size_t n = 0; n < count; ++n)
+            {
+                out.write(lines[n].data(), static_cast<std::streamsize>(lines[n].size()));
+                result.bytes += lines[n].size();
+                result.failed += failed[n];
+                ++result.images;
+            }
+        }
+
+        return result;
+    }
+}
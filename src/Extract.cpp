@@ -0,0 +1,259 @@
+#include "Extract.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <unordered_set>
+
+#include "Directory.hpp"
+#include "Property.hpp"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+#endif
+
+namespace wz
+{
+    namespace
+    {
+        std::string output_path(const std::string &out_dir, const wzstring &node_path, const char *extension)
+        {
+            return (std::filesystem::path(out_dir) / asset_path(node_path, extension)).string();
+        }
+
+        void collect(Node *node, const std::string &out_dir, bool sounds, bool canvases, std::vector<ExtractTask> &out)
+        {
+            for (auto &[_, children] : *node)
+            {
+                for (auto *child : children)
+                {
+                    if (child->type == Type::Image)
+                    {
+                        auto *image = child->file->load_image(dynamic_cast<Directory *>(child));
+                        if (image != nullptr)
+                            collect(image, out_dir, sounds, canvases, out);
+                        continue;
+                    }
+
+                    if (sounds && child->type == Type::Sound)
+                    {
+                        const auto &sound     = dynamic_cast<Property<WzSound> *>(child)->get();
+                        const char *extension = sound.codec == SoundCodec::MP3   ? ".mp3"
+                                                : sound.codec == SoundCodec::PCM ? ".pcm"
+                                                                                 : ".bin";
+                        out.push_back({sound.offset, static_cast<size_t>(sound.size), output_path(out_dir, child->path, extension)});
+                    }
+                    else if (canvases && child->type == Type::Canvas)
+                    {
+                        const auto &canvas = dynamic_cast<Property<WzCanvas> *>(child)->get();
+                        out.push_back({canvas.offset, static_cast<size_t>(canvas.size), output_path(out_dir, child->path, ".canvas")});
+                    }
+
+                    collect(child, out_dir, sounds, canvases, out);
+                }
+            }
+        }
+
+        // 同名的兄弟节点(WzList允许)与替换"."、".."后相同的路径会指向同一个文件，
+        // 第二次出现起在扩展名前加上~序号，使每个任务写不同的文件
+        void make_unique_paths(std::vector<ExtractTask> &tasks)
+        {
+            std::unordered_set<std::string> used;
+            for (auto &task : tasks)
+            {
+                task.path = unique_path(task.path, used);
+            }
+        }
+
+#if defined(__linux__)
+        bool copy_range(int in, const ExtractTask &task, const u8 *data)
+        {
+            const int out = ::open(task.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (out < 0)
+                return false;
+
+            size_t done = 0;
+
+            // 内核内拷贝，同一文件系统上可能直接共享数据块
+            if (in >= 0)
+            {
+                loff_t offset = static_cast<loff_t>(task.offset);
+                while (done < task.size)
+                {
+                    const auto n = ::copy_file_range(in, &offset, out, nullptr, task.size - done, 0);
+                    if (n > 0)
+                    {
+                        done += static_cast<size_t>(n);
+                        continue;
+                    }
+                    if (n < 0 && errno == EINTR)
+                        continue;
+                    break;
+                }
+            }
+
+            // copy_file_range不可用(旧内核、跨文件系统)时退回sendfile
+            if (in >= 0 && done < task.size)
+            {
+                off_t offset = static_cast<off_t>(task.offset + done);
+                while (done < task.size)
+                {
+                    const auto n = ::sendfile(out, in, &offset, task.size - done);
+                    if (n > 0)
+                    {
+                        done += static_cast<size_t>(n);
+                        continue;
+                    }
+                    if (n < 0 && errno == EINTR)
+                        continue;
+                    break;
+                }
+            }
+
+            // 最后从mmap直接写出
+            while (done < task.size)
+            {
+                const auto n = ::write(out, data + done, task.size - done);
+                if (n > 0)
+                {
+                    done += static_cast<size_t>(n);
+                    continue;
+                }
+                if (n < 0 && errno == EINTR)
+                    continue;
+                break;
+            }
+
+            return ::close(out) == 0 && done == task.size;
+        }
+#else
+        bool write_from_memory(const ExtractTask &task, const u8 *data)
+        {
+            std::ofstream out(task.path, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(task.size));
+            return static_cast<bool>(out);
+        }
+#endif
+    }
+
+    std::string asset_path(const wzstring &node_path, const char *extension)
+    {
+        std::filesystem::path result;
+        const auto            path = to_utf8(node_path);
+
+        size_t begin = 0;
+        while (begin <= path.size())
+        {
+            auto end = path.find('/', begin);
+            if (end == std::string::npos)
+                end = path.size();
+
+            auto segment = path.substr(begin, end - begin);
+            if (segment == "." || segment == "..")
+                segment = "_";
+            if (!segment.empty())
+                result /= segment;
+
+            begin = end + 1;
+        }
+
+        return result.generic_string() + extension;
+    }
+
+    std::string unique_path(const std::string &path, std::unordered_set<std::string> &used)
+    {
+        if (used.insert(path).second)
+            return path;
+
+        const std::filesystem::path original(path);
+        const auto                  extension = original.extension().string();
+        auto                        stem      = original;
+        stem.replace_extension();
+        for (size_t n = 1;; ++n)
+        {
+            auto candidate = stem.string() + "~" + std::to_string(n) + extension;
+            if (used.insert(candidate).second)
+                return candidate;
+        }
+    }
+
+    std::vector<ExtractTask> collect_raw_assets(File &file, const std::string &out_dir, bool sounds, bool canvases)
+    {
+        std::vector<ExtractTask> tasks;
+        collect(file.get_root(), out_dir, sounds, canvases, tasks);
+        make_unique_paths(tasks);
+        return tasks;
+    }
+
+    ExtractResult extract(const File &file, const std::vector<ExtractTask> &tasks, ThreadPool &pool)
+    {
+        const auto &reader = file.get_reader();
+
+        // 目录创建不宜并行，先统一建好
+        std::set<std::filesystem::path> parents;
+        for (const auto &task : tasks)
+        {
+            parents.insert(std::filesystem::path(task.path).parent_path());
+        }
+        for (const auto &parent : parents)
+        {
+            std::error_code error;
+            if (!parent.empty())
+                std::filesystem::create_directories(parent, error);
+        }
+
+        // 多个任务写同一个路径时并行截断与写入会互相覆盖，只执行其中第一个，其余计为失败
+        std::vector<size_t>             order;
+        std::unordered_set<std::string> paths;
+        order.reserve(tasks.size());
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            if (paths.insert(tasks[i].path).second)
+                order.push_back(i);
+        }
+        const size_t duplicates = tasks.size() - order.size();
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return tasks[a].offset < tasks[b].offset; });
+
+#if defined(__linux__)
+        // copy_file_range/sendfile都传入显式偏移，所有线程可以共用一个描述符。
+        // 使用映射时打开的描述符：按路径重新打开可能得到rename替换后的新文件，偏移与映射中的目录树不符
+        const auto mapping = reader.get_mapping();
+        const int  in      = mapping->file_handle();
+#endif
+
+        std::atomic<size_t> written {0};
+        std::atomic<size_t> failed {duplicates};
+        std::atomic<u64>    bytes {0};
+
+        pool.parallel_for(order.size(), [&](size_t n) {
+            const auto &task = tasks[order[n]];
+            if (task.offset + task.size > reader.size())
+            {
+                failed.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+#if defined(__linux__)
+            const auto ok = copy_range(in, task, reader.data(task.offset));
+#else
+            const auto ok = write_from_memory(task, reader.data(task.offset));
+#endif
+            if (ok)
+            {
+                written.fetch_add(1, std::memory_order_relaxed);
+                bytes.fetch_add(task.size, std::memory_order_relaxed);
+            }
+            else
+            {
+                failed.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+        return {written.load(), failed.load(), bytes.load()};
+    }
+}
@@ -1,7 +1,14 @@
+#include <algorithm>
 #include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include "File.hpp"
 #include "Wz.hpp"
 #include "Directory.hpp"
+#include "Hash.hpp"
+#include "Property.hpp"
+#include "Trace.hpp"
 
 [[maybe_unused]] wz::File::File(const std::initializer_list<u8> &new_iv, const char *path)
     : key(), iv(nullptr), root(new Node(Type::NotSet, this)), reader(Reader(key, path))
@@ -10,6 +17,17 @@
     memcpy(iv, new_iv.begin(), 4);
     init_key();
     reader.set_key(key);
+    reader.set_counters(&counters);
+}
+
+[[maybe_unused]] wz::File::File(const std::array<u8, 4> &new_iv, const char *path)
+    : key(), iv(nullptr), root(new Node(Type::NotSet, this)), reader(Reader(key, path))
+{
+    iv = new u8[4];
+    memcpy(iv, new_iv.data(), 4);
+    init_key();
+    reader.set_key(key);
+    reader.set_counters(&counters);
 }
 
 [[maybe_unused]] wz::File::File(u8 *new_iv, const char *path)
@@ -17,16 +35,32 @@
 {
     init_key();
     reader.set_key(key);
+    reader.set_counters(&counters);
 }
 
 wz::File::~File()
 {
+    for (auto &[_, image] : images)
+    {
+        delete image;
+    }
+    for (auto *node : retired_nodes)
+    {
+        delete node;
+    }
     delete[] iv;
     delete root;
 }
 
 bool wz::File::parse(const wzstring &name)
 {
+    trace::LibraryScope span("File::parse");
+    if (span.active())
+    {
+        span.set_path(reader.get_path());
+        span.set_bytes(reader.size());
+    }
+
     auto magic = reader.read_string(4);
     if (magic != u"PKG1")
         return false;
@@ -40,6 +74,9 @@ bool wz::File::parse(const wzstring &name)
 
     auto encryptedVersion = reader.read<i16>();
 
+    // 包括对每个候选版本的试解析
+    trace::LibraryScope detection("version detection");
+
     for (int i = 0; i < 0x7FFF; ++i)
     {
         i16 file_version = static_cast<decltype(file_version)>(i);
@@ -59,6 +96,7 @@ bool wz::File::parse(const wzstring &name)
             }
             else
             {
+                detection.finish();
                 if (root)
                 {
                     root->path = name;
@@ -75,6 +113,13 @@ bool wz::File::parse(const wzstring &name)
 
 bool wz::File::parse_directories(wz::Node *node)
 {
+    trace::LibraryScope span("parse_directories");
+    if (node == nullptr)
+        span.cancel();
+    else if (span.active())
+        span.set_path(node->path);
+
+    const auto table_start = reader.get_position();
     auto entry_count = reader.read_compressed_int();
 
     for (int i = 0; i < entry_count; ++i)
@@ -140,6 +185,10 @@ bool wz::File::parse_directories(wz::Node *node)
 
     if (node != nullptr)
     {
+        // 版本探测时的试解析不计入
+        counters.add(Counter::DirectoryBytes, reader.get_position() - table_start);
+        span.set_bytes(reader.get_position() - table_start);
+
         for (auto &it : *node)
         {
             for (auto child : it.second)
@@ -174,6 +223,206 @@ u32 wz::File::get_wz_offset()
     return offset;
 }
 
+namespace
+{
+    void detach(wz::Node *node)
+    {
+        auto *parent = node->parent;
+        for (auto it = parent->children.begin(); it != parent->children.end(); ++it)
+        {
+            auto &list = it->second;
+            if (auto found = std::find(list.begin(), list.end(), node); found != list.end())
+            {
+                list.erase(found);
+                if (list.empty())
+                    parent->children.erase(it);
+                break;
+            }
+        }
+        node->parent = nullptr;
+    }
+
+    template <typename F>
+    void for_each_node(wz::Node *node, const F &visit)
+    {
+        for (auto &[_, list] : *node)
+        {
+            for (auto *child : list)
+            {
+                visit(child);
+                for_each_node(child, visit);
+            }
+        }
+    }
+
+    // 画布与声音记录的是mmap中的绝对偏移，image整体移动时随之平移
+    void rebase_image(wz::Node *image, i64 delta)
+    {
+        for_each_node(image, [delta](wz::Node *node) {
+            if (node->type == wz::Type::Canvas)
+            {
+                auto *canvas = dynamic_cast<wz::Property<wz::WzCanvas> *>(node);
+                auto  data   = canvas->get();
+                data.offset  = static_cast<size_t>(static_cast<i64>(data.offset) + delta);
+                canvas->set(data);
+            }
+            else if (node->type == wz::Type::Sound)
+            {
+                auto *sound        = dynamic_cast<wz::Property<wz::WzSound> *>(node);
+                auto  data         = sound->get();
+                data.offset        = static_cast<size_t>(static_cast<i64>(data.offset) + delta);
+                data.header_offset = static_cast<size_t>(static_cast<i64>(data.header_offset) + delta);
+                sound->set(data);
+            }
+        });
+    }
+}
+
+bool wz::File::reload(ReloadStats *stats)
+{
+    auto previous = reader.get_mapping();
+    if (!reader.remap())
+        return false;
+
+    // 在新映射上重新解析目录表，parse使用root，临时换成空的根节点
+    auto *current = root;
+    auto  old_desc = desc;
+    root           = new Node(Type::NotSet, this);
+    if (!parse(current->path))
+    {
+        delete root;
+        root = current;
+        desc = old_desc;
+        reader.set_mapping(previous);
+        return false;
+    }
+
+    auto *updated = root;
+    root          = current;
+
+    ReloadStats result;
+    {
+        std::lock_guard lock(images_mutex);
+        merge_directories(current, updated, result);
+    }
+    delete updated;
+
+    // 旧映射可能仍被ByteView、SoundStream或已失效的节点引用
+    retired_mappings.push_back(std::move(previous));
+
+    if (stats != nullptr)
+        *stats = result;
+    return true;
+}
+
+void wz::File::release_retired()
+{
+    for (auto *node : retired_nodes)
+    {
+        delete node;
+    }
+    retired_nodes.clear();
+    retired_mappings.clear();
+    retired_memory = {};
+}
+
+void wz::File::merge_directories(Node *current, Node *updated, ReloadStats &stats)
+{
+    // 名称相同的子节点按下标配对，与解析顺序一致
+    pair_directories(current, updated, [&](const wzstring &name, Directory *old_dir, Directory *new_dir) {
+        if (old_dir != nullptr && new_dir != nullptr && old_dir->image == new_dir->image)
+        {
+            if (!old_dir->image)
+            {
+                old_dir->offset = new_dir->offset;
+                merge_directories(old_dir, new_dir, stats);
+                return;
+            }
+
+            if (old_dir->size != new_dir->size || old_dir->checksum != new_dir->checksum)
+            {
+                retire_image(old_dir, stats, false);
+                old_dir->size     = new_dir->size;
+                old_dir->checksum = new_dir->checksum;
+            }
+            else if (old_dir->offset != new_dir->offset)
+            {
+                if (auto it = images.find(old_dir->path); it != images.end())
+                {
+                    // 画布缓存以偏移为键，移动后的旧偏移可能被其他image占用
+                    for_each_node(it->second, [this](Node *node) {
+                        if (node->type == Type::Canvas)
+                            textures.erase(dynamic_cast<Property<WzCanvas> *>(node)->get().offset);
+                    });
+                    rebase_image(it->second, static_cast<i64>(new_dir->offset) - static_cast<i64>(old_dir->offset));
+                }
+                ++stats.moved;
+            }
+            else
+            {
+                ++stats.unchanged;
+            }
+            old_dir->offset = new_dir->offset;
+            return;
+        }
+
+        if (old_dir != nullptr)
+        {
+            retire_subtree(old_dir, stats);
+            detach(old_dir);
+            retired_nodes.push_back(old_dir);
+        }
+        if (new_dir != nullptr)
+        {
+            // 新增的目录整体移到旧目录树中；两棵树根路径相同，子树路径无需修改
+            detach(new_dir);
+            current->appendChild(name, new_dir);
+            for_each_node(new_dir, [&stats](Node *node) {
+                auto *dir = dynamic_cast<Directory *>(node);
+                stats.added += dir != nullptr && dir->image ? 1 : 0;
+            });
+            stats.added += new_dir->image ? 1 : 0;
+        }
+    });
+}
+
+void wz::File::retire_image(Directory *dir, ReloadStats &stats, bool removed)
+{
+    ++(removed ? stats.removed : stats.modified);
+
+    auto it = images.find(dir->path);
+    if (it == images.end())
+        return;
+
+    for_each_node(it->second, [this](Node *node) {
+        if (node->type == Type::Canvas)
+            textures.erase(dynamic_cast<Property<WzCanvas> *>(node)->get().offset);
+    });
+    retired_nodes.push_back(it->second);
+    images.erase(it);
+    if (auto memory = image_memory.find(dir->path); memory != image_memory.end())
+    {
+        retired_memory += memory->second;
+        image_memory.erase(memory);
+    }
+}
+
+void wz::File::retire_subtree(Directory *dir, ReloadStats &stats)
+{
+    if (dir->image)
+    {
+        retire_image(dir, stats, true);
+        return;
+    }
+    for (auto &[_, list] : *dir)
+    {
+        for (auto *child : child_directories(list))
+        {
+            retire_subtree(child, stats);
+        }
+    }
+}
+
 wz::Node *wz::File::get_root() const
 {
     return root;
@@ -190,3 +439,305 @@ wz::Node &wz::File::get_child(const wzstring &name)
 {
     return *root->get_child(name);
 }
+
+wz::Node *wz::File::load_image(Directory *dir)
+{
+    {
+        std::lock_guard lock(images_mutex);
+        if (auto it = images.find(dir->path); it != images.end())
+        {
+            counters.add(Counter::ImageCacheHits);
+            return it->second;
+        }
+    }
+    counters.add(Counter::ImageCacheMisses);
+
+    // 在锁外解析，不同image的解析可以并行
+    auto *image = new Node();
+    image->file = this;
+    if (!dir->parse_image(image))
+    {
+        delete image;
+        return nullptr;
+    }
+
+    // 在加载时一次性解析UOL链接，悬空与成环的UOL保留其状态供调用者检查
+    image->link_uols();
+    const auto memory = measure_tree(image);
+
+    std::lock_guard lock(images_mutex);
+    auto [it, inserted] = images.try_emplace(dir->path, image);
+    if (!inserted)
+    {
+        // 其他线程先完成了同一image的解析
+        delete image;
+    }
+    else
+    {
+        image_memory[dir->path] = memory;
+    }
+    return it->second;
+}
+
+wz::TextureCache &wz::File::get_texture_cache()
+{
+    return textures;
+}
+
+const wz::Reader &wz::File::get_reader() const
+{
+    return reader;
+}
+
+wz::ParseStats wz::File::get_stats() const
+{
+    auto stats            = counters.snapshot();
+    stats.keystream_bytes = key.size();
+
+    const auto textures_stats  = textures.stats();
+    stats.texture_cache_hits   = textures_stats.hits;
+    stats.texture_cache_misses = textures_stats.misses;
+    return stats;
+}
+
+wz::StatsCounters &wz::File::get_counters()
+{
+    return counters;
+}
+
+wz::MemoryReport wz::File::get_memory_usage(size_t largest_images)
+{
+    MemoryReport report;
+    report.directories     = measure_tree(root);
+    report.keystream_bytes = key.size();
+
+    const auto textures_stats = textures.stats();
+    report.texture_bytes      = textures_stats.resident_bytes;
+    report.texture_budget     = textures_stats.budget_bytes;
+
+    std::lock_guard lock(images_mutex);
+    report.image_count = image_memory.size();
+    report.retired     = retired_memory;
+    for (const auto &[path, memory] : image_memory)
+    {
+        report.images += memory;
+    }
+
+    // 只排序指针，最后复制前largest_images个路径
+    using Entry = const std::pair<const wzstring, NodeMemory> *;
+    std::vector<Entry> entries;
+    entries.reserve(image_memory.size());
+    for (const auto &entry : image_memory)
+    {
+        entries.push_back(&entry);
+    }
+    const auto count = std::min(largest_images, entries.size());
+    std::partial_sort(entries.begin(), entries.begin() + static_cast<std::ptrdiff_t>(count), entries.end(),
+                      [](Entry a, Entry b) { return a->second.total() > b->second.total(); });
+    for (size_t i = 0; i < count; ++i)
+    {
+        report.largest.push_back({entries[i]->first, entries[i]->second});
+    }
+    return report;
+}
+
+namespace
+{
+    // 目录树快照：[IndexHeader][IndexEntry * entry_count][UTF-16名称]
+    // 目录项按前序遍历存放，每项之后紧跟它的child_count个子项(及其子树)
+    constexpr u32 index_magic   = 0x58495A57; // "WZIX"
+    constexpr u32 index_version = 1;
+
+    struct IndexHeader
+    {
+        u32 magic;
+        u32 version;
+        u64 archive_size;
+        i64 archive_mtime;
+        u64 header_hash;
+        u32 start;
+        u32 hash;
+        i16 version_number;
+        u8  iv[4];
+        u8  reserved[2];
+        u32 entry_count;
+        u64 name_units;
+    };
+
+    struct IndexEntry
+    {
+        u32 name_offset; // 以u16为单位
+        u32 name_length;
+        u32 child_count;
+        u32 image;
+        i32 size;
+        i32 checksum;
+        u32 offset;
+        u32 reserved;
+    };
+
+    static_assert(sizeof(IndexHeader) == 64, "index header layout");
+    static_assert(sizeof(IndexEntry) == 32, "index entry layout");
+
+    bool archive_stat(const std::string &path, u64 &size, i64 &mtime)
+    {
+        std::error_code error;
+        size = std::filesystem::file_size(path, error);
+        if (error)
+            return false;
+        mtime = static_cast<i64>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+        return !error;
+    }
+}
+
+bool wz::File::header_hash(u64 &hash) const
+{
+    // 固定头部：magic(4) + 文件大小(8) + 数据起始位置(4)
+    if (reader.size() < 16)
+        return false;
+
+    u32 start;
+    memcpy(&start, reader.data(12), sizeof(start));
+    if (static_cast<size_t>(start) + sizeof(i16) > reader.size())
+        return false;
+
+    hash = hash::xxh64(reader.data(0), start + sizeof(i16));
+    return true;
+}
+
+bool wz::File::save_index(const char *index_path) const
+{
+    IndexHeader header {};
+    header.magic          = index_magic;
+    header.version        = index_version;
+    header.start          = desc.start;
+    header.hash           = desc.hash;
+    header.version_number = desc.version;
+    memcpy(header.iv, iv, 4);
+    if (desc.hash == 0 || !header_hash(header.header_hash) ||
+        !archive_stat(reader.get_path(), header.archive_size, header.archive_mtime))
+        return false;
+
+    std::vector<IndexEntry> entries;
+    std::u16string          names;
+
+    std::function<void(Node *)> visit = [&](Node *node) {
+        for (auto &[name, children] : *node)
+        {
+            for (auto *child : children)
+            {
+                auto *dir = dynamic_cast<Directory *>(child);
+                if (dir == nullptr)
+                    continue;
+
+                IndexEntry entry {};
+                entry.name_offset = static_cast<u32>(names.size());
+                entry.name_length = static_cast<u32>(name.size());
+                entry.image       = dir->is_image() ? 1 : 0;
+                entry.size        = dir->get_size();
+                entry.checksum    = dir->get_checksum();
+                entry.offset      = dir->get_offset();
+                names += name;
+
+                const auto index = entries.size();
+                entries.push_back(entry);
+                visit(dir);
+
+                // 子项数只统计直接子目录
+                u32 count = 0;
+                for (auto &[_, list] : *dir)
+                {
+                    for (auto *grandchild : list)
+                    {
+                        count += dynamic_cast<Directory *>(grandchild) != nullptr ? 1 : 0;
+                    }
+                }
+                entries[index].child_count = count;
+            }
+        }
+    };
+    visit(root);
+
+    header.entry_count = static_cast<u32>(entries.size());
+    header.name_units  = names.size();
+
+    // 根节点的子项数不单独存储，读取时一直读到entry_count为止
+    std::ofstream out(index_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(IndexEntry));
+    out.write(reinterpret_cast<const char *>(names.data()), names.size() * sizeof(char16_t));
+    return static_cast<bool>(out);
+}
+
+bool wz::File::load_index(const char *index_path, const wzstring &name)
+{
+    std::error_code error;
+    const auto      snapshot = mio::make_mmap_source<decltype(index_path)>(index_path, error);
+    if (error || snapshot.size() < sizeof(IndexHeader))
+        return false;
+
+    const auto *base = reinterpret_cast<const u8 *>(snapshot.data());
+    IndexHeader header;
+    memcpy(&header, base, sizeof(header));
+    if (header.magic != index_magic || header.version != index_version || memcmp(header.iv, iv, 4) != 0)
+        return false;
+
+    // name_units来自文件，先与剩余大小比较，避免乘法回绕后通过检查
+    const u64  payload      = snapshot.size() - sizeof(IndexHeader);
+    const auto entries_size = static_cast<u64>(header.entry_count) * sizeof(IndexEntry);
+    if (entries_size > payload || header.name_units > (payload - entries_size) / sizeof(char16_t) ||
+        entries_size + header.name_units * sizeof(char16_t) != payload)
+        return false;
+
+    // 文件大小、修改时间与文件头任一不同都说明快照已过期
+    u64 archive_size;
+    i64 archive_mtime;
+    u64 current_hash;
+    if (!archive_stat(reader.get_path(), archive_size, archive_mtime) || archive_size != header.archive_size ||
+        archive_mtime != header.archive_mtime || !header_hash(current_hash) || current_hash != header.header_hash)
+        return false;
+
+    const auto *entries = reinterpret_cast<const IndexEntry *>(base + sizeof(IndexHeader));
+    const auto *names   = reinterpret_cast<const char16_t *>(base + sizeof(IndexHeader) + entries_size);
+
+    auto *new_root = new Node(Type::NotSet, this);
+    new_root->path = name;
+
+    size_t                           next  = 0;
+    std::function<bool(Node *, u64)> build = [&](Node *node, u64 count) {
+        for (u64 i = 0; i < count; ++i)
+        {
+            if (next >= header.entry_count)
+                return false;
+
+            IndexEntry entry;
+            memcpy(&entry, entries + next++, sizeof(entry));
+            if (static_cast<u64>(entry.name_offset) + entry.name_length > header.name_units)
+                return false;
+
+            auto *dir = new Directory(this, entry.image != 0, entry.size, entry.checksum, entry.offset);
+            node->appendChild(wzstring(names + entry.name_offset, entry.name_length), dir);
+            if (!build(dir, entry.child_count))
+                return false;
+        }
+        return true;
+    };
+
+    bool ok = true;
+    while (ok && next < header.entry_count)
+    {
+        ok = build(new_root, 1);
+    }
+    if (!ok)
+    {
+        delete new_root;
+        return false;
+    }
+
+    delete root;
+    root         = new_root;
+    desc.start   = header.start;
+    desc.hash    = header.hash;
+    desc.version = header.version_number;
+    return true;
+}
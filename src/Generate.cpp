@@ -0,0 +1,780 @@
+#include "Generate.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include <zlib.h>
+
+#include "Hash.hpp"
+#include "Keys.hpp"
+#include "Pixel.hpp"
+#include "Verify.hpp"
+#include "Wz.hpp"
+
+namespace wz
+{
+    namespace
+    {
+        const char copyright[] = "Package file v1.0 Copyright 2002 Wizet, ZZF";
+
+        const CanvasFormat canvas_formats[] = {
+            CanvasFormat::BGRA4444,
+            CanvasFormat::BGRA8888,
+            CanvasFormat::RGB565,
+            CanvasFormat::RGB565Block,
+            CanvasFormat::DXT3,
+            CanvasFormat::DXT5,
+        };
+
+        // 声音头中的DirectShow GUID：MEDIATYPE_Stream、MEDIASUBTYPE_WAVE/MPEG1Audio、WMFORMAT_WaveFormatEx
+        const u8 guid_stream[16] = {0x83, 0xEB, 0x36, 0xE4, 0x4F, 0x52, 0xCE, 0x11,
+                                    0x9F, 0x53, 0x00, 0x20, 0xAF, 0x0B, 0xA7, 0x70};
+        const u8 guid_wave[16]   = {0x8B, 0xEB, 0x36, 0xE4, 0x4F, 0x52, 0xCE, 0x11,
+                                    0x9F, 0x53, 0x00, 0x20, 0xAF, 0x0B, 0xA7, 0x70};
+        const u8 guid_mpeg[16]   = {0x87, 0xEB, 0x36, 0xE4, 0x4F, 0x52, 0xCE, 0x11,
+                                    0x9F, 0x53, 0x00, 0x20, 0xAF, 0x0B, 0xA7, 0x70};
+        const u8 guid_format[16] = {0x81, 0x9F, 0x58, 0x05, 0x56, 0xC3, 0xCE, 0x11,
+                                    0xBF, 0x01, 0x00, 0xAA, 0x00, 0x55, 0x59, 0x5A};
+
+        // 加密画布每块的字节数
+        constexpr size_t canvas_block = 4096;
+
+        // splitmix64，每个image各自一个，生成结果与线程调度无关
+        class Random
+        {
+        public:
+            explicit Random(u64 seed) : state(seed) {}
+
+            u64 next()
+            {
+                u64 z = (state += 0x9E3779B97F4A7C15ull);
+                z     = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z     = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                return z ^ (z >> 31);
+            }
+
+            i32 range(i32 low, i32 high) { return low + static_cast<i32>(next() % static_cast<u64>(high - low + 1)); }
+
+        private:
+            u64 state;
+        };
+
+        // 目录中第i个image的名称，不含.img
+        wzstring image_stem(u32 i)
+        {
+            auto text = std::to_string(i);
+            text      = std::string(text.size() < 5 ? 5 - text.size() : 0, '0') + text;
+            return {text.begin(), text.end()};
+        }
+
+        class ByteWriter
+        {
+        public:
+            ByteWriter(std::vector<u8> &out, MutableKey &key) : out(out), key(key) {}
+
+            std::vector<u8> &out;
+            MutableKey      &key;
+
+            template <typename T>
+            void put(T value)
+            {
+                const auto position = out.size();
+                out.resize(position + sizeof(T));
+                memcpy(out.data() + position, &value, sizeof(T));
+            }
+
+            template <typename T>
+            void put_at(size_t position, T value)
+            {
+                memcpy(out.data() + position, &value, sizeof(T));
+            }
+
+            void bytes(const u8 *data, size_t size) { out.insert(out.end(), data, data + size); }
+
+            // 与Reader::read_compressed_int对应；wide为true时总是写成5字节，长度与数值无关
+            void compressed_int(i32 value, bool wide = false)
+            {
+                if (!wide && value > INT8_MIN && value <= INT8_MAX)
+                {
+                    put<i8>(static_cast<i8>(value));
+                    return;
+                }
+                put<i8>(INT8_MIN);
+                put<i32>(value);
+            }
+
+            // 与Reader::read_wz_string对应：只含ASCII时按字节加密，否则按UTF-16加密
+            void wz_string(const wzstring &text)
+            {
+                const auto length = static_cast<i32>(text.size());
+                if (length == 0)
+                {
+                    put<i8>(0);
+                    return;
+                }
+
+                const bool ascii = std::all_of(text.begin(), text.end(), [](char16_t c) { return c < 0x80; });
+                if (ascii)
+                {
+                    if (length < 128)
+                    {
+                        put<i8>(static_cast<i8>(-length));
+                    }
+                    else
+                    {
+                        put<i8>(INT8_MIN);
+                        put<i32>(length);
+                    }
+
+                    u8 mask = 0xAA;
+                    for (i32 n = 0; n < length; ++n)
+                    {
+                        put<u8>(static_cast<u8>(text[n] ^ mask ^ key[n]));
+                        ++mask;
+                    }
+                    return;
+                }
+
+                if (length < 127)
+                {
+                    put<i8>(static_cast<i8>(length));
+                }
+                else
+                {
+                    put<i8>(127);
+                    put<i32>(length);
+                }
+
+                u16 mask = 0xAAAA;
+                for (i32 n = 0; n < length; ++n)
+                {
+                    const u16 key_unit = static_cast<u16>(key[2 * n] | (key[2 * n + 1] << 8));
+                    put<u16>(static_cast<u16>(text[n] ^ mask ^ key_unit));
+                    ++mask;
+                }
+            }
+        };
+
+        // ---- image ----
+
+        class ImageBuilder
+        {
+        public:
+            ImageBuilder(std::vector<u8> &out, MutableKey &key, const GeneratorOptions &options, u64 id)
+                : writer(out, key), options(options), id(id), random(id)
+            {
+            }
+
+            size_t canvases = 0;
+            size_t sounds   = 0;
+
+            void build()
+            {
+                // 文件头中的"Property"之后可以被字符串块回引
+                writer.put<u8>(0x73);
+                strings.emplace(u"Property", static_cast<u32>(writer.out.size()));
+                writer.wz_string(u"Property");
+                writer.put<u16>(0);
+
+                const u32 sound_count = options.sounds;
+                writer.compressed_int(static_cast<i32>(5 + sound_count));
+
+                property(u"info", [&] { info(); });
+
+                name(u"frames");
+                extended([&] {
+                    type_name(u"Property");
+                    writer.put<u16>(0);
+                    writer.compressed_int(static_cast<i32>(options.canvases + (options.canvases != 0 ? 1 : 0)));
+                    for (u32 i = 0; i < options.canvases; ++i)
+                    {
+                        name(number(i));
+                        extended([&] { canvas(i); });
+                    }
+                    if (options.canvases != 0)
+                    {
+                        // 指向同级画布的UOL
+                        name(u"last");
+                        extended([&] { uol(number(options.canvases - 1)); });
+                    }
+                });
+
+                name(u"hitbox");
+                extended([&] {
+                    type_name(u"Shape2D#Convex2D");
+                    writer.compressed_int(4);
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        vector(random.range(-300, 300), random.range(-300, 300));
+                    }
+                });
+
+                name(u"link");
+                extended([&] { uol(options.canvases != 0 ? u"frames/0" : u"info"); });
+
+                name(u"empty");
+                writer.put<u8>(0);
+
+                for (u32 i = 0; i < sound_count; ++i)
+                {
+                    name(u"sound" + number(i));
+                    extended([&] { sound(i); });
+                }
+            }
+
+        private:
+            ByteWriter              writer;
+            const GeneratorOptions &options;
+            u64                     id;
+            Random                  random;
+
+            // 已写出的字符串，值为wz字符串相对image起点的偏移
+            std::map<wzstring, u32> strings;
+
+            static wzstring number(u64 value)
+            {
+                const auto text = std::to_string(value);
+                return {text.begin(), text.end()};
+            }
+
+            // 字符串块：第一次出现时内联，之后以相对image起点的偏移回引
+            void string_block(const wzstring &text, u8 inline_tag, u8 reference_tag)
+            {
+                if (auto it = strings.find(text); it != strings.end())
+                {
+                    writer.put<u8>(reference_tag);
+                    writer.put<u32>(it->second);
+                    return;
+                }
+
+                writer.put<u8>(inline_tag);
+                strings.emplace(text, static_cast<u32>(writer.out.size()));
+                writer.wz_string(text);
+            }
+
+            void name(const wzstring &text) { string_block(text, 0, 1); }
+
+            void type_name(const wzstring &text) { string_block(text, 0x73, 0x1B); }
+
+            // 类型9：u32长度之后是扩展属性
+            template <typename F>
+            void extended(const F &body)
+            {
+                writer.put<u8>(9);
+                const auto length_at = writer.out.size();
+                writer.put<u32>(0);
+                body();
+                writer.put_at<u32>(length_at, static_cast<u32>(writer.out.size() - length_at - sizeof(u32)));
+            }
+
+            template <typename F>
+            void property(const wzstring &property_name, const F &body)
+            {
+                name(property_name);
+                extended([&] {
+                    type_name(u"Property");
+                    writer.put<u16>(0);
+                    body();
+                });
+            }
+
+            void info()
+            {
+                writer.compressed_int(12);
+
+                name(u"version");
+                writer.put<u8>(3);
+                writer.compressed_int(random.range(0, 100));
+
+                name(u"id");
+                writer.put<u8>(3);
+                writer.compressed_int(static_cast<i32>(100000000 + id % 900000000));
+
+                name(u"flags");
+                writer.put<u8>(2);
+                writer.put<u16>(static_cast<u16>(random.next()));
+
+                name(u"scale");
+                writer.put<u8>(4);
+                writer.put<u8>(0x80);
+                writer.put<f32>(static_cast<f32>(random.range(1, 400)) / 100.f);
+
+                name(u"zero");
+                writer.put<u8>(4);
+                writer.put<u8>(0);
+
+                name(u"ratio");
+                writer.put<u8>(5);
+                writer.put<f64>(static_cast<f64>(random.next() % 1000000) / 7.0);
+
+                name(u"name");
+                writer.put<u8>(8);
+                string_block(u"image" + number(id % 1000000), 0, 1);
+
+                // 非ASCII字符串走UTF-16编码
+                name(u"title");
+                writer.put<u8>(8);
+                string_block(u"合成数据 " + number(id % 1000), 0, 1);
+
+                // 值与另一个属性名相同，第二次出现时回引
+                name(u"tag");
+                writer.put<u8>(8);
+                string_block(u"version", 0, 1);
+
+                // 以名称引用某个目录中的image，类似地图引用Back、Tile与Obj中的素材；
+                // 只由id决定，不随images变化，images不足8时部分引用不存在
+                name(u"ref");
+                writer.put<u8>(8);
+                string_block(image_stem(static_cast<u32>(id % 8)), 0, 1);
+
+                name(u"origin");
+                extended([&] { vector(random.range(-64, 64), random.range(-64, 64)); });
+
+                name(u"back");
+                extended([&] { uol(u"../link"); });
+            }
+
+            void vector(i32 x, i32 y)
+            {
+                type_name(u"Shape2D#Vector2D");
+                writer.compressed_int(x);
+                writer.compressed_int(y);
+            }
+
+            void uol(const wzstring &path)
+            {
+                type_name(u"UOL");
+                writer.put<u8>(0);
+                string_block(path, 0, 1);
+            }
+
+            void canvas(u32 n)
+            {
+                const auto format    = canvas_formats[(id + n) % std::size(canvas_formats)];
+                // 每经过一轮格式翻转一次，画布足够多时每种格式都有加密与未加密两种
+                const bool encrypted = ((id >> 16) + n + n / std::size(canvas_formats)) % 2 == 1;
+                ++canvases;
+
+                i32 width  = std::max(options.canvas_width, 1);
+                i32 height = std::max(options.canvas_height, 1);
+                if (format == CanvasFormat::RGB565Block)
+                {
+                    width  = (width + 15) / 16 * 16;
+                    height = (height + 15) / 16 * 16;
+                }
+
+                type_name(u"Canvas");
+                writer.put<u8>(0);
+                writer.put<u8>(1);
+                writer.put<u16>(0);
+                writer.compressed_int(3);
+                name(u"origin");
+                extended([&] { vector(width / 2, height); });
+                name(u"z");
+                writer.put<u8>(3);
+                writer.compressed_int(random.range(-5, 5));
+                name(u"delay");
+                writer.put<u8>(3);
+                writer.compressed_int(random.range(60, 240));
+
+                writer.compressed_int(width);
+                writer.compressed_int(height);
+                writer.compressed_int(static_cast<i32>(format));
+                writer.put<u8>(0);
+                writer.put<u32>(0);
+
+                const auto compressed = compress(pixels(format, width, height), options.compression);
+                const auto size_at    = writer.out.size();
+                writer.put<i32>(0);
+                writer.put<u8>(0);
+
+                const auto data_at = writer.out.size();
+                if (!encrypted)
+                {
+                    writer.bytes(compressed.data(), compressed.size());
+                }
+                else
+                {
+                    // 加密画布：[i32 长度][与密钥流异或的数据]，每块从密钥流开头重新开始
+                    for (size_t begin = 0; begin < compressed.size(); begin += canvas_block)
+                    {
+                        const auto block = std::min(canvas_block, compressed.size() - begin);
+                        writer.put<i32>(static_cast<i32>(block));
+                        const auto at = writer.out.size();
+                        writer.out.resize(at + block);
+                        for (size_t i = 0; i < block; ++i)
+                        {
+                            writer.out[at + i] = static_cast<u8>(compressed[begin + i] ^ writer.key[i]);
+                        }
+                    }
+                }
+                writer.put_at<i32>(size_at, static_cast<i32>(writer.out.size() - data_at + 1));
+            }
+
+            std::vector<u8> pixels(CanvasFormat format, i32 width, i32 height)
+            {
+                const auto pixels = static_cast<size_t>(width) * height;
+                size_t     size;
+                switch (format)
+                {
+                    case CanvasFormat::BGRA8888:
+                        size = pixels * 4;
+                        break;
+                    case CanvasFormat::RGB565Block:
+                        size = pixels / 128;
+                        break;
+                    case CanvasFormat::DXT3:
+                    case CanvasFormat::DXT5:
+                        size = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * 16;
+                        break;
+                    default:
+                        size = pixels * 2;
+                        break;
+                }
+
+                // 渐变上每8字节改写一个随机字节，压缩率约为2.5倍，与真实贴图接近
+                std::vector<u8> data(size);
+                const auto      base = static_cast<u8>(random.next());
+                for (size_t i = 0; i < size; ++i)
+                {
+                    data[i] = static_cast<u8>(base + (i >> 6));
+                }
+                for (size_t i = 0; i < size; i += 8)
+                {
+                    const u64 noise = random.next();
+                    data[std::min(size - 1, i + (noise & 7))] ^= static_cast<u8>(noise >> 8);
+                }
+                return data;
+            }
+
+            // 以Z_RLE策略生成raw deflate，再补上0x78 0x9C头与adler32；
+            // 头部与zlib默认级别相同，解析时据此判断画布未加密
+            static std::vector<u8> compress(const std::vector<u8> &data, int level)
+            {
+                z_stream stream {};
+                deflateInit2(&stream, std::clamp(level, 0, 9), Z_DEFLATED, -15, 8, Z_RLE);
+
+                std::vector<u8> out(deflateBound(&stream, static_cast<uLong>(data.size())) + 6);
+                out[0]           = 0x78;
+                out[1]           = 0x9C;
+                stream.next_in   = const_cast<Bytef *>(data.data());
+                stream.avail_in  = static_cast<uInt>(data.size());
+                stream.next_out  = out.data() + 2;
+                stream.avail_out = static_cast<uInt>(out.size() - 6);
+                deflate(&stream, Z_FINISH);
+
+                auto size = 2 + stream.total_out;
+                deflateEnd(&stream);
+
+                const auto adler = adler32(adler32(0, nullptr, 0), data.data(), static_cast<uInt>(data.size()));
+                for (int i = 0; i < 4; ++i)
+                {
+                    out[size++] = static_cast<u8>(adler >> (24 - 8 * i));
+                }
+                out.resize(size);
+                return out;
+            }
+
+            void sound(u32 n)
+            {
+                const bool mp3 = (id + n) % 2 == 1;
+                ++sounds;
+
+                // WAVEFORMATEX，MP3为30字节的MPEGLAYER3WAVEFORMAT
+                std::vector<u8> format;
+                ByteWriter      header(format, writer.key);
+                header.put<u16>(mp3 ? 0x55 : 1);
+                header.put<u16>(2);
+                header.put<u32>(44100);
+                header.put<u32>(mp3 ? 16000 : 176400);
+                header.put<u16>(mp3 ? 1 : 4);
+                header.put<u16>(mp3 ? 0 : 16);
+                header.put<u16>(mp3 ? 12 : 0);
+                if (mp3)
+                {
+                    header.put<u16>(1);
+                    header.put<u32>(2);
+                    header.put<u16>(417);
+                    header.put<u16>(1);
+                    header.put<u16>(1393);
+                }
+
+                // 一半的声音头加密；密钥流使cbSize恰好仍然自洽时无法区分，保持明文
+                if ((id + n) % 4 >= 2)
+                {
+                    std::vector<u8> encrypted(format);
+                    for (size_t i = 0; i < encrypted.size(); ++i)
+                    {
+                        encrypted[i] ^= writer.key[i];
+                    }
+                    if (18 + (encrypted[16] | (encrypted[17] << 8)) != static_cast<int>(encrypted.size()))
+                        format = std::move(encrypted);
+                }
+
+                std::vector<u8> data(options.sound_bytes);
+                for (size_t i = 0; i < data.size(); i += 8)
+                {
+                    const u64 value = random.next();
+                    memcpy(data.data() + i, &value, std::min<size_t>(8, data.size() - i));
+                }
+                if (mp3)
+                {
+                    // 每417字节一个MPEG-1 Layer III帧头
+                    for (size_t i = 0; i + 4 <= data.size(); i += 417)
+                    {
+                        data[i]     = 0xFF;
+                        data[i + 1] = 0xFB;
+                        data[i + 2] = 0x90;
+                        data[i + 3] = 0x64;
+                    }
+                }
+
+                const u32 byte_rate = mp3 ? 16000 : 176400;
+                type_name(u"Sound_DX8");
+                writer.put<u8>(0);
+                writer.compressed_int(static_cast<i32>(data.size()));
+                writer.compressed_int(static_cast<i32>(static_cast<u64>(data.size()) * 1000 / byte_rate));
+
+                writer.put<u8>(2);
+                writer.bytes(guid_stream, 16);
+                writer.bytes(mp3 ? guid_mpeg : guid_wave, 16);
+                writer.put<u8>(0);
+                writer.put<u8>(1);
+                writer.bytes(guid_format, 16);
+                writer.put<u8>(static_cast<u8>(format.size()));
+                writer.bytes(format.data(), format.size());
+                writer.bytes(data.data(), data.size());
+            }
+        };
+
+        // ---- 目录表 ----
+
+        struct GenDirectory
+        {
+            wzstring                  name;
+            bool                      image = false;
+            u64                       index = 0; // image的全局序号
+            std::vector<GenDirectory> children;
+        };
+
+        // image的内容只由seed(reseed_path下为seed + 1)与路径决定，增删其他image不影响它的字节
+        void build_tree(GenDirectory &dir, const wzstring &path, const GeneratorOptions &options, u32 depth,
+                        std::vector<u64> &images, size_t &directories)
+        {
+            if (depth < options.depth)
+            {
+                for (u32 i = 0; i < options.fanout; ++i)
+                {
+                    GenDirectory child;
+                    const auto   text = "Dir" + std::to_string(i);
+                    child.name        = {text.begin(), text.end()};
+                    build_tree(child, path + u"/" + child.name, options, depth + 1, images, directories);
+                    dir.children.push_back(std::move(child));
+                    ++directories;
+                }
+            }
+
+            // 每个目录都有image，根目录的image让版本探测只接受正确的版本哈希
+            for (u32 i = 0; i < options.images; ++i)
+            {
+                GenDirectory image;
+                image.name  = image_stem(i) + u".img";
+                image.image = true;
+                image.index = images.size();
+
+                const auto image_path = path + u"/" + image.name;
+                const bool reseed     = !options.reseed_path.empty() &&
+                                    image_path.compare(1, options.reseed_path.size(), options.reseed_path) == 0;
+                images.push_back(hash::xxh64(reinterpret_cast<const u8 *>(image_path.data()),
+                                             image_path.size() * sizeof(char16_t),
+                                             reseed ? options.seed + 1 : options.seed));
+                dir.children.push_back(std::move(image));
+            }
+        }
+
+        struct TableLayout
+        {
+            struct OffsetPatch
+            {
+                size_t              position; // 相对目录表起点
+                const GenDirectory *target;
+            };
+
+            std::vector<u8>                          bytes;
+            std::vector<OffsetPatch>                 offsets;
+            std::vector<std::pair<size_t, u64>>      image_fields; // 大小与校验和字段的位置，image序号
+            std::map<const GenDirectory *, size_t>   tables;       // 子目录的目录表位置
+            std::map<std::pair<u8, wzstring>, size_t> names;       // 已写出的目录项名称，相对目录表起点
+        };
+
+        // 目录表按前序排列：先写本目录的全部目录项，再依次写子目录的目录表
+        // data_offset: 目录表起点相对数据起点(文件头中的start)的偏移
+        void write_table(const GenDirectory &dir, TableLayout &layout, MutableKey &key, u32 data_offset)
+        {
+            ByteWriter writer(layout.bytes, key);
+            layout.tables[&dir] = layout.bytes.size();
+            writer.compressed_int(static_cast<i32>(dir.children.size()));
+
+            for (const auto &child : dir.children)
+            {
+                const u8 type = child.image ? 4 : 3;
+                if (auto it = layout.names.find({type, child.name}); it != layout.names.end())
+                {
+                    // 类型2：引用之前写出的[类型][名称]，偏移相对数据起点
+                    writer.put<u8>(2);
+                    writer.put<i32>(static_cast<i32>(data_offset + it->second));
+                }
+                else
+                {
+                    layout.names.emplace(std::make_pair(type, child.name), layout.bytes.size());
+                    writer.put<u8>(type);
+                    writer.wz_string(child.name);
+                }
+
+                // 大小与校验和在image写出后回填，固定为5字节
+                if (child.image)
+                    layout.image_fields.emplace_back(layout.bytes.size(), child.index);
+                writer.compressed_int(0, true);
+                writer.compressed_int(0, true);
+                layout.offsets.push_back({layout.bytes.size(), &child});
+                writer.put<u32>(0);
+            }
+
+            for (const auto &child : dir.children)
+            {
+                if (!child.image)
+                    write_table(child, layout, key, data_offset);
+            }
+        }
+
+        // 与File::get_wz_offset相反的运算
+        u32 encrypt_offset(u32 position, u32 target, u32 start, u32 hash)
+        {
+            u32 offset = ~(position - start);
+            offset *= hash;
+            offset -= OffsetKey;
+            const u32 shift = offset & 0x1Fu;
+            offset          = shift == 0 ? offset : (offset << shift) | (offset >> (32 - shift));
+            return offset ^ (target - start * 2);
+        }
+
+        u32 version_hash(i16 version)
+        {
+            u32        hash = 0;
+            const auto text = std::to_string(version);
+            for (const char c : text)
+            {
+                hash = 32 * hash + static_cast<u32>(c) + 1;
+            }
+            return hash;
+        }
+    }
+
+    bool generate_archive(const std::string &path, const GeneratorOptions &options, GeneratorResult *result, ThreadPool &pool)
+    {
+        std::vector<u8> aes_key(AesKey2, AesKey2 + 32);
+        MutableKey      key({options.iv[0], options.iv[1], options.iv[2], options.iv[3]}, aes_key);
+
+        GenDirectory     root;
+        std::vector<u64> ids;
+        size_t           directories = 0;
+        build_tree(root, {}, options, 0, ids, directories);
+        const u64 image_count = ids.size();
+
+        const u32 hash  = version_hash(options.version);
+        const u32 start = static_cast<u32>(4 + 8 + 4 + sizeof(copyright));
+        const i16 encrypted_version =
+            static_cast<i16>(0xFF ^ (hash >> 24 & 0xFF) ^ (hash >> 16 & 0xFF) ^ (hash >> 8 & 0xFF) ^ (hash & 0xFF));
+
+        // 目录表紧跟在版本号之后，image依次排在目录表之后
+        const u32   table_base = start + sizeof(i16);
+        TableLayout layout;
+        write_table(root, layout, key, table_base - start);
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+
+        std::vector<u32> offsets(image_count);
+        std::vector<i32> sizes(image_count);
+        std::vector<i32> checksums(image_count);
+
+        // image按序号分批并行生成，每批按顺序写出
+        const auto window = options.max_in_flight != 0 ? options.max_in_flight : pool.size() * 2;
+        std::vector<std::vector<u8>> buffers(std::min<u64>(window, image_count));
+        std::vector<size_t>          canvases(buffers.size());
+        std::vector<size_t>          sounds(buffers.size());
+
+        GeneratorResult totals;
+        totals.directories = directories;
+        totals.images      = image_count;
+
+        u64 position = table_base + layout.bytes.size();
+        out.seekp(static_cast<std::streamoff>(position));
+        for (u64 begin = 0; begin < image_count; begin += window)
+        {
+            const auto count = static_cast<size_t>(std::min<u64>(window, image_count - begin));
+            pool.parallel_for(count, [&](size_t n) {
+                buffers[n].clear();
+                ImageBuilder builder(buffers[n], key, options, ids[begin + n]);
+                builder.build();
+                canvases[n] = builder.canvases;
+                sounds[n]   = builder.sounds;
+            });
+
+            for (size_t n = 0; n < count; ++n)
+            {
+                const auto &image = buffers[n];
+                if (position + image.size() > UINT32_MAX)
+                    return false;
+
+                offsets[begin + n]   = static_cast<u32>(position);
+                sizes[begin + n]     = static_cast<i32>(image.size());
+                checksums[begin + n] = image_checksum(image.data(), image.size());
+                totals.canvases += canvases[n];
+                totals.sounds += sounds[n];
+
+                out.write(reinterpret_cast<const char *>(image.data()), static_cast<std::streamsize>(image.size()));
+                position += image.size();
+            }
+        }
+
+        // 回填目录表中的大小、校验和与加密偏移
+        ByteWriter table(layout.bytes, key);
+        for (const auto &[at, image] : layout.image_fields)
+        {
+            table.put_at<i32>(at + 1, sizes[image]);
+            table.put_at<i32>(at + 6, checksums[image]);
+        }
+        for (const auto &patch : layout.offsets)
+        {
+            const u32 target = patch.target->image ? offsets[patch.target->index]
+                                                   : static_cast<u32>(table_base + layout.tables[patch.target]);
+            table.put_at<u32>(patch.position,
+                              encrypt_offset(static_cast<u32>(table_base + patch.position), target, start, hash));
+        }
+
+        std::vector<u8> header;
+        ByteWriter      writer(header, key);
+        writer.bytes(reinterpret_cast<const u8 *>("PKG1"), 4);
+        writer.put<u64>(position - start);
+        writer.put<u32>(start);
+        writer.bytes(reinterpret_cast<const u8 *>(copyright), sizeof(copyright));
+        writer.put<i16>(encrypted_version);
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size()));
+        out.write(reinterpret_cast<const char *>(layout.bytes.data()), static_cast<std::streamsize>(layout.bytes.size()));
+        out.close();
+        if (!out)
+            return false;
+
+        totals.bytes = position;
+        if (result != nullptr)
+            *result = totals;
+        return true;
+    }
+}
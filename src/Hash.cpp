@@ -0,0 +1,104 @@
+#include "Hash.hpp"
+
+#include <cstring>
+
+namespace wz::hash
+{
+    namespace
+    {
+        constexpr u64 prime1 = 0x9E3779B185EBCA87ull;
+        constexpr u64 prime2 = 0xC2B2AE3D27D4EB4Full;
+        constexpr u64 prime3 = 0x165667B19E3779F9ull;
+        constexpr u64 prime4 = 0x85EBCA77C2B2AE63ull;
+        constexpr u64 prime5 = 0x27D4EB2F165667C5ull;
+
+        inline u64 rotl(u64 value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+        // wz文件为小端格式，这里同样按小端读取
+        inline u64 read64(const u8 *p)
+        {
+            u64 value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline u32 read32(const u8 *p)
+        {
+            u32 value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline u64 round(u64 acc, u64 input)
+        {
+            acc += input * prime2;
+            acc = rotl(acc, 31);
+            return acc * prime1;
+        }
+
+        inline u64 merge(u64 acc, u64 value)
+        {
+            acc ^= round(0, value);
+            return acc * prime1 + prime4;
+        }
+    }
+
+    u64 xxh64(const u8 *data, size_t size, u64 seed)
+    {
+        const u8 *p   = data;
+        const u8 *end = data + size;
+        u64       h;
+
+        if (size >= 32)
+        {
+            u64 v1 = seed + prime1 + prime2;
+            u64 v2 = seed + prime2;
+            u64 v3 = seed;
+            u64 v4 = seed - prime1;
+
+            for (const u8 *limit = end - 32; p <= limit; p += 32)
+            {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+            }
+
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = merge(h, v1);
+            h = merge(h, v2);
+            h = merge(h, v3);
+            h = merge(h, v4);
+        }
+        else
+        {
+            h = seed + prime5;
+        }
+
+        h += static_cast<u64>(size);
+
+        for (; p + 8 <= end; p += 8)
+        {
+            h ^= round(0, read64(p));
+            h = rotl(h, 27) * prime1 + prime4;
+        }
+        if (p + 4 <= end)
+        {
+            h ^= static_cast<u64>(read32(p)) * prime1;
+            h = rotl(h, 23) * prime2 + prime3;
+            p += 4;
+        }
+        for (; p < end; ++p)
+        {
+            h ^= static_cast<u64>(*p) * prime5;
+            h = rotl(h, 11) * prime1;
+        }
+
+        h ^= h >> 33;
+        h *= prime2;
+        h ^= h >> 29;
+        h *= prime3;
+        h ^= h >> 32;
+        return h;
+    }
+}
@@ -0,0 +1,212 @@
+#include "Inflate.hpp"
+
+#include <cstring>
+#include <vector>
+
+#if defined(WZ_INFLATE_LIBDEFLATE)
+    #include <libdeflate.h>
+#else
+    #include <zlib.h>
+#endif
+
+namespace wz::inflate
+{
+#if defined(WZ_INFLATE_LIBDEFLATE)
+    namespace
+    {
+        struct DecompressorDeleter
+        {
+            void operator()(libdeflate_decompressor *d) const { libdeflate_free_decompressor(d); }
+        };
+
+        // 解压器不是线程安全的，每个线程持有一个
+        libdeflate_decompressor *decompressor()
+        {
+            thread_local std::unique_ptr<libdeflate_decompressor, DecompressorDeleter> instance(
+                libdeflate_alloc_decompressor());
+            return instance.get();
+        }
+    }
+
+    const char *backend() { return "libdeflate"; }
+
+    bool decompress(const u8 *src, size_t src_size, u8 *dst, size_t dst_size)
+    {
+        size_t actual = 0;
+        return libdeflate_zlib_decompress(decompressor(), src, src_size, dst, dst_size, &actual) ==
+                   LIBDEFLATE_SUCCESS &&
+               actual == dst_size;
+    }
+
+    // libdeflate只支持整块解压，分段输入先收集到各实例自己的缓冲区；
+    // 同一线程中可以同时存在多个Stream与Pull(例如嵌套的画布解码)，不能共用线程内的缓冲区
+    struct Stream::State
+    {
+        u8             *dst;
+        size_t          dst_size;
+        std::vector<u8> input;
+    };
+
+    Stream::Stream(u8 *dst, size_t dst_size) : state(std::make_unique<State>(State {dst, dst_size, {}})) {}
+
+    Stream::~Stream() = default;
+
+    bool Stream::write(const u8 *src, size_t size)
+    {
+        state->input.insert(state->input.end(), src, src + size);
+        return true;
+    }
+
+    bool Stream::finish() { return decompress(state->input.data(), state->input.size(), state->dst, state->dst_size); }
+
+    // 不支持流式解压，第一次读取时整块解压到该实例的缓冲区
+    struct Pull::State
+    {
+        std::function<bool(const u8 *&, size_t &)> next_input;
+        size_t                                     total_size;
+        size_t                                     position = 0;
+        bool                                       ready    = false;
+        std::vector<u8>                            output;
+    };
+
+    Pull::Pull(std::function<bool(const u8 *&, size_t &)> next_input, size_t total_size)
+        : state(std::make_unique<State>(State {std::move(next_input), total_size, 0, false, {}}))
+    {
+    }
+
+    Pull::~Pull() = default;
+
+    bool Pull::read(u8 *dst, size_t size)
+    {
+        if (!state->ready)
+        {
+            std::vector<u8> input;
+            const u8       *data;
+            size_t          length;
+            while (state->next_input(data, length))
+            {
+                input.insert(input.end(), data, data + length);
+            }
+
+            state->output.resize(state->total_size);
+            if (!decompress(input.data(), input.size(), state->output.data(), state->total_size))
+                return false;
+            state->ready = true;
+        }
+
+        if (state->position + size > state->total_size)
+            return false;
+        std::memcpy(dst, state->output.data() + state->position, size);
+        state->position += size;
+        return true;
+    }
+#else
+    const char *backend() { return "zlib"; }
+
+    bool decompress(const u8 *src, size_t src_size, u8 *dst, size_t dst_size)
+    {
+        Stream stream(dst, dst_size);
+        return stream.write(src, src_size) && stream.finish();
+    }
+
+    struct Stream::State
+    {
+        z_stream stream {};
+        size_t   dst_size = 0;
+        int      ret      = Z_OK;
+    };
+
+    Stream::Stream(u8 *dst, size_t dst_size) : state(std::make_unique<State>())
+    {
+        state->dst_size         = dst_size;
+        state->stream.next_out  = dst;
+        state->stream.avail_out = static_cast<uInt>(dst_size);
+        state->ret              = inflateInit(&state->stream);
+    }
+
+    Stream::~Stream()
+    {
+        if (state->stream.state != nullptr)
+        {
+            inflateEnd(&state->stream);
+        }
+    }
+
+    bool Stream::write(const u8 *src, size_t size)
+    {
+        // 流已结束时忽略多余的输入
+        if (state->ret == Z_STREAM_END || size == 0)
+            return true;
+        if (state->ret != Z_OK)
+            return false;
+
+        state->stream.next_in  = const_cast<Bytef *>(src);
+        state->stream.avail_in = static_cast<uInt>(size);
+        state->ret             = ::inflate(&state->stream, Z_NO_FLUSH);
+
+        // 输出缓冲区已满但仍有输入，说明实际大小与预期不符
+        if (state->ret == Z_OK && state->stream.avail_in != 0)
+            state->ret = Z_BUF_ERROR;
+
+        return state->ret == Z_OK || state->ret == Z_STREAM_END;
+    }
+
+    bool Stream::finish()
+    {
+        return state->ret == Z_STREAM_END && state->stream.total_out == static_cast<uLong>(state->dst_size);
+    }
+
+    struct Pull::State
+    {
+        std::function<bool(const u8 *&, size_t &)> next_input;
+        z_stream                                   stream {};
+        int                                        ret = Z_OK;
+    };
+
+    Pull::Pull(std::function<bool(const u8 *&, size_t &)> next_input, size_t) : state(std::make_unique<State>())
+    {
+        state->next_input = std::move(next_input);
+        state->ret        = inflateInit(&state->stream);
+    }
+
+    Pull::~Pull()
+    {
+        if (state->stream.state != nullptr)
+        {
+            inflateEnd(&state->stream);
+        }
+    }
+
+    bool Pull::read(u8 *dst, size_t size)
+    {
+        auto &stream     = state->stream;
+        stream.next_out  = dst;
+        stream.avail_out = static_cast<uInt>(size);
+
+        while (stream.avail_out > 0)
+        {
+            if (state->ret != Z_OK)
+                return false;
+
+            if (stream.avail_in == 0)
+            {
+                const u8 *data;
+                size_t    length;
+                if (!state->next_input(data, length))
+                    return false;
+                stream.next_in  = const_cast<Bytef *>(data);
+                stream.avail_in = static_cast<uInt>(length);
+            }
+
+            state->ret = ::inflate(&stream, Z_NO_FLUSH);
+
+            // 流结束时已经取满也算成功
+            if (state->ret == Z_STREAM_END && stream.avail_out == 0)
+                return true;
+            if (state->ret == Z_BUF_ERROR && stream.avail_in == 0)
+                state->ret = Z_OK;
+        }
+        return true;
+    }
+#endif
+}
@@ -0,0 +1,95 @@
+#include "Json.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+#include "Wz.hpp"
+
+namespace wz::json
+{
+    void append_string(std::string &out, const std::string &text)
+    {
+        out += '"';
+        for (const auto c : text)
+        {
+            switch (c)
+            {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        out += escaped;
+                    }
+                    else
+                    {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    void append_string(std::string &out, const wzstring &text) { append_string(out, to_utf8(text)); }
+
+    void append_number(std::string &out, f64 value, int precision)
+    {
+        // JSON没有NaN与无穷大
+        if (!std::isfinite(value))
+        {
+            out += "null";
+            return;
+        }
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.*g", precision, value);
+        out += text;
+    }
+
+    void append_base64(std::string &out, const u8 *data, size_t size)
+    {
+        static constexpr char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        out.reserve(out.size() + (size + 2) / 3 * 4 + 2);
+        out += '"';
+        size_t i = 0;
+        for (; i + 3 <= size; i += 3)
+        {
+            const u32 v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+            out += table[v >> 18];
+            out += table[(v >> 12) & 0x3F];
+            out += table[(v >> 6) & 0x3F];
+            out += table[v & 0x3F];
+        }
+        if (i + 1 == size)
+        {
+            const u32 v = data[i] << 16;
+            out += table[v >> 18];
+            out += table[(v >> 12) & 0x3F];
+            out += "==";
+        }
+        else if (i + 2 == size)
+        {
+            const u32 v = (data[i] << 16) | (data[i + 1] << 8);
+            out += table[v >> 18];
+            out += table[(v >> 12) & 0x3F];
+            out += table[(v >> 6) & 0x3F];
+            out += '=';
+        }
+        out += '"';
+    }
+}
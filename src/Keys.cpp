@@ -1,64 +1,103 @@
 #include "Keys.hpp"
 #include "AES/AES.h"
 
+#include <cstring>
+#include <stdexcept>
+
 wz::MutableKey::MutableKey(const std::array<u8, 4>& new_iv, std::vector<u8> new_aes_key)
     : iv(new_iv), aes_key(std::move(new_aes_key)) {
 }
 
-u8& wz::MutableKey::operator[](size_t index) {
-    if (keys.empty() || keys.size() <= index) {
+wz::MutableKey::MutableKey(const MutableKey& other) {
+    *this = other;
+}
+
+wz::MutableKey& wz::MutableKey::operator=(const MutableKey& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    std::scoped_lock lock(mutex, other.mutex);
+    iv = other.iv;
+    aes_key = other.aes_key;
+    batches.reset();
+
+    const auto count = other.generated.load();
+    if (count > 0) {
+        batches = std::make_unique<std::unique_ptr<u8[]>[]>(max_batches);
+        for (size_t b = 0; b < count / batch_size; ++b) {
+            batches[b] = std::make_unique<u8[]>(batch_size);
+            memcpy(batches[b].get(), other.batches[b].get(), batch_size);
+        }
+    }
+    generated = count;
+
+    return *this;
+}
+
+const u8& wz::MutableKey::operator[](size_t index) {
+    if (index >= generated.load(std::memory_order_acquire)) {
         ensure_key_size(index + 1);
     }
-    return keys[index];
+    return batches[index / batch_size][index % batch_size];
+}
+
+void wz::MutableKey::ensure(size_t size) {
+    if (size > generated.load(std::memory_order_acquire)) {
+        ensure_key_size(size);
+    }
+}
+
+size_t wz::MutableKey::size() const {
+    return generated.load(std::memory_order_acquire);
 }
 
 void wz::MutableKey::ensure_key_size(size_t size) {
-    size = static_cast<i32>(ceil(1.0 * size / batch_size) * batch_size);
-    decltype(keys) new_keys;
-    new_keys.reserve(size);
-    if (*reinterpret_cast<i32*>(iv.data()) == 0) {
-        keys = new_keys;
+    std::lock_guard lock(mutex);
+
+    const auto have = generated.load(std::memory_order_relaxed);
+    if (size <= have) {
         return;
     }
 
-    auto start_index = 0;
+    const auto needed = (size + batch_size - 1) / batch_size;
+    if (needed > max_batches) {
+        throw std::length_error("key stream too long");
+    }
 
-    if (!keys.empty()) {
-        std::copy(keys.begin(), keys.end(), new_keys.begin());
-        start_index = keys.size();
+    if (!batches) {
+        batches = std::make_unique<std::unique_ptr<u8[]>[]>(max_batches);
     }
 
+    // IV全为0时不加密，密钥流全为0
+    const bool plain = *reinterpret_cast<i32*>(iv.data()) == 0;
+
     AES aes(256, 128);
 
-    for (int i = start_index; i < size; i += 16) {
-        if (i == 0) {
+    for (size_t b = have / batch_size; b < needed; ++b) {
+        auto batch = std::make_unique<u8[]>(batch_size);
+
+        // 第一块由IV重复4次加密得到，之后每块由前16字节加密得到，跨批次时沿用上一批的最后16字节
+        for (size_t i = 0; !plain && i < batch_size; i += 16) {
             u8 block[16];
-            for (int n = 0; n < 16; ++n) {
-                block[n] = iv[n % 4];
-            }
-            u32 out_len;
-            auto* eb = aes.EncryptECB(&block[0], 16, aes_key.data(), out_len);
-            u8 buf[16];
-            memcpy(buf, eb, 16);
-            delete[] eb;
-            for (unsigned char & n : buf) {
-                new_keys.emplace_back(n);
+            if (b == 0 && i == 0) {
+                for (int n = 0; n < 16; ++n) {
+                    block[n] = iv[n % 4];
+                }
+            } else if (i == 0) {
+                memcpy(block, batches[b - 1].get() + batch_size - 16, 16);
+            } else {
+                memcpy(block, batch.get() + i - 16, 16);
             }
-        } else {
-            size_t len = 16;
+
             u32 out_len;
-            auto* eb = aes.EncryptECB(new_keys.data() + i - 16, len, aes_key.data(), out_len);
-            u8 buf[len];
-            memcpy(buf, eb, 16);
+            auto* eb = aes.EncryptECB(block, 16, aes_key.data(), out_len);
+            memcpy(batch.get() + i, eb, 16);
             delete[] eb;
-            for (unsigned char & n : buf) {
-                new_keys.emplace_back(n);
-            }
-
         }
-    }
 
-    keys = new_keys;
+        batches[b] = std::move(batch);
+    }
 
+    generated.store(needed * batch_size, std::memory_order_release);
 }
-
@@ -0,0 +1,138 @@
+#include "Memory.hpp"
+
+#include <cstdio>
+#include <string>
+
+#include "Directory.hpp"
+#include "Property.hpp"
+
+namespace wz
+{
+    namespace
+    {
+        // 字符串的堆缓冲区；数据位于对象内部时为短字符串优化，没有堆分配
+        size_t string_heap(const wzstring &text)
+        {
+            const auto *data   = reinterpret_cast<const char *>(text.data());
+            const auto *object = reinterpret_cast<const char *>(&text);
+            if (data >= object && data < object + sizeof(text))
+                return 0;
+            return (text.capacity() + 1) * sizeof(char16_t);
+        }
+
+        size_t object_size(const Node *node)
+        {
+            switch (node->type)
+            {
+                case Type::Directory:
+                case Type::Image:
+                    return dynamic_cast<const Directory *>(node) != nullptr ? sizeof(Directory) : sizeof(Node);
+                case Type::Null:
+                    return sizeof(Property<WzNull>);
+                case Type::Int:
+                    return sizeof(Property<i32>);
+                case Type::UnsignedShort:
+                    return sizeof(Property<u16>);
+                case Type::Float:
+                    return sizeof(Property<f32>);
+                case Type::Double:
+                    return sizeof(Property<f64>);
+                case Type::String:
+                    return sizeof(Property<wzstring>);
+                case Type::SubProperty:
+                    return sizeof(Property<WzSubProp>);
+                case Type::Canvas:
+                    return sizeof(Property<WzCanvas>);
+                case Type::Vector2D:
+                    return sizeof(Property<WzVec2D>);
+                case Type::Convex2D:
+                    return sizeof(Property<WzConvex>);
+                case Type::Sound:
+                    return sizeof(Property<WzSound>);
+                case Type::UOL:
+                    return sizeof(Property<WzUOL>);
+                default:
+                    return sizeof(Node);
+            }
+        }
+
+        // std::map的树节点：颜色与三个指针，之后是键值对
+        constexpr size_t map_node_size = sizeof(WzMap::value_type) + 4 * sizeof(void *);
+
+        void measure(const Node *node, NodeMemory &out)
+        {
+            ++out.nodes;
+            out.node_bytes += object_size(node);
+            out.path_bytes += string_heap(node->path);
+
+            if (node->type == Type::String)
+                out.string_bytes += string_heap(static_cast<const Property<wzstring> *>(node)->get());
+            else if (node->type == Type::UOL)
+                out.string_bytes += string_heap(static_cast<const Property<WzUOL> *>(node)->get().uol);
+
+            for (const auto &[name, list] : node->get_children())
+            {
+                out.node_bytes += map_node_size + list.capacity() * sizeof(Node *);
+                out.name_bytes += string_heap(name);
+                for (const auto *child : list)
+                {
+                    measure(child, out);
+                }
+            }
+        }
+
+        std::string format_bytes(size_t bytes)
+        {
+            char text[32];
+            if (bytes < 1024)
+                std::snprintf(text, sizeof(text), "%zu B", bytes);
+            else if (bytes < 1048576)
+                std::snprintf(text, sizeof(text), "%.1f KiB", static_cast<double>(bytes) / 1024.0);
+            else
+                std::snprintf(text, sizeof(text), "%.2f MiB", static_cast<double>(bytes) / 1048576.0);
+            return text;
+        }
+    }
+
+    NodeMemory measure_tree(const Node *node)
+    {
+        NodeMemory memory;
+        if (node != nullptr)
+            measure(node, memory);
+        return memory;
+    }
+
+    void write_text(const MemoryReport &report, std::ostream &out)
+    {
+        auto line = [&](const char *label, const NodeMemory &memory) {
+            char text[256];
+            std::snprintf(text, sizeof(text), "%-12s %12s  nodes %zu, objects %s, names %s, strings %s, paths %s\n", label,
+                          format_bytes(memory.total()).c_str(), memory.nodes, format_bytes(memory.node_bytes).c_str(),
+                          format_bytes(memory.name_bytes).c_str(), format_bytes(memory.string_bytes).c_str(),
+                          format_bytes(memory.path_bytes).c_str());
+            out << text;
+        };
+
+        line("directories", report.directories);
+        line("images", report.images);
+        if (report.retired.nodes != 0)
+            line("retired", report.retired);
+
+        char text[256];
+        std::snprintf(text, sizeof(text), "%-12s %12s\n%-12s %12s  budget %s\n%-12s %12s  %zu images cached\n", "keystream",
+                      format_bytes(report.keystream_bytes).c_str(), "textures", format_bytes(report.texture_bytes).c_str(),
+                      format_bytes(report.texture_budget).c_str(), "total", format_bytes(report.total()).c_str(),
+                      report.image_count);
+        out << text;
+
+        if (report.largest.empty())
+            return;
+        out << "largest images:\n";
+        for (const auto &image : report.largest)
+        {
+            std::snprintf(text, sizeof(text), "%12s  %8zu nodes  ", format_bytes(image.memory.total()).c_str(),
+                          image.memory.nodes);
+            out << text << to_utf8(image.path) << '\n';
+        }
+    }
+}
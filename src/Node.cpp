@@ -2,7 +2,9 @@
 #include "Directory.hpp"
 #include "File.hpp"
 #include "Property.hpp"
+#include "Trace.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <ranges>
 
@@ -13,6 +15,7 @@ namespace wz
     Node::Node(const Type& new_type, File* root_file) : type(new_type), parent(nullptr), file(root_file)
     {
         reader = &file->reader;
+        file->get_counters().add_node(new_type);
     }
 
     // 释放Node对象占用的内存，遍历其子节点并删除它们
@@ -163,9 +166,31 @@ namespace wz
      */
     void Node::parse_extended_prop(const wzstring& name, Node* target, const size_t& offset)
     {
+        trace::LibraryScope span("parse_extended_prop");
+        const auto          start = this->reader->get_position();
+
         // 根据偏移量读取属性名称的字符串块
         auto strPropName = this->reader->read_string_block(offset);
 
+        if (span.active())
+        {
+            // span名按扩展属性类型区分，需要静态字符串
+            static const std::pair<const char16_t*, const char*> names[] = {
+                {u"Property", "parse_extended_prop/Property"},
+                {u"Canvas", "parse_extended_prop/Canvas"},
+                {u"Shape2D#Vector2D", "parse_extended_prop/Shape2D#Vector2D"},
+                {u"Shape2D#Convex2D", "parse_extended_prop/Shape2D#Convex2D"},
+                {u"Sound_DX8", "parse_extended_prop/Sound_DX8"},
+                {u"UOL", "parse_extended_prop/UOL"},
+            };
+            for (const auto& [type, span_name] : names)
+            {
+                if (strPropName == type)
+                    span.set_name(span_name);
+            }
+            span.set_path(target->path + u"/" + name);
+        }
+
         // 根据属性名称的值，选择性地解析并处理不同类型的属性
         if (strPropName == u"Property")
         {
@@ -235,6 +260,8 @@ namespace wz
             // 如果属性名称不匹配任何已知类型，断言失败
             assert(0);
         }
+
+        span.set_bytes(this->reader->get_position() - start);
     }
 
     /**
@@ -295,6 +322,13 @@ namespace wz
                 canvas.uncompressed_size = canvas.width * canvas.height / 128;
             }
             break;
+            case 1026: // DXT3，对应BC2
+            case 2050: // DXT5，对应BC3
+            {
+                // 每个4x4块16字节，可通过get_compressed直接作为压缩纹理使用
+                canvas.uncompressed_size = ((canvas.width + 3) / 4) * ((canvas.height + 3) / 4) * 16;
+            }
+            break;
         }
 
         // 将读取位置重置到画布的偏移量加上画布的大小，为后续读取准备
@@ -323,14 +357,38 @@ namespace wz
         sound.size   = reader->read_compressed_int();
         sound.length = reader->read_compressed_int();
 
-        // 快进到声音数据的起始位置
-        reader->set_position(reader->get_position() + 56);
+        // 声音头：51字节的媒体类型GUID，1字节的格式长度，随后是WAVEFORMATEX
+        sound.header_offset = reader->get_position();
+        reader->skip(51);
+        const auto format_size = reader->read<u8>();
+        sound.header_size      = 51 + 1 + format_size;
 
-        // 读取声音的频率
-        sound.frequency = reader->read<i32>();
+        // WAVEFORMATEX至少18字节，cbSize与格式长度对不上时说明这段数据被加密
+        if (format_size >= 18)
+        {
+            const auto *src = reader->data(reader->get_position());
+            std::vector<u8> format(src, src + format_size);
+            if (18 + (format[16] | (format[17] << 8)) != format_size)
+            {
+                auto &key = get_key();
+                for (size_t i = 0; i < format.size(); ++i)
+                {
+                    format[i] ^= key[i];
+                }
+            }
+
+            const auto u16_at = [&](size_t i) { return static_cast<u16>(format[i] | (format[i + 1] << 8)); };
+            const auto u32_at = [&](size_t i) { return static_cast<u32>(u16_at(i) | (u16_at(i + 2) << 16)); };
+
+            sound.codec           = static_cast<SoundCodec>(u16_at(0));
+            sound.channels        = u16_at(2);
+            sound.frequency       = static_cast<i32>(u32_at(4));
+            sound.byte_rate       = u32_at(8);
+            sound.block_align     = u16_at(12);
+            sound.bits_per_sample = u16_at(14);
+        }
 
-        // 再次快进以忽略一些未使用的数据
-        reader->set_position(reader->get_position() + 22);
+        reader->set_position(sound.header_offset + sound.header_size);
 
         // 记录声音数据在文件中的偏移量
         sound.offset = reader->get_position();
@@ -393,32 +451,21 @@ namespace wz
                 node = node->get_child(part);
                 if (node != nullptr)
                 {
-                    // 处理UOL节点，通过动态转换获取UOL对象
+                    // 处理UOL节点，链接已在image加载时解析，这里只需一次指针跳转
                     if (node->type == Type::UOL)
                     {
                         node = dynamic_cast<Property<WzUOL>*>(node)->get_uol();
                     }
 
-                    // 处理Image节点，缓存image节点以提高后续查找效率
-                    if (node->type == Type::Image)
+                    // 处理Image节点，由File缓存image节点以提高后续查找效率
+                    if (node != nullptr && node->type == Type::Image)
                     {
-                        static std::map<std::u16string, Node*> img_map;
-                        auto                                   it = img_map.find(node->path);
-                        if (it != img_map.end())
-                        {
-                            node = it->second;
-                        }
-                        else
-                        {
-                            auto* image = new Node();
-                            auto* dir   = dynamic_cast<Directory*>(node);
-                            dir->parse_image(image);
-                            node                = image;
-                            img_map[node->path] = node;
-                        }
+                        auto* dir = dynamic_cast<Directory*>(node);
+                        node      = dir->file->load_image(dir);
                     }
                 }
-                else
+
+                if (node == nullptr)
                 {
                     // 如果子节点不存在，立即返回nullptr，表示未找到路径所指节点
                     throw std::runtime_error("Node not found");
@@ -525,26 +572,19 @@ namespace wz
                 // 获取当前节点的子节点，如果存在
                 node = node->get_child(part);
                 if (node != nullptr) {
-                    // 处理UOL节点，通过动态转换获取UOL对象
+                    // 处理UOL节点，链接已在image加载时解析，这里只需一次指针跳转
                     if (node->type == Type::UOL) {
                         node = dynamic_cast<Property<WzUOL>*>(node)->get_uol();
                     }
 
-                    // 处理Image节点，缓存image节点以提高后续查找效率
-                    if (node->type == Type::Image) {
-                        static std::map<std::u16string, Node*> img_map;
-                        auto it = img_map.find(node->path);
-                        if (it != img_map.end()) {
-                            node = it->second;
-                        } else {
-                            auto* image = new Node();
-                            auto* dir = dynamic_cast<Directory*>(node);
-                            dir->parse_image(image);
-                            node = image;
-                            img_map[node->path] = node;
-                        }
+                    // 处理Image节点，由File缓存image节点以提高后续查找效率
+                    if (node != nullptr && node->type == Type::Image) {
+                        auto* dir = dynamic_cast<Directory*>(node);
+                        node = dir->file->load_image(dir);
                     }
-                } else {
+                }
+
+                if (node == nullptr) {
                     // 如果子节点不存在，立即返回nullptr，表示未找到路径所指节点
                     throw std::runtime_error("Node not found");
                 }
@@ -558,4 +598,114 @@ namespace wz
     {
         return find_from_path(std::u16string{path.begin(), path.end()});
     }
-}
\ No newline at end of file
+
+    /**
+     * 批量解析路径。
+     *
+     * 先沿目录树走到每条路径所属的image，按image分组后以Directory::get_offset()升序解析，
+     * 使每个image只解析一次且对mmap的访问尽量顺序，最后按调用者给出的顺序返回结果。
+     *
+     * @param paths 要查找的路径列表，语法与find_from_path相同。
+     * @return 与paths一一对应的节点指针，未找到的路径对应nullptr。
+     */
+    std::vector<Node*> Node::resolve_many(const std::vector<wzstring>& paths)
+    {
+        std::vector<Node*> results(paths.size(), nullptr);
+
+        // 待解析的image及其下的剩余路径：(结果下标, 剩余路径)
+        std::map<Directory*, std::vector<std::pair<size_t, wzstring>>> pending;
+
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            const auto& path  = paths[i];
+            Node*       node  = this;
+            size_t      start = 0;
+
+            while (node != nullptr)
+            {
+                const auto end  = path.find(u'/', start);
+                const auto part = path.substr(start, end == wzstring::npos ? wzstring::npos : end - start);
+
+                node = part == u".." ? node->parent : node->get_child(part);
+                if (node != nullptr && node->type == Type::UOL)
+                {
+                    node = dynamic_cast<Property<WzUOL>*>(node)->get_uol();
+                }
+
+                if (node != nullptr && node->type == Type::Image)
+                {
+                    auto* dir = dynamic_cast<Directory*>(node);
+                    pending[dir].emplace_back(i, end == wzstring::npos ? wzstring {} : path.substr(end + 1));
+                    node = nullptr;
+                    break;
+                }
+
+                if (end == wzstring::npos)
+                    break;
+                start = end + 1;
+            }
+
+            results[i] = node;
+        }
+
+        // 按image在文件中的偏移排序，顺序读取mmap
+        std::vector<Directory*> images;
+        images.reserve(pending.size());
+        for (const auto& [dir, _] : pending)
+        {
+            images.push_back(dir);
+        }
+        std::sort(images.begin(), images.end(), [](const Directory* a, const Directory* b) {
+            return a->get_offset() < b->get_offset();
+        });
+
+        for (auto* dir : images)
+        {
+            auto* image = dir->file->load_image(dir);
+            if (image == nullptr)
+                continue;
+
+            for (const auto& [index, rest] : pending[dir])
+            {
+                results[index] = rest.empty() ? image : image->resolve_many({rest})[0];
+            }
+        }
+
+        return results;
+    }
+
+    /**
+     * 解析子树中所有UOL节点的链接。
+     *
+     * 每个UOL的目标只解析一次并缓存为节点指针，之后get_uol()与operator[]只需一次指针跳转。
+     *
+     * @return 目标不存在（Dangling）或存在循环引用（Cyclic）的UOL节点。
+     */
+    std::vector<Node*> Node::link_uols()
+    {
+        std::vector<Node*> broken;
+        std::vector<Node*> stack {this};
+
+        while (!stack.empty())
+        {
+            auto* node = stack.back();
+            stack.pop_back();
+
+            if (node->type == Type::UOL)
+            {
+                auto* uol = dynamic_cast<Property<WzUOL>*>(node);
+                if (uol->get_uol() == nullptr)
+                {
+                    broken.push_back(node);
+                }
+            }
+
+            for (const auto& [_, nodes] : node->children)
+            {
+                stack.insert(stack.end(), nodes.begin(), nodes.end());
+            }
+        }
+
+        return broken;
+    }
+}
@@ -0,0 +1,480 @@
+#include "Packed.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#include "Directory.hpp"
+#include "File.hpp"
+#include "Inflate.hpp"
+#include "Property.hpp"
+
+namespace wz
+{
+    const packed::Record &PackedNode::record() const { return file->records[node]; }
+
+    Type PackedNode::get_type() const { return static_cast<Type>(record().type); }
+
+    std::u16string_view PackedNode::get_name() const { return file->string(record().name); }
+
+    PackedNode PackedNode::get_parent() const
+    {
+        const auto parent = record().parent;
+        if (parent == packed::no_parent || parent >= file->node_count())
+            return {};
+        return {file, parent};
+    }
+
+    size_t PackedNode::children_count() const
+    {
+        const auto &r = record();
+        if (r.first_child >= file->node_count())
+            return 0;
+        return std::min<size_t>(r.child_count, file->node_count() - r.first_child);
+    }
+
+    PackedNode PackedNode::child_at(size_t i) const
+    {
+        if (i >= children_count())
+            return {};
+        return {file, static_cast<u32>(record().first_child + i)};
+    }
+
+    PackedNode PackedNode::get_child(std::u16string_view name) const
+    {
+        // 子节点按名称排序，与WzMap的顺序一致
+        size_t low  = 0;
+        size_t high = children_count();
+        while (low < high)
+        {
+            const auto mid = low + (high - low) / 2;
+            if (child_at(mid).get_name() < name)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        if (low < children_count())
+        {
+            auto child = child_at(low);
+            if (child.get_name() == name)
+                return child;
+        }
+        return {};
+    }
+
+    PackedNode PackedNode::find_from_path(std::u16string_view path) const
+    {
+        auto current = *this;
+        while (current && !path.empty())
+        {
+            const auto end     = path.find(u'/');
+            const auto segment = path.substr(0, end);
+            path               = end == std::u16string_view::npos ? std::u16string_view() : path.substr(end + 1);
+
+            if (segment.empty() || segment == u".")
+                continue;
+            current = segment == u".." ? current.get_parent() : current.get_child(segment);
+        }
+        return current;
+    }
+
+    i64 PackedNode::get_int() const
+    {
+        switch (get_type())
+        {
+            case Type::Int:
+            case Type::UnsignedShort:
+                return record().integer;
+            case Type::Float:
+            case Type::Double:
+                return static_cast<i64>(record().real);
+            default:
+                return 0;
+        }
+    }
+
+    f64 PackedNode::get_double() const
+    {
+        switch (get_type())
+        {
+            case Type::Int:
+            case Type::UnsignedShort:
+                return static_cast<f64>(record().integer);
+            case Type::Float:
+            case Type::Double:
+                return record().real;
+            default:
+                return 0;
+        }
+    }
+
+    std::u16string_view PackedNode::get_string() const
+    {
+        const auto type = get_type();
+        if (type != Type::String && type != Type::UOL)
+            return {};
+        return file->string(record().string);
+    }
+
+    WzVec2D PackedNode::get_vector() const
+    {
+        WzVec2D vector;
+        if (get_type() == Type::Vector2D)
+        {
+            vector.x = record().vector.x;
+            vector.y = record().vector.y;
+        }
+        return vector;
+    }
+
+    PackedNode PackedNode::resolve_uol() const
+    {
+        auto current = *this;
+
+        // 与Property<WzUOL>::get_uol一致：从UOL的父节点开始按路径查找，链上的UOL继续解析
+        for (int hops = 0; current && current.get_type() == Type::UOL; ++hops)
+        {
+            if (hops == 64)
+                return {};
+            current = current.get_parent().find_from_path(current.get_string());
+        }
+        return current;
+    }
+
+    WzCanvas PackedNode::get_canvas() const
+    {
+        WzCanvas canvas;
+        if (get_type() != Type::Canvas)
+            return canvas;
+
+        const auto &r            = record();
+        canvas.width             = r.canvas.width;
+        canvas.height            = r.canvas.height;
+        canvas.format            = r.canvas.format;
+        canvas.format2           = r.canvas.format2;
+        canvas.size              = static_cast<i32>(r.canvas.size);
+        canvas.uncompressed_size = static_cast<i32>(r.extra);
+        canvas.offset            = file->header->blob_offset + r.canvas.blob;
+        return canvas;
+    }
+
+    ByteView PackedNode::get_canvas_data() const
+    {
+        if (get_type() != Type::Canvas)
+            return {};
+        return file->blob(record().canvas.blob, record().canvas.size);
+    }
+
+    bool PackedNode::decode(u8 *dst, size_t dst_size, PixelFormat format) const
+    {
+        const auto canvas = get_canvas();
+        const auto data   = get_canvas_data();
+        if (data.empty() || canvas.uncompressed_size <= 0)
+            return false;
+
+        thread_local std::vector<u8> scratch;
+        scratch.resize(static_cast<size_t>(canvas.uncompressed_size));
+        if (!inflate::decompress(data.data, data.size, scratch.data(), scratch.size()))
+            return false;
+
+        return pixel::decode(canvas, scratch.data(), scratch.size(), dst, dst_size, format);
+    }
+
+    WzSound PackedNode::get_sound() const
+    {
+        WzSound sound;
+        if (get_type() != Type::Sound)
+            return sound;
+
+        const auto &r         = record();
+        sound.length          = r.sound.length;
+        sound.frequency       = r.sound.frequency;
+        sound.size            = static_cast<i32>(r.sound.size);
+        sound.offset          = file->header->blob_offset + r.sound.blob;
+        sound.codec           = static_cast<SoundCodec>(r.sound.codec);
+        sound.channels        = r.sound.channels;
+        sound.byte_rate       = r.extra;
+        sound.bits_per_sample = r.aux;
+        return sound;
+    }
+
+    ByteView PackedNode::get_sound_data() const
+    {
+        if (get_type() != Type::Sound)
+            return {};
+        return file->blob(record().sound.blob, record().sound.size);
+    }
+
+    PackedNode::Iterator PackedNode::begin() const
+    {
+        return {file, children_count() == 0 ? 0 : record().first_child};
+    }
+
+    PackedNode::Iterator PackedNode::end() const
+    {
+        return {file, static_cast<u32>(children_count() == 0 ? 0 : record().first_child + children_count())};
+    }
+
+    PackedFile::PackedFile(const char *path)
+    {
+        std::error_code error_code;
+        mmap = mio::make_mmap_source<decltype(path)>(path, error_code);
+    }
+
+    bool PackedFile::load()
+    {
+        if (!mmap.is_open() || mmap.size() < sizeof(packed::Header))
+            return false;
+
+        const auto *base = reinterpret_cast<const u8 *>(mmap.data());
+        const auto *h    = reinterpret_cast<const packed::Header *>(base);
+        if (h->magic != packed::magic || h->version != packed::version || h->node_count == 0)
+            return false;
+
+        const auto fits = [&](u64 offset, u64 size) { return offset <= mmap.size() && size <= mmap.size() - offset; };
+        if (!fits(h->blob_offset, h->blob_size) ||
+            !fits(h->node_offset, static_cast<u64>(h->node_count) * sizeof(packed::Record)) ||
+            !fits(h->string_offset, (static_cast<u64>(h->string_count) + 1) * sizeof(u32)) ||
+            !fits(h->string_data_offset, h->string_data_size) || h->node_offset % alignof(packed::Record) != 0 ||
+            h->string_offset % alignof(u32) != 0 || h->string_data_offset % alignof(char16_t) != 0)
+            return false;
+
+        header      = h;
+        blobs       = base + h->blob_offset;
+        records     = reinterpret_cast<const packed::Record *>(base + h->node_offset);
+        strings     = reinterpret_cast<const u32 *>(base + h->string_offset);
+        string_data = reinterpret_cast<const char16_t *>(base + h->string_data_offset);
+        return true;
+    }
+
+    PackedNode PackedFile::get_root() const
+    {
+        if (header == nullptr)
+            return {};
+        return {this, 0};
+    }
+
+    size_t PackedFile::node_count() const { return header == nullptr ? 0 : header->node_count; }
+
+    std::u16string_view PackedFile::string(u32 index) const
+    {
+        if (index >= header->string_count)
+            return {};
+
+        const auto begin = strings[index];
+        const auto end   = strings[index + 1];
+        if (begin > end || end > header->string_data_size / sizeof(char16_t))
+            return {};
+        return {string_data + begin, end - begin};
+    }
+
+    ByteView PackedFile::blob(u64 offset, u64 size) const
+    {
+        if (offset > header->blob_size || size > header->blob_size - offset)
+            return {};
+        return {blobs + offset, static_cast<size_t>(size)};
+    }
+
+    namespace
+    {
+        class PackWriter
+        {
+        public:
+            PackWriter(File &file, std::ofstream &out) : file(file), out(out) {}
+
+            bool write()
+            {
+                packed::Header header {};
+                out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+                header.blob_offset = sizeof(header);
+
+                // 广度优先，保证每个节点的子节点连续存放
+                records.push_back(make_record(file.get_root(), u"", packed::no_parent));
+                records.front().type = bit(Type::Directory);
+                sources.push_back(file.get_root());
+
+                for (size_t i = 0; i < records.size(); ++i)
+                {
+                    Node *container = sources[i];
+                    if (container->type == Type::Image)
+                    {
+                        container = file.load_image(dynamic_cast<Directory *>(container));
+                        if (container == nullptr)
+                        {
+                            failed = true;
+                            continue;
+                        }
+                    }
+
+                    const auto first = static_cast<u32>(records.size());
+                    for (auto &[name, children] : *container)
+                    {
+                        for (auto *child : children)
+                        {
+                            records.push_back(make_record(child, name, static_cast<u32>(i)));
+                            sources.push_back(child);
+                        }
+                    }
+                    records[i].first_child = first;
+                    records[i].child_count = static_cast<u32>(records.size()) - first;
+                }
+
+                header.magic        = packed::magic;
+                header.version      = packed::version;
+                header.node_count   = static_cast<u32>(records.size());
+                header.string_count = static_cast<u32>(strings.size());
+                header.blob_size    = blob_size;
+
+                pad(alignof(packed::Record));
+                header.node_offset = position();
+                out.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(packed::Record));
+
+                std::vector<u32> offsets;
+                offsets.reserve(strings.size() + 1);
+                u32 units = 0;
+                for (const auto *text : strings)
+                {
+                    offsets.push_back(units);
+                    units += static_cast<u32>(text->size());
+                }
+                offsets.push_back(units);
+
+                header.string_offset = position();
+                out.write(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(u32));
+
+                header.string_data_offset = position();
+                header.string_data_size   = static_cast<u64>(units) * sizeof(char16_t);
+                for (const auto *text : strings)
+                {
+                    out.write(reinterpret_cast<const char *>(text->data()), text->size() * sizeof(char16_t));
+                }
+
+                out.seekp(0);
+                out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+                out.flush();
+
+                return !failed && static_cast<bool>(out);
+            }
+
+        private:
+            File          &file;
+            std::ofstream &out;
+
+            std::vector<packed::Record>       records;
+            std::vector<Node *>               sources;
+            std::unordered_map<wzstring, u32> string_ids;
+            std::vector<const wzstring *>     strings;
+            u64                               blob_size = 0;
+            std::vector<u8>                   scratch;
+            bool                              failed = false;
+
+            u64 position() { return static_cast<u64>(out.tellp()); }
+
+            void pad(u64 alignment)
+            {
+                static const char zeros[packed::blob_align] = {};
+                const auto        rest                      = position() % alignment;
+                if (rest != 0)
+                    out.write(zeros, static_cast<std::streamsize>(alignment - rest));
+            }
+
+            u32 intern(const wzstring &text)
+            {
+                auto [it, inserted] = string_ids.try_emplace(text, static_cast<u32>(strings.size()));
+                if (inserted)
+                    strings.push_back(&it->first);
+                return it->second;
+            }
+
+            // 数据段紧跟文件头，返回相对数据段起点的偏移
+            u64 write_blob(const u8 *data, size_t size)
+            {
+                pad(packed::blob_align);
+                const auto offset = position() - sizeof(packed::Header);
+                out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+                blob_size = offset + size;
+                return offset;
+            }
+
+            packed::Record make_record(Node *node, const wzstring &name, u32 parent)
+            {
+                packed::Record record {};
+                record.name   = intern(name);
+                record.parent = parent;
+                record.type   = bit(node->type);
+
+                switch (node->type)
+                {
+                    case Type::Int:
+                        record.integer = dynamic_cast<Property<i32> *>(node)->get();
+                        break;
+                    case Type::UnsignedShort:
+                        record.integer = dynamic_cast<Property<u16> *>(node)->get();
+                        break;
+                    case Type::Float:
+                        record.real = dynamic_cast<Property<f32> *>(node)->get();
+                        break;
+                    case Type::Double:
+                        record.real = dynamic_cast<Property<f64> *>(node)->get();
+                        break;
+                    case Type::String:
+                        record.string = intern(dynamic_cast<Property<wzstring> *>(node)->get());
+                        break;
+                    case Type::UOL:
+                        record.string = intern(dynamic_cast<Property<WzUOL> *>(node)->get().uol);
+                        break;
+                    case Type::Vector2D: {
+                        const auto &vector = dynamic_cast<Property<WzVec2D> *>(node)->get();
+                        record.vector      = {vector.x, vector.y};
+                    }
+                    break;
+                    case Type::Canvas: {
+                        auto       *canvas = dynamic_cast<Property<WzCanvas> *>(node);
+                        const auto &info   = canvas->get();
+                        if (!canvas->read_compressed(scratch))
+                        {
+                            failed = true;
+                            scratch.clear();
+                        }
+                        record.canvas.width   = info.width;
+                        record.canvas.height  = info.height;
+                        record.canvas.format  = static_cast<u16>(info.format);
+                        record.canvas.format2 = static_cast<u8>(info.format2);
+                        record.canvas.size    = static_cast<u32>(scratch.size());
+                        record.canvas.blob    = write_blob(scratch.data(), scratch.size());
+                        record.extra          = static_cast<u32>(info.uncompressed_size);
+                    }
+                    break;
+                    case Type::Sound: {
+                        auto       *sound = dynamic_cast<Property<WzSound> *>(node);
+                        const auto &info  = sound->get();
+                        const auto  view  = sound->get_view();
+                        record.sound.length    = info.length;
+                        record.sound.frequency = info.frequency;
+                        record.sound.size      = static_cast<u32>(view.size);
+                        record.sound.codec     = static_cast<u16>(info.codec);
+                        record.sound.channels  = info.channels;
+                        record.sound.blob      = write_blob(view.data, view.size);
+                        record.extra           = info.byte_rate;
+                        record.aux             = info.bits_per_sample;
+                    }
+                    break;
+                    default:
+                        break;
+                }
+
+                return record;
+            }
+        };
+    }
+
+    bool write_packed(File &file, const char *path)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+        return PackWriter(file, out).write();
+    }
+}
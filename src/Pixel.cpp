@@ -0,0 +1,556 @@
+#include "Pixel.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define WZ_PIXEL_SSE2 1
+    #include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define WZ_PIXEL_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace wz::pixel
+{
+    namespace
+    {
+        inline void store(u8 *dst, u8 r, u8 g, u8 b, u8 a, PixelFormat format)
+        {
+            if (format == PixelFormat::RGBA8888)
+            {
+                dst[0] = r;
+                dst[2] = b;
+            }
+            else
+            {
+                dst[0] = b;
+                dst[2] = r;
+            }
+            dst[1] = g;
+            dst[3] = a;
+        }
+
+        inline void expand_565(u16 value, u8 &r, u8 &g, u8 &b)
+        {
+            const u8 r5 = value >> 11;
+            const u8 g6 = (value >> 5) & 0x3F;
+            const u8 b5 = value & 0x1F;
+            r           = static_cast<u8>((r5 << 3) | (r5 >> 2));
+            g           = static_cast<u8>((g6 << 2) | (g6 >> 4));
+            b           = static_cast<u8>((b5 << 3) | (b5 >> 2));
+        }
+
+        inline u16 load_u16(const u8 *src) { return static_cast<u16>(src[0] | (src[1] << 8)); }
+
+        // DXT3/DXT5共用的颜色块，总是4色模式
+        void decode_color_block(const u8 *block, u8 colors[4][3])
+        {
+            expand_565(load_u16(block), colors[0][0], colors[0][1], colors[0][2]);
+            expand_565(load_u16(block + 2), colors[1][0], colors[1][1], colors[1][2]);
+            for (int c = 0; c < 3; ++c)
+            {
+                colors[2][c] = static_cast<u8>((2 * colors[0][c] + colors[1][c]) / 3);
+                colors[3][c] = static_cast<u8>((colors[0][c] + 2 * colors[1][c]) / 3);
+            }
+        }
+
+        // 按4x4块遍历，alpha_of(block, i)返回块内第i个像素的alpha
+        template <typename AlphaFn>
+        void decode_dxt(const u8 *src, i32 width, i32 height, u8 *dst, PixelFormat format, AlphaFn alpha_of)
+        {
+            const i32 blocks_x = (width + 3) / 4;
+            const i32 blocks_y = (height + 3) / 4;
+
+            for (i32 by = 0; by < blocks_y; ++by)
+            {
+                for (i32 bx = 0; bx < blocks_x; ++bx)
+                {
+                    const u8 *block = src + (static_cast<size_t>(by) * blocks_x + bx) * 16;
+
+                    u8 colors[4][3];
+                    decode_color_block(block + 8, colors);
+                    const u32 indices = block[12] | (block[13] << 8) | (block[14] << 16) | (static_cast<u32>(block[15]) << 24);
+
+                    for (i32 i = 0; i < 16; ++i)
+                    {
+                        const i32 x = bx * 4 + (i & 3);
+                        const i32 y = by * 4 + (i >> 2);
+                        if (x >= width || y >= height)
+                            continue;
+
+                        const auto *color = colors[(indices >> (2 * i)) & 3];
+                        store(dst + (static_cast<size_t>(y) * width + x) * 4,
+                              color[0],
+                              color[1],
+                              color[2],
+                              alpha_of(block, i),
+                              format);
+                    }
+                }
+            }
+        }
+
+        size_t raw_size(const WzCanvas &canvas)
+        {
+            const auto pixels = static_cast<size_t>(canvas.width) * canvas.height;
+            switch (static_cast<CanvasFormat>(canvas.format + canvas.format2))
+            {
+                case CanvasFormat::BGRA4444:
+                case CanvasFormat::RGB565:
+                    return pixels * 2;
+                case CanvasFormat::BGRA8888:
+                    return pixels * 4;
+                case CanvasFormat::RGB565Block:
+                    return static_cast<size_t>(canvas.width / 16) * (canvas.height / 16) * 2;
+                case CanvasFormat::DXT3:
+                case CanvasFormat::DXT5:
+                    return static_cast<size_t>((canvas.width + 3) / 4) * ((canvas.height + 3) / 4) * 16;
+            }
+            return 0;
+        }
+
+#if defined(WZ_PIXEL_SSE2)
+        inline __m128i swap_rb(__m128i v)
+        {
+    #if defined(__SSSE3__)
+            return _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+    #else
+            const __m128i ga = _mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xFF00FF00)));
+            const __m128i rb = _mm_and_si128(v, _mm_set1_epi32(0x00FF00FF));
+            return _mm_or_si128(ga, _mm_or_si128(_mm_srli_epi32(rb, 16), _mm_slli_epi32(rb, 16)));
+    #endif
+        }
+
+        // 以下SIMD函数返回已处理的像素数，剩余部分交给标量实现
+        size_t sse2_bgra4444(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+        {
+            const __m128i mask = _mm_set1_epi8(0x0F);
+            size_t        i    = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+                __m128i       lo = _mm_and_si128(v, mask);
+                __m128i       hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+                lo               = _mm_or_si128(lo, _mm_slli_epi16(lo, 4));
+                hi               = _mm_or_si128(hi, _mm_slli_epi16(hi, 4));
+                __m128i o0       = _mm_unpacklo_epi8(lo, hi);
+                __m128i o1       = _mm_unpackhi_epi8(lo, hi);
+                if (format == PixelFormat::RGBA8888)
+                {
+                    o0 = swap_rb(o0);
+                    o1 = swap_rb(o1);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), o0);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 + 16), o1);
+            }
+            return i;
+        }
+
+        size_t sse2_bgra8888(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+        {
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4),
+                                 format == PixelFormat::RGBA8888 ? swap_rb(v) : v);
+            }
+            return i;
+        }
+
+        size_t sse2_rgb565(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+        {
+            const __m128i mask5 = _mm_set1_epi16(0x1F);
+            const __m128i mask6 = _mm_set1_epi16(0x3F);
+            const __m128i alpha = _mm_set1_epi16(static_cast<short>(0xFF00));
+            size_t        i     = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+                __m128i       b = _mm_and_si128(v, mask5);
+                __m128i       g = _mm_and_si128(_mm_srli_epi16(v, 5), mask6);
+                __m128i       r = _mm_srli_epi16(v, 11);
+                b               = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+                g               = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+                r               = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+
+                const bool    rgba = format == PixelFormat::RGBA8888;
+                const __m128i low  = _mm_or_si128(rgba ? r : b, _mm_slli_epi16(g, 8));
+                const __m128i high = _mm_or_si128(rgba ? b : r, alpha);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_unpacklo_epi16(low, high));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 + 16), _mm_unpackhi_epi16(low, high));
+            }
+            return i;
+        }
+#endif
+
+#if defined(__AVX2__)
+        inline __m256i swap_rb(__m256i v)
+        {
+            const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                                     2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+            return _mm256_shuffle_epi8(v, shuffle);
+        }
+
+        // unpack指令在128位通道内进行，需要重新拼接两个通道恢复像素顺序
+        inline void store_lanes(u8 *dst, __m256i a, __m256i b, PixelFormat format)
+        {
+            __m256i o0 = _mm256_permute2x128_si256(a, b, 0x20);
+            __m256i o1 = _mm256_permute2x128_si256(a, b, 0x31);
+            if (format == PixelFormat::RGBA8888)
+            {
+                o0 = swap_rb(o0);
+                o1 = swap_rb(o1);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), o0);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 32), o1);
+        }
+
+        size_t avx2_bgra4444(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+        {
+            const __m256i mask = _mm256_set1_epi8(0x0F);
+            size_t        i    = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                const __m256i v  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 2));
+                __m256i       lo = _mm256_and_si256(v, mask);
+                __m256i       hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask);
+                lo               = _mm256_or_si256(lo, _mm256_slli_epi16(lo, 4));
+                hi               = _mm256_or_si256(hi, _mm256_slli_epi16(hi, 4));
+                store_lanes(dst + i * 4, _mm256_unpacklo_epi8(lo, hi), _mm256_unpackhi_epi8(lo, hi), format);
+            }
+            return i + sse2_bgra4444(src + i * 2, dst + i * 4, count - i, format);
+        }
+
+        size_t avx2_bgra8888(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+        {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4),
+                                    format == PixelFormat::RGBA8888 ? swap_rb(v) : v);
+            }
+            return i + sse2_bgra8888(src + i * 4, dst + i * 4, count - i, format);
+        }
+
+        size_t avx2_rgb565(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+        {
+            const __m256i mask5 = _mm256_set1_epi16(0x1F);
+            const __m256i mask6 = _mm256_set1_epi16(0x3F);
+            const __m256i alpha = _mm256_set1_epi16(static_cast<short>(0xFF00));
+            size_t        i     = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 2));
+                __m256i       b = _mm256_and_si256(v, mask5);
+                __m256i       g = _mm256_and_si256(_mm256_srli_epi16(v, 5), mask6);
+                __m256i       r = _mm256_srli_epi16(v, 11);
+                b               = _mm256_or_si256(_mm256_slli_epi16(b, 3), _mm256_srli_epi16(b, 2));
+                g               = _mm256_or_si256(_mm256_slli_epi16(g, 2), _mm256_srli_epi16(g, 4));
+                r               = _mm256_or_si256(_mm256_slli_epi16(r, 3), _mm256_srli_epi16(r, 2));
+
+                // 通道交换已在这里完成，store_lanes只需按BGRA顺序写出
+                const bool    rgba = format == PixelFormat::RGBA8888;
+                const __m256i low  = _mm256_or_si256(rgba ? r : b, _mm256_slli_epi16(g, 8));
+                const __m256i high = _mm256_or_si256(rgba ? b : r, alpha);
+                store_lanes(dst + i * 4,
+                            _mm256_unpacklo_epi16(low, high),
+                            _mm256_unpackhi_epi16(low, high),
+                            PixelFormat::BGRA8888);
+            }
+            return i + sse2_rgb565(src + i * 2, dst + i * 4, count - i, format);
+        }
+#endif
+
+#if defined(WZ_PIXEL_NEON)
+        size_t neon_bgra4444(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+        {
+            const uint8x16_t mask = vdupq_n_u8(0x0F);
+            size_t           i    = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                // val[0] = G<<4|B, val[1] = A<<4|R
+                const uint8x16x2_t v = vld2q_u8(src + i * 2);
+                uint8x16_t         b = vandq_u8(v.val[0], mask);
+                uint8x16_t         g = vshrq_n_u8(v.val[0], 4);
+                uint8x16_t         r = vandq_u8(v.val[1], mask);
+                uint8x16_t         a = vshrq_n_u8(v.val[1], 4);
+
+                uint8x16x4_t out;
+                const bool   rgba = format == PixelFormat::RGBA8888;
+                out.val[0]        = vorrq_u8(rgba ? r : b, vshlq_n_u8(rgba ? r : b, 4));
+                out.val[1]        = vorrq_u8(g, vshlq_n_u8(g, 4));
+                out.val[2]        = vorrq_u8(rgba ? b : r, vshlq_n_u8(rgba ? b : r, 4));
+                out.val[3]        = vorrq_u8(a, vshlq_n_u8(a, 4));
+                vst4q_u8(dst + i * 4, out);
+            }
+            return i;
+        }
+
+        size_t neon_bgra8888(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+        {
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                uint8x16x4_t v = vld4q_u8(src + i * 4);
+                if (format == PixelFormat::RGBA8888)
+                {
+                    std::swap(v.val[0], v.val[2]);
+                }
+                vst4q_u8(dst + i * 4, v);
+            }
+            return i;
+        }
+
+        size_t neon_rgb565(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+        {
+            const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+            const uint16x8_t mask6 = vdupq_n_u16(0x3F);
+            size_t           i     = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const uint16x8_t v = vreinterpretq_u16_u8(vld1q_u8(src + i * 2));
+                uint16x8_t       b = vandq_u16(v, mask5);
+                uint16x8_t       g = vandq_u16(vshrq_n_u16(v, 5), mask6);
+                uint16x8_t       r = vshrq_n_u16(v, 11);
+                b                  = vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2));
+                g                  = vorrq_u16(vshlq_n_u16(g, 2), vshrq_n_u16(g, 4));
+                r                  = vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2));
+
+                uint8x8x4_t out;
+                const bool  rgba = format == PixelFormat::RGBA8888;
+                out.val[0]       = vmovn_u16(rgba ? r : b);
+                out.val[1]       = vmovn_u16(g);
+                out.val[2]       = vmovn_u16(rgba ? b : r);
+                out.val[3]       = vdup_n_u8(0xFF);
+                vst4_u8(dst + i * 4, out);
+            }
+            return i;
+        }
+#endif
+    }
+
+    namespace scalar
+    {
+        void convert_bgra4444(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                const u8 lo = src[i * 2];
+                const u8 hi = src[i * 2 + 1];
+                store(dst + i * 4,
+                      static_cast<u8>((hi & 0x0F) * 0x11),
+                      static_cast<u8>((lo >> 4) * 0x11),
+                      static_cast<u8>((lo & 0x0F) * 0x11),
+                      static_cast<u8>((hi >> 4) * 0x11),
+                      format);
+            }
+        }
+
+        void convert_bgra8888(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+        {
+            if (format == PixelFormat::BGRA8888)
+            {
+                std::memmove(dst, src, count * 4);
+                return;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                const u8 *p = src + i * 4;
+                store(dst + i * 4, p[2], p[1], p[0], p[3], format);
+            }
+        }
+
+        void convert_rgb565(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                u8 r, g, b;
+                expand_565(load_u16(src + i * 2), r, g, b);
+                store(dst + i * 4, r, g, b, 0xFF, format);
+            }
+        }
+
+        void decode_dxt3(const u8 *src, i32 width, i32 height, u8 *dst, PixelFormat format)
+        {
+            // 显式alpha，每像素4位
+            decode_dxt(src, width, height, dst, format, [](const u8 *block, i32 i) {
+                return static_cast<u8>(((block[i / 2] >> (4 * (i & 1))) & 0x0F) * 0x11);
+            });
+        }
+
+        void decode_dxt5(const u8 *src, i32 width, i32 height, u8 *dst, PixelFormat format)
+        {
+            // 插值alpha，两个端点加48位3bit索引
+            decode_dxt(src, width, height, dst, format, [](const u8 *block, i32 i) {
+                const u32 a0 = block[0];
+                const u32 a1 = block[1];
+                u64       bits = 0;
+                for (int n = 0; n < 6; ++n)
+                {
+                    bits |= static_cast<u64>(block[2 + n]) << (8 * n);
+                }
+
+                const u32 index = (bits >> (3 * i)) & 7;
+                switch (index)
+                {
+                    case 0:
+                        return static_cast<u8>(a0);
+                    case 1:
+                        return static_cast<u8>(a1);
+                    default:
+                        break;
+                }
+                if (a0 > a1)
+                {
+                    return static_cast<u8>(((8 - index) * a0 + (index - 1) * a1) / 7);
+                }
+                if (index == 6)
+                    return static_cast<u8>(0);
+                if (index == 7)
+                    return static_cast<u8>(0xFF);
+                return static_cast<u8>(((6 - index) * a0 + (index - 1) * a1) / 5);
+            });
+        }
+    }
+
+    void convert_bgra4444(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+    {
+        size_t done = 0;
+#if defined(__AVX2__)
+        done = avx2_bgra4444(src, dst, count, format);
+#elif defined(WZ_PIXEL_SSE2)
+        done = sse2_bgra4444(src, dst, count, format);
+#elif defined(WZ_PIXEL_NEON)
+        done = neon_bgra4444(src, dst, count, format);
+#endif
+        scalar::convert_bgra4444(src + done * 2, dst + done * 4, count - done, format);
+    }
+
+    void convert_bgra8888(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+    {
+        if (format == PixelFormat::BGRA8888)
+        {
+            std::memmove(dst, src, count * 4);
+            return;
+        }
+        size_t done = 0;
+#if defined(__AVX2__)
+        done = avx2_bgra8888(src, dst, count, format);
+#elif defined(WZ_PIXEL_SSE2)
+        done = sse2_bgra8888(src, dst, count, format);
+#elif defined(WZ_PIXEL_NEON)
+        done = neon_bgra8888(src, dst, count, format);
+#endif
+        scalar::convert_bgra8888(src + done * 4, dst + done * 4, count - done, format);
+    }
+
+    void convert_rgb565(const u8 *src, u8 *dst, size_t count, PixelFormat format)
+    {
+        size_t done = 0;
+#if defined(__AVX2__)
+        done = avx2_rgb565(src, dst, count, format);
+#elif defined(WZ_PIXEL_SSE2)
+        done = sse2_rgb565(src, dst, count, format);
+#elif defined(WZ_PIXEL_NEON)
+        done = neon_rgb565(src, dst, count, format);
+#endif
+        scalar::convert_rgb565(src + done * 2, dst + done * 4, count - done, format);
+    }
+
+    CompressedTexture compressed_layout(const WzCanvas &canvas)
+    {
+        CompressedTexture texture;
+        switch (static_cast<CanvasFormat>(canvas.format + canvas.format2))
+        {
+            case CanvasFormat::DXT3:
+                texture.format = CompressedFormat::BC2;
+                break;
+            case CanvasFormat::DXT5:
+                texture.format = CompressedFormat::BC3;
+                break;
+            default:
+                return texture;
+        }
+
+        texture.width     = canvas.width;
+        texture.height    = canvas.height;
+        texture.blocks_x  = static_cast<u32>((canvas.width + 3) / 4);
+        texture.blocks_y  = static_cast<u32>((canvas.height + 3) / 4);
+        texture.row_pitch = static_cast<size_t>(texture.blocks_x) * texture.block_size;
+        return texture;
+    }
+
+    size_t decoded_size(const WzCanvas &canvas)
+    {
+        return static_cast<size_t>(canvas.width) * canvas.height * 4;
+    }
+
+    bool decode(const WzCanvas &canvas, const u8 *src, size_t src_size, u8 *dst, size_t dst_size, PixelFormat format)
+    {
+        const auto expected = raw_size(canvas);
+        if (expected == 0 || src_size < expected || dst_size < decoded_size(canvas))
+            return false;
+
+        const auto width  = static_cast<size_t>(canvas.width);
+        const auto height = static_cast<size_t>(canvas.height);
+
+        switch (static_cast<CanvasFormat>(canvas.format + canvas.format2))
+        {
+            case CanvasFormat::BGRA4444:
+                convert_bgra4444(src, dst, width * height, format);
+                return true;
+            case CanvasFormat::BGRA8888:
+                convert_bgra8888(src, dst, width * height, format);
+                return true;
+            case CanvasFormat::RGB565:
+                convert_rgb565(src, dst, width * height, format);
+                return true;
+            case CanvasFormat::RGB565Block: {
+                // 宽高不是16的倍数时，边缘不被任何块覆盖的像素保持透明
+                if (width % 16 != 0 || height % 16 != 0)
+                {
+                    std::memset(dst, 0, decoded_size(canvas));
+                }
+
+                const size_t blocks_x = width / 16;
+                const size_t row      = width * 4;
+                for (size_t by = 0; by < height / 16; ++by)
+                {
+                    u8 *line = dst + by * 16 * row;
+
+                    // 先把一行块颜色转换到栈上，再横向展开为16像素
+                    u8 colors[64 * 4];
+                    for (size_t bx = 0; bx < blocks_x; bx += 64)
+                    {
+                        const size_t n = std::min<size_t>(64, blocks_x - bx);
+                        convert_rgb565(src + (by * blocks_x + bx) * 2, colors, n, format);
+                        for (size_t k = 0; k < n; ++k)
+                        {
+                            for (size_t x = 0; x < 16; ++x)
+                            {
+                                std::memcpy(line + ((bx + k) * 16 + x) * 4, colors + k * 4, 4);
+                            }
+                        }
+                    }
+
+                    for (size_t y = 1; y < 16; ++y)
+                    {
+                        std::memcpy(line + y * row, line, blocks_x * 16 * 4);
+                    }
+                }
+                return true;
+            }
+            case CanvasFormat::DXT3:
+                scalar::decode_dxt3(src, canvas.width, canvas.height, dst, format);
+                return true;
+            case CanvasFormat::DXT5:
+                scalar::decode_dxt5(src, canvas.width, canvas.height, dst, format);
+                return true;
+        }
+
+        return false;
+    }
+}
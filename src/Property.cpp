@@ -1,75 +1,506 @@
 #include "Property.hpp"
+#include "File.hpp"
 #include "Types.hpp"
 
-#include <zlib.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "Hash.hpp"
+#include "Inflate.hpp"
+#include "Trace.hpp"
+
+namespace
+{
+    // 画布压缩数据的输入源：未加密时一次给出mmap中的整段数据，
+    // 加密时按块异或解密到内部的小缓冲区后分段给出，不构造完整的解密数据
+    class CanvasInput
+    {
+    public:
+        CanvasInput(const u8* src, size_t size, bool encrypted, wz::MutableKey& key) :
+            src(src), src_size(size), encrypted(encrypted), key(key)
+        {
+        }
+
+        bool next(const u8*& data, size_t& size)
+        {
+            if (!encrypted)
+            {
+                if (position >= src_size)
+                    return false;
+                data     = src;
+                size     = src_size;
+                position = src_size;
+                return true;
+            }
+
+            while (position == block_end)
+            {
+                if (position + sizeof(i32) > src_size)
+                    return false;
+
+                i32 block_size;
+                std::memcpy(&block_size, src + position, sizeof(i32));
+                position += sizeof(i32);
+                if (block_size < 0 || position + block_size > src_size)
+                {
+                    error = true;
+                    return false;
+                }
+                block_start = position;
+                block_end   = position + block_size;
+            }
+
+            const auto chunk = std::min(sizeof(buffer), block_end - position);
+            for (size_t i = 0; i < chunk; ++i)
+            {
+                buffer[i] = static_cast<u8>(src[position + i] ^ key[position - block_start + i]);
+            }
+            position += chunk;
+            data = buffer;
+            size = chunk;
+            return true;
+        }
+
+        [[nodiscard]] bool failed() const { return error; }
+
+    private:
+        const u8*       src;
+        size_t          src_size;
+        bool            encrypted;
+        wz::MutableKey& key;
+        size_t          position    = 0;
+        size_t          block_start = 0;
+        size_t          block_end   = 0;
+        bool            error       = false;
+        u8              buffer[4096];
+    };
+
+    // 一次画布解压的字节数与耗时，析构时计入所属File的计数器
+    class InflateRecord
+    {
+    public:
+        InflateRecord(wz::File* file, size_t compressed) :
+            file(file), compressed(compressed), start(std::chrono::steady_clock::now())
+        {
+        }
+
+        ~InflateRecord()
+        {
+            if (file == nullptr)
+                return;
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            auto&      counters = file->get_counters();
+            counters.add(wz::Counter::CanvasesInflated);
+            counters.add(wz::Counter::CanvasCompressedBytes, compressed);
+            counters.add(wz::Counter::CanvasBytesInflated, inflated);
+            counters.add(wz::Counter::InflateNs,
+                         static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+
+        InflateRecord(const InflateRecord&)            = delete;
+        InflateRecord& operator=(const InflateRecord&) = delete;
+
+        size_t inflated = 0; // 成功解压的字节数
+
+    private:
+        wz::File*                             file;
+        size_t                                compressed;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+// 压缩数据直接从mmap送入解压器；加密画布逐块解密后流式送入
+template<>
+bool wz::Property<wz::WzCanvas>::read_raw_data(u8* dst, size_t dst_size)
+{
+    const WzCanvas& canvas = get();
+    if (canvas.size <= 0 || canvas.uncompressed_size <= 0 || dst_size < static_cast<size_t>(canvas.uncompressed_size))
+        return false;
+
+    const u8*  src      = reader->data(canvas.offset);
+    const auto src_size = static_cast<size_t>(canvas.size);
+    const auto out_size = static_cast<size_t>(canvas.uncompressed_size);
+
+    trace::LibraryScope span("inflate_canvas");
+    if (span.active())
+    {
+        span.set_path(path);
+        span.set_bytes(src_size, out_size);
+    }
+
+    InflateRecord record(file, src_size);
+    if (!canvas.is_encrypted)
+    {
+        const bool inflated = inflate::decompress(src, src_size, dst, out_size);
+        record.inflated     = inflated ? out_size : 0;
+        return inflated;
+    }
+
+    CanvasInput     input(src, src_size, true, get_key());
+    inflate::Stream stream(dst, out_size);
+
+    const u8* data;
+    size_t    size;
+    while (input.next(data, size))
+    {
+        if (!stream.write(data, size))
+            return false;
+    }
+
+    const bool inflated = !input.failed() && stream.finish();
+    record.inflated     = inflated ? out_size : 0;
+    return inflated;
+}
+
+// 加密画布逐块解密后拼接，得到与未加密画布相同的zlib流
+template<>
+bool wz::Property<wz::WzCanvas>::read_compressed(std::vector<u8>& out)
+{
+    const WzCanvas& canvas = get();
+    out.clear();
+    if (canvas.size <= 0)
+        return false;
+
+    const u8* src = reader->data(canvas.offset);
+    if (!canvas.is_encrypted)
+    {
+        out.assign(src, src + canvas.size);
+        return true;
+    }
+
+    out.reserve(canvas.size);
+    CanvasInput input(src, static_cast<size_t>(canvas.size), true, get_key());
+    const u8*   data;
+    size_t      size;
+    while (input.next(data, size))
+    {
+        out.insert(out.end(), data, data + size);
+    }
+    return !input.failed();
+}
+
 // get ARGB4444 piexl,ARGB8888 piexl and others.....
 template<>
 std::vector<u8> wz::Property<wz::WzCanvas>::get_raw_data()
 {
-    WzCanvas canvas = get();
+    std::vector<u8> pixel_stream(get().uncompressed_size);
+    if (!read_raw_data(pixel_stream.data(), pixel_stream.size()))
+    {
+        return {};
+    }
+    return pixel_stream;
+}
+
+// 解压后转换为RGBA8888/BGRA8888
+template<>
+bool wz::Property<wz::WzCanvas>::decode(u8* dst, size_t dst_size, PixelFormat format)
+{
+    const WzCanvas& canvas = get();
 
-    std::vector<u8> data_stream;
-    reader->set_position(canvas.offset);
-    size_t        end_offset       = reader->get_position() + canvas.size;
-    unsigned long uncompressed_len = canvas.uncompressed_size;
-    u8*           uncompressed     = new u8[uncompressed_len];
-    if (!canvas.is_encrypted)
+    trace::LibraryScope span("decode_canvas");
+    if (span.active())
     {
-        for (size_t i = 0; i < canvas.size; ++i)
-        {
-            data_stream.push_back(reader->read_byte());
-        }
-        uncompress(uncompressed, (unsigned long*)&uncompressed_len, data_stream.data(), data_stream.size());
+        span.set_path(path);
+        span.set_bytes(static_cast<u64>(std::max(canvas.size, 0)), pixel::decoded_size(canvas));
     }
-    else
+
+    // BGRA8888输出与原始数据格式相同，直接解压到目标缓冲区
+    if (format == PixelFormat::BGRA8888 && canvas.format + canvas.format2 == static_cast<i32>(CanvasFormat::BGRA8888))
     {
-        auto wz_key = get_key();
+        return dst_size >= pixel::decoded_size(canvas) && read_raw_data(dst, dst_size);
+    }
+
+    // 其余格式先解压到线程内复用的缓冲区
+    thread_local std::vector<u8> raw;
+    raw.resize(std::max(canvas.uncompressed_size, 0));
+    if (!read_raw_data(raw.data(), raw.size()))
+        return false;
+    return pixel::decode(canvas, raw.data(), raw.size(), dst, dst_size, format);
+}
+
+// 按解压单元(1行，517格式16行，DXT格式4行)逐步解压，裁剪区域以下的数据不再解压
+template<>
+bool wz::Property<wz::WzCanvas>::decode_rows(const RowCallback& callback, PixelFormat format, const CanvasRect* clip)
+{
+    const WzCanvas& canvas = get();
+    if (canvas.size <= 0 || canvas.uncompressed_size <= 0)
+        return false;
+
+    const i32 width  = canvas.width;
+    const i32 height = canvas.height;
+
+    const CanvasRect rect = clip ? *clip : CanvasRect {0, 0, width, height};
+    const i32        x0   = std::max(rect.x, 0);
+    const i32        y0   = std::max(rect.y, 0);
+    const i32        x1   = std::min(rect.x + rect.width, width);
+    const i32        y1   = std::min(rect.y + rect.height, height);
+    if (x1 <= x0 || y1 <= y0)
+        return true;
 
-        while (reader->get_position() < end_offset)
+    const auto kind = static_cast<CanvasFormat>(canvas.format + canvas.format2);
+
+    // 每个解压单元包含的行数、压缩前字节数，以及数据中实际存在的单元数
+    i32    unit_rows;
+    size_t unit_bytes;
+    i32    units;
+    switch (kind)
+    {
+        case CanvasFormat::BGRA4444:
+        case CanvasFormat::RGB565:
+            unit_rows  = 1;
+            unit_bytes = static_cast<size_t>(width) * 2;
+            units      = height;
+            break;
+        case CanvasFormat::BGRA8888:
+            unit_rows  = 1;
+            unit_bytes = static_cast<size_t>(width) * 4;
+            units      = height;
+            break;
+        case CanvasFormat::RGB565Block:
+            unit_rows  = 16;
+            unit_bytes = static_cast<size_t>(width / 16) * 2;
+            units      = height / 16;
+            break;
+        case CanvasFormat::DXT3:
+        case CanvasFormat::DXT5:
+            unit_rows  = 4;
+            unit_bytes = static_cast<size_t>((width + 3) / 4) * 16;
+            units      = (height + 3) / 4;
+            break;
+        default:
+            return false;
+    }
+
+    trace::LibraryScope span("decode_canvas_rows");
+    if (span.active())
+    {
+        span.set_path(path);
+        span.set_bytes(static_cast<u64>(canvas.size), static_cast<u64>(y1 - y0) * static_cast<u64>(x1 - x0) * 4);
+    }
+
+    // 逐单元解压时耗时包括像素转换与回调
+    InflateRecord record(file, static_cast<size_t>(canvas.size));
+    CanvasInput   input(reader->data(canvas.offset), canvas.size, canvas.is_encrypted, get_key());
+    inflate::Pull pull([&](const u8*& data, size_t& size) { return input.next(data, size); },
+                       canvas.uncompressed_size);
+
+    const bool      per_row = unit_rows == 1;
+    std::vector<u8> raw(unit_bytes);
+    std::vector<u8> rows(per_row ? static_cast<size_t>(x1 - x0) * 4 : static_cast<size_t>(width) * unit_rows * 4);
+
+    for (i32 y = 0, unit = 0; y < y1; y += unit_rows, ++unit)
+    {
+        if (unit < units)
+        {
+            if (!pull.read(raw.data(), raw.size()))
+                return false;
+            record.inflated += raw.size();
+        }
+
+        // 裁剪区域之上的单元只解压不转换
+        if (y + unit_rows <= y0)
+            continue;
+
+        if (per_row)
+        {
+            switch (kind)
+            {
+                case CanvasFormat::BGRA4444:
+                    pixel::convert_bgra4444(raw.data() + x0 * 2, rows.data(), x1 - x0, format);
+                    break;
+                case CanvasFormat::RGB565:
+                    pixel::convert_rgb565(raw.data() + x0 * 2, rows.data(), x1 - x0, format);
+                    break;
+                default:
+                    pixel::convert_bgra8888(raw.data() + x0 * 4, rows.data(), x1 - x0, format);
+                    break;
+            }
+            callback(y, rows.data());
+            continue;
+        }
+
+        if (unit < units)
+        {
+            WzCanvas block_row = canvas;
+            block_row.height   = unit_rows;
+            if (!pixel::decode(block_row, raw.data(), raw.size(), rows.data(), rows.size(), format))
+                return false;
+        }
+        else
+        {
+            // 517格式高度不是16的倍数时，最后不足16行的部分没有数据，保持透明
+            std::fill(rows.begin(), rows.end(), 0);
+        }
+
+        for (i32 r = 0; r < unit_rows; ++r)
         {
-            auto block_size = reader->read<i32>();
-            for (size_t i = 0; i < block_size; ++i)
+            if (y + r >= y0 && y + r < y1)
             {
-                auto n = wz_key[i];
-                data_stream.push_back(static_cast<u8>(reader->read_byte() ^ n));
+                callback(y + r, rows.data() + (static_cast<size_t>(r) * width + x0) * 4);
             }
         }
-        uncompress(uncompressed, (unsigned long*)&uncompressed_len, data_stream.data(), data_stream.size());
     }
 
-    std::vector<u8> pixel_stream(uncompressed, uncompressed + uncompressed_len);
-    delete[] uncompressed;
-    return pixel_stream;
+    return !input.failed();
 }
 
-// get Sound node raw data
 template<>
-std::vector<u8> wz::Property<wz::WzSound>::get_raw_data()
+bool wz::Property<wz::WzCanvas>::decode_region(u8* dst, size_t stride, const CanvasRect& clip, PixelFormat format)
+{
+    const auto x0    = std::max(clip.x, 0);
+    const auto width = std::min(clip.x + clip.width, get().width) - x0;
+    if (width <= 0)
+        return true;
+
+    return decode_rows(
+        [&](i32 y, const u8* row) {
+            std::memcpy(dst + static_cast<size_t>(y - clip.y) * stride + static_cast<size_t>(x0 - clip.x) * 4,
+                        row,
+                        static_cast<size_t>(width) * 4);
+        },
+        format,
+        &clip);
+}
+
+// DXT3/DXT5的原始数据就是BC2/BC3块，解压后原样交给调用者
+template<>
+bool wz::Property<wz::WzCanvas>::get_compressed(CompressedTexture& texture)
+{
+    texture = pixel::compressed_layout(get());
+    if (texture.format == CompressedFormat::None)
+        return false;
+
+    texture.blocks.resize(texture.row_pitch * texture.blocks_y);
+    if (texture.blocks.size() != static_cast<size_t>(get().uncompressed_size) ||
+        !read_raw_data(texture.blocks.data(), texture.blocks.size()))
+    {
+        texture.blocks.clear();
+        return false;
+    }
+    return true;
+}
+
+// 直接对mmap中的压缩数据求哈希，加密画布对同一密钥流得到的密文相同，无需解密
+template<>
+u64 wz::Property<wz::WzCanvas>::content_hash() const
+{
+    const auto& canvas = get();
+    return hash::xxh64(reader->data(canvas.offset), canvas.size);
+}
+
+// 先查找所属File的纹理缓存，未命中时解码并放入缓存
+template<>
+wz::TextureCache::Pixels wz::Property<wz::WzCanvas>::get_pixels(PixelFormat format)
 {
-    WzSound         sound = get();
-    std::vector<u8> data_stream;
+    auto&       cache  = file->get_texture_cache();
+    const auto& canvas = get();
 
-    reader->set_position(sound.offset);
-    size_t end_offset = reader->get_position() + sound.size;
+    if (auto pixels = cache.find(canvas.offset, format))
+    {
+        return pixels;
+    }
+
+    const auto dedup = cache.deduplicate();
+    const auto content = dedup ? TextureCache::Content::of(canvas, content_hash()) : TextureCache::Content {};
+    if (dedup)
+    {
+        if (auto pixels = cache.find_duplicate(canvas.offset, format, content))
+        {
+            return pixels;
+        }
+    }
 
-    while (reader->get_position() < end_offset)
+    std::vector<u8> pixels(pixel::decoded_size(canvas));
+    if (!decode(pixels.data(), pixels.size(), format))
+    {
+        return nullptr;
+    }
+    if (dedup)
     {
-        data_stream.push_back(static_cast<u8>(reader->read_byte()));
+        return cache.insert(canvas.offset, format, std::move(pixels), content);
     }
-    return data_stream;
+    return cache.insert(canvas.offset, format, std::move(pixels));
+}
+
+template<>
+wz::ByteView wz::Property<wz::WzSound>::get_view() const
+{
+    return {reader->data(data.offset), static_cast<size_t>(data.size)};
+}
+
+template<>
+wz::ByteView wz::Property<wz::WzSound>::get_header() const
+{
+    return {reader->data(data.header_offset), data.header_size};
+}
+
+// get Sound node raw data
+template<>
+std::vector<u8> wz::Property<wz::WzSound>::get_raw_data()
+{
+    const auto view = get_view();
+    return {view.begin(), view.end()};
 }
 
 // get uol By uol node
+// 目标只解析一次并缓存，链上再次遇到正在解析的UOL即视为循环引用
 template<>
 wz::Node* wz::Property<wz::WzUOL>::get_uol()
 {
-    auto path     = get().uol;
-    auto uol_node = parent->find_from_path(path);
-    while (uol_node->type == wz::Type::UOL)
+    switch (data.state)
+    {
+        case UolState::Resolved:
+            return data.target;
+        case UolState::Dangling:
+        case UolState::Cyclic:
+            return nullptr;
+        case UolState::Resolving:
+            data.state = UolState::Cyclic;
+            return nullptr;
+        case UolState::Unresolved:
+            break;
+    }
+
+    data.state = UolState::Resolving;
+
+    // 沿路径逐级查找，途经的UOL会递归解析
+    Node*       node  = parent;
+    const auto& path  = data.uol;
+    size_t      start = 0;
+    while (node != nullptr)
+    {
+        const auto end  = path.find(u'/', start);
+        const auto part = path.substr(start, end == wzstring::npos ? wzstring::npos : end - start);
+
+        node = part == u".." ? node->parent : node->get_child(part);
+        if (node != nullptr && node->type == wz::Type::UOL)
+        {
+            auto* link = dynamic_cast<wz::Property<wz::WzUOL>*>(node);
+            node       = link->get_uol();
+            if (node == nullptr && link->data.state == UolState::Cyclic)
+            {
+                data.state = UolState::Cyclic;
+            }
+        }
+
+        if (end == wzstring::npos)
+            break;
+        start = end + 1;
+    }
+
+    if (data.state == UolState::Cyclic)
+    {
+        return nullptr;
+    }
+
+    if (node == nullptr)
     {
-        path     = dynamic_cast<wz::Property<wz::WzUOL>*>(uol_node)->get().uol;
-        uol_node = uol_node->parent->find_from_path(path);
+        data.state = UolState::Dangling;
+        return nullptr;
     }
 
-    return uol_node;
+    data.target = node;
+    data.state  = UolState::Resolved;
+    return node;
 }
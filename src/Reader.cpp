@@ -6,13 +6,13 @@
 
 namespace wz
 {
-    Reader::Reader(MutableKey& new_key, const char* file_path) : key(new_key), cursor(0)
+    Reader::Reader(MutableKey& new_key, const char* file_path) : key(new_key), cursor(0), path(file_path)
     {
         std::error_code error_code;
-        mmap = mio::make_mmap_source<decltype(file_path)>(file_path, error_code);
+        mmap = std::make_shared<const mio::mmap_source>(mio::make_mmap_source<decltype(file_path)>(file_path, error_code));
     }
 
-    u8 Reader::read_byte() { return mmap[cursor++]; }
+    u8 Reader::read_byte() { return static_cast<u8>((*mmap)[cursor++]); }
 
     [[maybe_unused]] std::vector<u8> Reader::read_bytes(const size_t& len)
     {
@@ -94,6 +94,12 @@ namespace wz
                 return {};
             }
 
+            if (counters != nullptr)
+            {
+                counters->add(Counter::StringsDecrypted);
+                counters->add(Counter::StringBytes, 2 * static_cast<u64>(len));
+            }
+
             wzstring result {};
 
             // 循环读取len个16位无符号整数，并进行异或操作，然后将其添加到result字符串中
@@ -101,7 +107,7 @@ namespace wz
             {
                 auto encryptedChar = read<u16>();
                 encryptedChar ^= mask;
-                encryptedChar ^= *reinterpret_cast<u16*>(&key[2 * i]);
+                encryptedChar ^= *reinterpret_cast<const u16*>(&key[2 * i]);
                 result.push_back(encryptedChar);
                 mask++;
             }
@@ -127,6 +133,12 @@ namespace wz
             return {};
         }
 
+        if (counters != nullptr)
+        {
+            counters->add(Counter::StringsDecrypted);
+            counters->add(Counter::StringBytes, static_cast<u64>(len));
+        }
+
         wzstring result {};
 
         // 循环读取len个8位无符号整数，并进行异或操作，然后将其添加到result字符串中
@@ -142,7 +154,30 @@ namespace wz
         return result;
     }
 
-    mio::mmap_source::size_type Reader::size() const { return mmap.size(); }
+    mio::mmap_source::size_type Reader::size() const { return mmap->size(); }
+
+    const u8* Reader::data(const size_t& offset) const { return reinterpret_cast<const u8*>(mmap->data()) + offset; }
+
+    const std::string& Reader::get_path() const { return path; }
+
+    const Reader::Mapping& Reader::get_mapping() const { return mmap; }
+
+    void Reader::set_mapping(Mapping mapping)
+    {
+        mmap   = std::move(mapping);
+        cursor = 0;
+    }
+
+    bool Reader::remap()
+    {
+        std::error_code error_code;
+        auto mapping = mio::make_mmap_source<const char*>(path.c_str(), error_code);
+        if (error_code || !mapping.is_open())
+            return false;
+
+        set_mapping(std::make_shared<const mio::mmap_source>(std::move(mapping)));
+        return true;
+    }
 
     bool Reader::is_wz_image()
     {
@@ -167,6 +202,8 @@ namespace wz
                 return read_wz_string();
             case 1:
             case 0x1B:
+                if (counters != nullptr)
+                    counters->add(Counter::StringBlockRefs);
                 return read_wz_string_from_offset(offset + read<u32>());
             default: {
                 assert(0);
@@ -193,4 +230,9 @@ namespace wz
     {
         this->key = new_key;
     }
+
+    void Reader::set_counters(StatsCounters *new_counters)
+    {
+        counters = new_counters;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "Sound.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace wz
+{
+    SoundStream::SoundStream(const Property<WzSound> &property) : sound(property.get()), view(property.get_view()) {}
+
+    size_t SoundStream::read(u8 *dst, size_t size)
+    {
+        const auto chunk = next_chunk(size);
+        if (!chunk.empty())
+        {
+            memcpy(dst, chunk.data, chunk.size);
+        }
+        return chunk.size;
+    }
+
+    ByteView SoundStream::next_chunk(size_t max_size)
+    {
+        const auto count = std::min(max_size, view.size - cursor);
+        ByteView   chunk {view.data + cursor, count};
+        cursor += count;
+        return chunk;
+    }
+
+    void SoundStream::seek(size_t position) { cursor = std::min(position, view.size); }
+
+    size_t SoundStream::tell() const { return cursor; }
+
+    size_t SoundStream::size() const { return view.size; }
+
+    bool SoundStream::eof() const { return cursor == view.size; }
+
+    const WzSound &SoundStream::format() const { return sound; }
+}
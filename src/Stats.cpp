@@ -0,0 +1,39 @@
+#include "Stats.hpp"
+
+namespace wz
+{
+    ParseStats StatsCounters::snapshot() const
+    {
+        std::array<u64, counter_count> totals {};
+        for (const auto &shard : shards)
+        {
+            for (size_t i = 0; i < counter_count; ++i)
+            {
+                totals[i] += shard.values[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        auto value = [&](Counter counter) { return totals[static_cast<size_t>(counter)]; };
+
+        ParseStats stats;
+        stats.directory_bytes         = value(Counter::DirectoryBytes);
+        stats.image_bytes             = value(Counter::ImageBytes);
+        stats.strings_decrypted       = value(Counter::StringsDecrypted);
+        stats.string_bytes            = value(Counter::StringBytes);
+        stats.string_block_refs       = value(Counter::StringBlockRefs);
+        stats.images_parsed           = value(Counter::ImagesParsed);
+        stats.image_parse_failures    = value(Counter::ImageParseFailures);
+        stats.image_parse_ns          = value(Counter::ImageParseNs);
+        stats.canvases_inflated       = value(Counter::CanvasesInflated);
+        stats.canvas_compressed_bytes = value(Counter::CanvasCompressedBytes);
+        stats.canvas_bytes_inflated   = value(Counter::CanvasBytesInflated);
+        stats.inflate_ns              = value(Counter::InflateNs);
+        stats.image_cache_hits        = value(Counter::ImageCacheHits);
+        stats.image_cache_misses      = value(Counter::ImageCacheMisses);
+        for (size_t i = 0; i < node_type_count; ++i)
+        {
+            stats.nodes[i] = totals[static_cast<size_t>(Counter::Nodes) + i];
+        }
+        return stats;
+    }
+}
@@ -0,0 +1,227 @@
+#include "TextureCache.hpp"
+
+namespace wz
+{
+    TextureCache::TextureCache(size_t budget_bytes) { counters.budget_bytes = budget_bytes; }
+
+    u64 TextureCache::make_key(size_t offset, PixelFormat format)
+    {
+        return (static_cast<u64>(offset) << 1) | static_cast<u64>(format);
+    }
+
+    TextureCache::Content TextureCache::Content::of(const WzCanvas &canvas, u64 hash)
+    {
+        return {hash, static_cast<u32>(canvas.size), canvas.width, canvas.height, canvas.format + canvas.format2};
+    }
+
+    u64 TextureCache::make_content_key(const Content &content, PixelFormat format)
+    {
+        // 只用于分桶，命中后仍比较完整的Content
+        u64 key = content.hash;
+        for (const u64 value : {static_cast<u64>(content.compressed_size),
+                                static_cast<u64>(static_cast<u32>(content.width)),
+                                static_cast<u64>(static_cast<u32>(content.height)),
+                                static_cast<u64>(static_cast<u32>(content.format)),
+                                static_cast<u64>(format)})
+        {
+            key = (key ^ value) * 0x9E3779B97F4A7C15ull;
+        }
+        return key;
+    }
+
+    TextureCache::Pixels TextureCache::find(size_t offset, PixelFormat format)
+    {
+        std::lock_guard lock(mutex);
+
+        auto it = index.find(make_key(offset, format));
+        if (it == index.end())
+        {
+            ++counters.misses;
+            return nullptr;
+        }
+
+        ++counters.hits;
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->pixels;
+    }
+
+    TextureCache::Pixels TextureCache::insert(size_t offset, PixelFormat format, std::vector<u8> &&pixels)
+    {
+        const auto key = make_key(offset, format);
+
+        // 在锁外构造共享缓冲区
+        auto shared = std::make_shared<const std::vector<u8>>(std::move(pixels));
+
+        std::lock_guard lock(mutex);
+
+        if (auto it = index.find(key); it != index.end())
+        {
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->pixels;
+        }
+
+        return link(key, std::move(shared));
+    }
+
+    TextureCache::Pixels TextureCache::find_duplicate(size_t offset, PixelFormat format, const Content &content)
+    {
+        std::lock_guard lock(mutex);
+
+        if (!dedup)
+            return nullptr;
+
+        auto it = contents.find(make_content_key(content, format));
+        if (it == contents.end() || !(it->second.content == content))
+            return nullptr;
+
+        auto pixels = it->second.pixels.lock();
+        if (!pixels)
+        {
+            contents.erase(it);
+            return nullptr;
+        }
+
+        // 调用者会按width * height * 4读取，大小不符的缓冲区不能共享
+        if (content.width <= 0 || content.height <= 0 ||
+            pixels->size() != static_cast<size_t>(content.width) * static_cast<size_t>(content.height) * 4)
+            return nullptr;
+
+        ++counters.dedup_hits;
+        counters.dedup_bytes += pixels->size();
+
+        const auto key = make_key(offset, format);
+        if (auto existing = index.find(key); existing != index.end())
+        {
+            lru.splice(lru.begin(), lru, existing->second);
+            return existing->second->pixels;
+        }
+        return link(key, std::move(pixels));
+    }
+
+    TextureCache::Pixels TextureCache::insert(size_t          offset,
+                                              PixelFormat     format,
+                                              std::vector<u8> &&pixels,
+                                              const Content   &content)
+    {
+        auto shared = insert(offset, format, std::move(pixels));
+
+        std::lock_guard lock(mutex);
+
+        if (!dedup)
+            return shared;
+
+        auto resident = residents.find(shared.get());
+        if (resident == residents.end())
+            return shared; // 已被立即淘汰
+
+        const auto content_key = make_content_key(content, format);
+        if (auto it = contents.find(content_key); it == contents.end() || it->second.pixels.expired())
+        {
+            contents[content_key]           = {content, shared};
+            resident->second.content_key = content_key;
+            resident->second.has_content = true;
+        }
+        return shared;
+    }
+
+    void TextureCache::set_deduplicate(bool enabled)
+    {
+        std::lock_guard lock(mutex);
+        dedup = enabled;
+        if (!dedup)
+        {
+            contents.clear();
+            for (auto &[_, resident] : residents)
+            {
+                resident.has_content = false;
+            }
+        }
+    }
+
+    bool TextureCache::deduplicate() const
+    {
+        std::lock_guard lock(mutex);
+        return dedup;
+    }
+
+    void TextureCache::erase(size_t offset)
+    {
+        std::lock_guard lock(mutex);
+
+        for (auto format : {PixelFormat::RGBA8888, PixelFormat::BGRA8888})
+        {
+            if (auto it = index.find(make_key(offset, format)); it != index.end())
+            {
+                unlink(it->second);
+                index.erase(it);
+            }
+        }
+    }
+
+    void TextureCache::clear()
+    {
+        std::lock_guard lock(mutex);
+        lru.clear();
+        index.clear();
+        residents.clear();
+        contents.clear();
+        counters.resident_bytes = 0;
+    }
+
+    void TextureCache::set_budget(size_t budget_bytes)
+    {
+        std::lock_guard lock(mutex);
+        counters.budget_bytes = budget_bytes;
+        evict();
+    }
+
+    TextureCache::Stats TextureCache::stats() const
+    {
+        std::lock_guard lock(mutex);
+        auto            result = counters;
+        result.entries         = index.size();
+        return result;
+    }
+
+    TextureCache::Pixels TextureCache::link(u64 key, Pixels pixels)
+    {
+        auto &resident = residents[pixels.get()];
+        if (resident.refs++ == 0)
+        {
+            counters.resident_bytes += pixels->size();
+        }
+
+        lru.push_front({key, pixels});
+        index[key] = lru.begin();
+        evict();
+
+        return pixels;
+    }
+
+    void TextureCache::unlink(std::list<Entry>::iterator it)
+    {
+        auto resident = residents.find(it->pixels.get());
+        if (--resident->second.refs == 0)
+        {
+            counters.resident_bytes -= it->pixels->size();
+            if (resident->second.has_content)
+            {
+                contents.erase(resident->second.content_key);
+            }
+            residents.erase(resident);
+        }
+        lru.erase(it);
+    }
+
+    void TextureCache::evict()
+    {
+        // 至少保留最近插入的一项，避免单个超出预算的画布无法缓存后反复解码
+        while (counters.resident_bytes > counters.budget_bytes && lru.size() > 1)
+        {
+            auto victim = std::prev(lru.end());
+            index.erase(victim->key);
+            unlink(victim);
+            ++counters.evictions;
+        }
+    }
+}
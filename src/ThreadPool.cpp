@@ -0,0 +1,175 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace wz
+{
+    namespace
+    {
+        // 标记当前线程是否为线程池工作线程，用于避免嵌套parallel_for死锁
+        thread_local bool in_worker = false;
+    }
+
+    ThreadPool::ThreadPool(size_t threads)
+    {
+        if (threads == 0)
+        {
+            threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        // 最后一个队列属于调用parallel_for的线程
+        for (size_t i = 0; i < threads; ++i)
+        {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i + 1 < threads; ++i)
+        {
+            workers.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard lock(state_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    size_t ThreadPool::size() const { return queues.size(); }
+
+    ThreadPool &ThreadPool::shared()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)> &fn)
+    {
+        if (count == 0)
+            return;
+
+        if (in_worker || workers.empty() || count == 1)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                fn(i);
+            }
+            return;
+        }
+
+        std::lock_guard job_lock(job_mutex);
+
+        {
+            std::lock_guard lock(state_mutex);
+            job       = &fn;
+            error     = nullptr;
+            remaining = count;
+        }
+
+        const auto threads = queues.size();
+        for (size_t q = 0; q < threads; ++q)
+        {
+            std::lock_guard lock(queues[q]->mutex);
+            for (size_t i = count * q / threads; i < count * (q + 1) / threads; ++i)
+            {
+                queues[q]->items.push_back(i);
+            }
+        }
+
+        {
+            std::lock_guard lock(state_mutex);
+            ++generation;
+        }
+        wake.notify_all();
+
+        in_worker = true;
+        drain(threads - 1);
+        in_worker = false;
+
+        std::unique_lock lock(state_mutex);
+        done.wait(lock, [this] { return remaining.load() == 0; });
+        job = nullptr;
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void ThreadPool::worker_loop(size_t index)
+    {
+        in_worker = true;
+
+        size_t seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock lock(state_mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+            drain(index);
+        }
+    }
+
+    void ThreadPool::drain(size_t index)
+    {
+        size_t item;
+        while (pop(index, item) || steal(index, item))
+        {
+            try
+            {
+                (*job)(item);
+            }
+            catch (...)
+            {
+                std::lock_guard lock(state_mutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+
+            if (remaining.fetch_sub(1) == 1)
+            {
+                std::lock_guard lock(state_mutex);
+                done.notify_all();
+            }
+        }
+    }
+
+    bool ThreadPool::pop(size_t index, size_t &item)
+    {
+        auto           &queue = *queues[index];
+        std::lock_guard lock(queue.mutex);
+        if (queue.items.empty())
+            return false;
+        item = queue.items.front();
+        queue.items.pop_front();
+        return true;
+    }
+
+    bool ThreadPool::steal(size_t index, size_t &item)
+    {
+        for (size_t n = 1; n < queues.size(); ++n)
+        {
+            auto           &victim = *queues[(index + n) % queues.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.items.empty())
+            {
+                item = victim.items.back();
+                victim.items.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,143 @@
+#include "Trace.hpp"
+
+#include <atomic>
+#include <chrono>
+
+#include "Json.hpp"
+#include "Wz.hpp"
+
+namespace wz::trace
+{
+    namespace
+    {
+        std::atomic<Sink *> current_sink {nullptr};
+
+        u64 now_ns()
+        {
+            static const auto epoch = std::chrono::steady_clock::now();
+            return static_cast<u64>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+        }
+
+        u32 thread_index()
+        {
+            static std::atomic<u32> next {0};
+            thread_local const u32  index = next.fetch_add(1, std::memory_order_relaxed);
+            return index;
+        }
+    }
+
+    void set_sink(Sink *sink)
+    {
+        current_sink.store(sink, std::memory_order_release);
+    }
+
+    Sink *get_sink()
+    {
+        return current_sink.load(std::memory_order_acquire);
+    }
+
+    void ChromeTraceSink::record(const Span &span)
+    {
+        std::lock_guard lock(mutex);
+        spans.push_back(span);
+    }
+
+    void ChromeTraceSink::write(std::ostream &out) const
+    {
+        std::lock_guard lock(mutex);
+
+        std::string text = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (size_t i = 0; i < spans.size(); ++i)
+        {
+            const auto &span = spans[i];
+            if (i != 0)
+                text += ',';
+
+            // ts与dur以微秒为单位
+            text += "\n{\"name\":";
+            json::append_string(text, std::string(span.name != nullptr ? span.name : ""));
+            text += ",\"cat\":\"wz\",\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(span.thread) + ",\"ts\":";
+            json::append_number(text, static_cast<f64>(span.start_ns) / 1000.0, 15);
+            text += ",\"dur\":";
+            json::append_number(text, static_cast<f64>(span.duration_ns) / 1000.0, 15);
+            text += ",\"args\":{\"path\":";
+            json::append_string(text, span.path);
+            text += ",\"bytes\":" + std::to_string(span.bytes);
+            if (span.output_bytes != 0)
+                text += ",\"output_bytes\":" + std::to_string(span.output_bytes);
+            text += "}}";
+
+            if (text.size() >= 1 << 16)
+            {
+                out.write(text.data(), static_cast<std::streamsize>(text.size()));
+                text.clear();
+            }
+        }
+        text += "\n]}\n";
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    size_t ChromeTraceSink::size() const
+    {
+        std::lock_guard lock(mutex);
+        return spans.size();
+    }
+
+    void ChromeTraceSink::clear()
+    {
+        std::lock_guard lock(mutex);
+        spans.clear();
+    }
+
+    Scope::Scope(const char *name) : sink(get_sink())
+    {
+        if (sink == nullptr)
+            return;
+        span.name     = name;
+        span.start_ns = now_ns();
+    }
+
+    Scope::~Scope()
+    {
+        finish();
+    }
+
+    void Scope::set_name(const char *name)
+    {
+        span.name = name;
+    }
+
+    void Scope::set_path(const wzstring &path)
+    {
+        if (sink != nullptr)
+            span.path = to_utf8(path);
+    }
+
+    void Scope::set_path(const std::string &path)
+    {
+        if (sink != nullptr)
+            span.path = path;
+    }
+
+    void Scope::set_bytes(u64 bytes, u64 output_bytes)
+    {
+        span.bytes        = bytes;
+        span.output_bytes = output_bytes;
+    }
+
+    void Scope::finish()
+    {
+        if (sink == nullptr)
+            return;
+        span.duration_ns = now_ns() - span.start_ns;
+        span.thread      = thread_index();
+        sink->record(span);
+        sink = nullptr;
+    }
+
+    void Scope::cancel()
+    {
+        sink = nullptr;
+    }
+}
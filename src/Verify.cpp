@@ -0,0 +1,110 @@
+#include "Verify.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#include "Canvas.hpp"
+#include "Directory.hpp"
+
+namespace wz
+{
+    i32 image_checksum(const u8 *data, size_t size)
+    {
+        // 分成多路累加，编译器可以把内层循环向量化
+        u64    lanes[8] = {};
+        size_t i        = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            for (size_t lane = 0; lane < 8; ++lane)
+            {
+                lanes[lane] += data[i + lane];
+            }
+        }
+
+        u64 sum = 0;
+        for (auto lane : lanes)
+        {
+            sum += lane;
+        }
+        for (; i < size; ++i)
+        {
+            sum += data[i];
+        }
+        return static_cast<i32>(static_cast<u32>(sum));
+    }
+
+    VerifyResult verify(const File &file, const VerifyCallback &progress, ThreadPool &pool)
+    {
+        const auto &reader = file.get_reader();
+
+        auto images = collect_images(file.get_root());
+        std::sort(images.begin(), images.end(), [](Directory *a, Directory *b) { return a->get_offset() < b->get_offset(); });
+
+        VerifyResult result;
+        result.images = images.size();
+        for (auto *image : images)
+        {
+            result.bytes += static_cast<u64>(std::max(image->get_size(), 0));
+        }
+
+        std::mutex          mutex;
+        std::atomic<size_t> images_done {0};
+        std::atomic<u64>    bytes_done {0};
+        u64                 reported = 0;
+        const u64           step     = std::max<u64>(result.bytes / 256, 1);
+
+        pool.parallel_for(images.size(), [&](size_t i) {
+            auto      *image = images[i];
+            const auto size  = static_cast<u64>(std::max(image->get_size(), 0));
+
+            VerifyIssue issue;
+            issue.path     = image->path;
+            issue.offset   = image->get_offset();
+            issue.size     = image->get_size();
+            issue.expected = image->get_checksum();
+
+            bool bad = false;
+            if (image->get_size() < 0 || issue.offset + size > reader.size())
+            {
+                issue.out_of_range = true;
+                bad                = true;
+            }
+            else
+            {
+                issue.actual = image_checksum(reader.data(issue.offset), size);
+                bad          = issue.actual != issue.expected;
+            }
+
+            images_done.fetch_add(1);
+            bytes_done.fetch_add(size);
+
+            if (!bad && !progress)
+                return;
+
+            std::lock_guard lock(mutex);
+            if (bad)
+                result.issues.push_back(std::move(issue));
+
+            // 在锁内读取计数：各线程的fetch_add返回值先后不定，按它们回调时计数可能倒退
+            const auto done  = images_done.load();
+            const auto bytes = bytes_done.load();
+            if (progress && bytes >= reported + step && done < images.size())
+            {
+                reported = bytes;
+                progress({done, images.size(), bytes, result.bytes, result.issues.size()});
+            }
+        });
+
+        // 各线程的计数先后不定，最终状态统一在全部完成后回调
+        if (progress)
+        {
+            progress({images.size(), images.size(), result.bytes, result.bytes, result.issues.size()});
+        }
+
+        std::sort(result.issues.begin(), result.issues.end(), [](const VerifyIssue &a, const VerifyIssue &b) {
+            return a.offset < b.offset;
+        });
+        return result;
+    }
+}
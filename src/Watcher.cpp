@@ -0,0 +1,152 @@
+#include "Watcher.hpp"
+
+#include <filesystem>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace wz
+{
+    FileWatcher::FileWatcher(File &file, std::mutex &guard, Callback on_reload)
+        : file(file), guard(guard), on_reload(std::move(on_reload))
+    {
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+        stop();
+    }
+
+    bool FileWatcher::running() const
+    {
+        return worker.joinable();
+    }
+
+    int FileWatcher::error() const
+    {
+        return failure.load(std::memory_order_acquire);
+    }
+
+#if defined(__linux__)
+    bool FileWatcher::start(std::chrono::milliseconds new_settle)
+    {
+        if (running())
+            return true;
+
+        const std::filesystem::path path = file.get_reader().get_path();
+        if (path.empty())
+            return false;
+
+        // 补丁以"写临时文件再rename"的方式替换，因此监视所在目录而不是文件本身；
+        // 只响应IN_MOVED_TO，就地改写(IN_CLOSE_WRITE)会改变reload保留的旧映射，不支持
+        auto directory = path.parent_path();
+        if (directory.empty())
+            directory = ".";
+
+        notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        stop_fd   = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (notify_fd < 0 || stop_fd < 0 ||
+            inotify_add_watch(notify_fd, directory.c_str(), IN_MOVED_TO) < 0)
+        {
+            if (notify_fd >= 0)
+                close(notify_fd);
+            if (stop_fd >= 0)
+                close(stop_fd);
+            notify_fd = stop_fd = -1;
+            return false;
+        }
+
+        settle = new_settle;
+        failure.store(0, std::memory_order_relaxed);
+        worker = std::thread(&FileWatcher::run, this);
+        return true;
+    }
+
+    void FileWatcher::stop()
+    {
+        if (!running())
+            return;
+
+        const u64 one = 1;
+        [[maybe_unused]] auto written = write(stop_fd, &one, sizeof(one));
+        worker.join();
+
+        close(notify_fd);
+        close(stop_fd);
+        notify_fd = stop_fd = -1;
+    }
+
+    void FileWatcher::run()
+    {
+        const auto name = std::filesystem::path(file.get_reader().get_path()).filename().string();
+
+        pollfd fds[2] = {{notify_fd, POLLIN, 0}, {stop_fd, POLLIN, 0}};
+        bool   pending = false;
+        alignas(inotify_event) char buffer[4096];
+
+        while (true)
+        {
+            const int ready = poll(fds, 2, pending ? static_cast<int>(settle.count()) : -1);
+            if (ready < 0)
+            {
+                // 被信号打断时重试；其他错误(EBADF、ENOMEM、EINVAL)不会自行恢复，记录后退出
+                if (errno == EINTR)
+                    continue;
+                failure.store(errno, std::memory_order_release);
+                break;
+            }
+
+            if (fds[1].revents & POLLIN)
+                break;
+
+            // 描述符失效时poll立即返回而不是出错，同样不会自行恢复
+            if ((fds[0].revents | fds[1].revents) & (POLLERR | POLLNVAL))
+            {
+                failure.store(EBADF, std::memory_order_release);
+                break;
+            }
+
+            if (ready == 0)
+            {
+                // 一段时间内没有新的事件，认为文件已替换完成
+                pending = false;
+                ReloadStats stats;
+                bool        ok;
+                {
+                    std::lock_guard lock(guard);
+                    ok = file.reload(&stats);
+                }
+                if (on_reload)
+                    on_reload(ok, stats);
+                continue;
+            }
+
+            ssize_t length;
+            while ((length = read(notify_fd, buffer, sizeof(buffer))) > 0)
+            {
+                for (char *p = buffer; p < buffer + length;)
+                {
+                    const auto *event = reinterpret_cast<const inotify_event *>(p);
+                    if (event->len != 0 && name == event->name)
+                        pending = true;
+                    p += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+    }
+#else
+    bool FileWatcher::start(std::chrono::milliseconds)
+    {
+        return false;
+    }
+
+    void FileWatcher::stop() {}
+
+    void FileWatcher::run() {}
+#endif
+}
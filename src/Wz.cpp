@@ -1,6 +1,9 @@
 #include "Wz.hpp"
 #include "Property.hpp"
 
+#include <algorithm>
+#include <cstdlib>
+
 #define HASHING(V, S) ((V >> S##u) & 0xFFu)
 #define AUTO_HASH(V) (0xFFu ^ HASHING(V, 24) ^ HASHING(V, 16) ^ HASHING(V, 8) ^ V & 0xFFu)
 
@@ -37,3 +40,105 @@ u32 wz::get_version_hash(i32 encryptedVersion, i32 realVersion)
 
     return 0;
 }
+
+
+std::string wz::to_utf8(const wzstring& text)
+{
+    std::string result;
+    result.reserve(text.size());
+
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        u32 code = text[i];
+        // 代理对合成一个码点，孤立的代理项替换为U+FFFD
+        if (code >= 0xD800 && code <= 0xDBFF && i + 1 < text.size() && text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF)
+        {
+            code = 0x10000 + ((code - 0xD800) << 10) + (text[++i] - 0xDC00);
+        }
+        else if (code >= 0xD800 && code <= 0xDFFF)
+        {
+            code = 0xFFFD;
+        }
+
+        if (code < 0x80)
+        {
+            result += static_cast<char>(code);
+        }
+        else if (code < 0x800)
+        {
+            result += static_cast<char>(0xC0 | (code >> 6));
+            result += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else if (code < 0x10000)
+        {
+            result += static_cast<char>(0xE0 | (code >> 12));
+            result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            result += static_cast<char>(0xF0 | (code >> 18));
+            result += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    return result;
+}
+
+std::array<u8, 4> wz::keys::parse_iv(const std::string& text)
+{
+    std::array<u8, 4> iv {0, 0, 0, 0};
+    if (text == "gms")
+    {
+        std::copy(gms, gms + 4, iv.begin());
+    }
+    else if (text == "kms")
+    {
+        std::copy(kms, kms + 4, iv.begin());
+    }
+    else
+    {
+        const auto value = std::strtoul(text.c_str(), nullptr, 16);
+        for (int i = 0; i < 4; ++i)
+        {
+            iv[i] = static_cast<u8>(value >> (24 - 8 * i));
+        }
+    }
+    return iv;
+}
+
+// 导出与差异JSON共用的类型名
+const char* wz::type_name(Type type)
+{
+    switch (type)
+    {
+        case Type::Null:
+            return "null";
+        case Type::Int:
+            return "int";
+        case Type::UnsignedShort:
+            return "ushort";
+        case Type::Float:
+            return "float";
+        case Type::Double:
+            return "double";
+        case Type::String:
+            return "string";
+        case Type::SubProperty:
+            return "property";
+        case Type::Canvas:
+            return "canvas";
+        case Type::Vector2D:
+            return "vector";
+        case Type::Convex2D:
+            return "convex";
+        case Type::Sound:
+            return "sound";
+        case Type::UOL:
+            return "uol";
+        default:
+            return "node";
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wz/Canvas.hpp>
+#include <wz/Directory.hpp>
+#include <wz/File.hpp>
+#include <wz/Generate.hpp>
+
+// 需要真实wz文件的测试共用：生成到临时目录的合成归档与遍历辅助函数
+
+namespace wz::test
+{
+    constexpr std::array<u8, 4> iv {0x4D, 0x23, 0xC7, 0x2B};
+
+    // 每个测试程序在临时目录下使用自己的子目录，并行运行的测试不会互相覆盖
+    inline std::string temp_path(const std::string &test, const std::string &name)
+    {
+        const auto dir = std::filesystem::temp_directory_path() / ("wzlib_" + test);
+        std::filesystem::create_directories(dir);
+        return (dir / name).string();
+    }
+
+    inline void remove_temp(const std::string &test)
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(std::filesystem::temp_directory_path() / ("wzlib_" + test), ec);
+    }
+
+    // 覆盖全部画布格式(加密与未加密)、声音与UOL的小归档；宽高不是16与4的倍数以覆盖边缘
+    inline GeneratorOptions small_archive()
+    {
+        GeneratorOptions options;
+        options.iv            = iv;
+        options.version       = 83;
+        options.depth         = 2;
+        options.fanout        = 2;
+        options.images        = 3;
+        options.canvases      = 12;
+        options.canvas_width  = 37;
+        options.canvas_height = 21;
+        options.sounds        = 2;
+        return options;
+    }
+
+    // 以测试的iv打开path，parse失败时返回nullptr
+    inline std::unique_ptr<File> open_archive(const std::string &path)
+    {
+        auto file = std::make_unique<File>(iv, path.c_str());
+        if (!file->parse())
+            return nullptr;
+        return file;
+    }
+
+    // 先序遍历node的全部子孙
+    inline void walk(Node *node, const std::function<void(Node *)> &fn)
+    {
+        for (auto &[_, list] : *node)
+        {
+            for (auto *child : list)
+            {
+                fn(child);
+                walk(child, fn);
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <wz/NumTypes.hpp>
+
+// 测试程序共用的检查宏：失败时输出位置并计数，main返回wz::test::result()
+
+namespace wz::test
+{
+    inline int &failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline bool check(bool ok, const char *expr, const char *file, int line)
+    {
+        if (!ok)
+        {
+            std::printf("%s:%d: check failed: %s\n", file, line, expr);
+            ++failures();
+        }
+        return ok;
+    }
+
+    inline int result()
+    {
+        if (failures() == 0)
+        {
+            std::printf("all checks passed\n");
+            return 0;
+        }
+        std::printf("%d check(s) failed\n", failures());
+        return 1;
+    }
+
+    // 固定种子的随机字节，失败可以复现
+    inline std::vector<u8> random_bytes(size_t size, u32 seed)
+    {
+        std::mt19937                       engine(seed);
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::vector<u8>                    out(size);
+        for (auto &value : out)
+        {
+            value = static_cast<u8>(byte(engine));
+        }
+        return out;
+    }
+}
+
+#define WZ_CHECK(expr) ::wz::test::check(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
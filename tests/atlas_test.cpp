@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <wz/Atlas.hpp>
+#include <wz/Canvas.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// build_atlas：与输入顺序和线程数无关的确定性、页面内互不重叠的放置、像素与UV，以及独占一页的超大画布
+
+namespace
+{
+    const char *test_name = "atlas_test";
+
+    struct Placement
+    {
+        u32 page;
+        i32 x;
+        i32 y;
+
+        bool operator==(const Placement &other) const
+        {
+            return page == other.page && x == other.x && y == other.y;
+        }
+    };
+
+    std::map<wz::Property<wz::WzCanvas> *, Placement> placements(const wz::Atlas &atlas)
+    {
+        std::map<wz::Property<wz::WzCanvas> *, Placement> out;
+        for (const auto &entry : atlas.entries)
+        {
+            out[entry.canvas] = {entry.page, entry.x, entry.y};
+        }
+        return out;
+    }
+
+    bool same_pages(const wz::Atlas &a, const wz::Atlas &b)
+    {
+        if (a.pages.size() != b.pages.size())
+            return false;
+        for (size_t i = 0; i < a.pages.size(); ++i)
+        {
+            const auto &pa = a.pages[i];
+            const auto &pb = b.pages[i];
+            if (pa.width != pb.width || pa.height != pb.height || pa.pixels != pb.pixels)
+                return false;
+        }
+        return true;
+    }
+
+    // 放置、UV与像素：每个画布加上padding后互不重叠，区域内为画布像素，其余像素透明
+    void check_layout(const wz::Atlas &atlas, const wz::AtlasOptions &options)
+    {
+        std::vector<std::vector<u8>> covered(atlas.pages.size());
+        for (size_t page = 0; page < atlas.pages.size(); ++page)
+        {
+            const auto &p = atlas.pages[page];
+            WZ_CHECK(p.width > 0 && p.height > 0);
+            WZ_CHECK(p.pixels.size() == static_cast<size_t>(p.width) * p.height * 4);
+            covered[page].assign(static_cast<size_t>(p.width) * p.height, 0);
+        }
+
+        for (const auto &entry : atlas.entries)
+        {
+            if (!WZ_CHECK(entry.page < atlas.pages.size() && entry.decoded))
+                continue;
+            const auto &p = atlas.pages[entry.page];
+            WZ_CHECK(entry.x >= 0 && entry.y >= 0);
+            WZ_CHECK(entry.x + entry.width <= p.width && entry.y + entry.height <= p.height);
+
+            // 超大画布独占一页，其余画布加上padding后不超过页面上限
+            const auto w = entry.width + options.padding;
+            const auto h = entry.height + options.padding;
+            if (w > options.max_width || h > options.max_height)
+                WZ_CHECK(entry.x == 0 && entry.y == 0 && p.width == w && p.height == h);
+            else
+                WZ_CHECK(entry.x + w <= options.max_width && entry.y + h <= options.max_height);
+
+            WZ_CHECK(entry.u0 == static_cast<f32>(entry.x) / static_cast<f32>(p.width));
+            WZ_CHECK(entry.v1 == static_cast<f32>(entry.y + entry.height) / static_cast<f32>(p.height));
+
+            const auto &info = entry.canvas->get();
+            WZ_CHECK(entry.width == info.width && entry.height == info.height);
+            WZ_CHECK(entry.origin.x == info.width / 2 && entry.origin.y == info.height);
+
+            // padding区域只标记页面内的部分
+            bool overlap = false;
+            for (i32 y = entry.y; y < std::min(entry.y + h, p.height); ++y)
+            {
+                for (i32 x = entry.x; x < std::min(entry.x + w, p.width); ++x)
+                {
+                    auto &cell = covered[entry.page][static_cast<size_t>(y) * p.width + x];
+                    overlap |= cell != 0;
+                    cell = (x < entry.x + entry.width && y < entry.y + entry.height) ? 2 : 1;
+                }
+            }
+            WZ_CHECK(!overlap);
+
+            std::vector<u8> pixels(wz::pixel::decoded_size(info));
+            if (!WZ_CHECK(entry.canvas->decode(pixels.data(), pixels.size(), options.format)))
+                continue;
+            const auto row = static_cast<size_t>(entry.width) * 4;
+            bool       same = true;
+            for (i32 y = 0; y < entry.height; ++y)
+            {
+                const auto *src = pixels.data() + static_cast<size_t>(y) * row;
+                const auto *dst = p.pixels.data() + (static_cast<size_t>(entry.y + y) * p.width + entry.x) * 4;
+                same &= std::memcmp(src, dst, row) == 0;
+            }
+            WZ_CHECK(same);
+        }
+
+        for (size_t page = 0; page < atlas.pages.size(); ++page)
+        {
+            const auto &p           = atlas.pages[page];
+            bool        transparent = true;
+            for (size_t i = 0; i < covered[page].size(); ++i)
+            {
+                if (covered[page][i] != 2)
+                    transparent &= p.pixels[i * 4] == 0 && p.pixels[i * 4 + 1] == 0 && p.pixels[i * 4 + 2] == 0 &&
+                                   p.pixels[i * 4 + 3] == 0;
+            }
+            WZ_CHECK(transparent);
+        }
+    }
+}
+
+int main()
+{
+    // 三种尺寸的画布：普通、瘦高与超过页面宽度的宽条
+    struct Size
+    {
+        i32 width;
+        i32 height;
+    };
+    const Size sizes[] {{37, 21}, {9, 30}, {80, 5}};
+
+    std::vector<std::unique_ptr<wz::File>>    files;
+    std::vector<wz::Property<wz::WzCanvas> *> canvases;
+    for (const auto &size : sizes)
+    {
+        auto options          = wz::test::small_archive();
+        options.depth         = 0;
+        options.images        = 2;
+        options.canvases      = 6;
+        options.canvas_width  = size.width;
+        options.canvas_height = size.height;
+
+        const auto path = wz::test::temp_path(test_name, std::to_string(size.width) + ".wz");
+        if (!WZ_CHECK(wz::generate_archive(path, options)))
+            return wz::test::result();
+        auto file = wz::test::open_archive(path);
+        if (!WZ_CHECK(file != nullptr))
+            return wz::test::result();
+
+        const auto list = wz::collect_canvases(file->get_root());
+        canvases.insert(canvases.end(), list.begin(), list.end());
+        files.push_back(std::move(file));
+    }
+    WZ_CHECK(canvases.size() == 36);
+
+    wz::AtlasOptions options;
+    options.max_width  = 64;
+    options.max_height = 64;
+    options.padding    = 2;
+
+    wz::ThreadPool single(1);
+    const auto     reference = wz::build_atlas(canvases, options, single);
+    WZ_CHECK(reference.entries.size() == canvases.size());
+    WZ_CHECK(reference.pages.size() > 1 + 12); // 普通画布需要多页，12个宽条各占一页
+    check_layout(reference, options);
+    for (size_t i = 0; i < canvases.size(); ++i)
+    {
+        WZ_CHECK(reference.entries[i].canvas == canvases[i]);
+    }
+
+    // 线程数与输入顺序都不影响结果
+    {
+        const auto parallel = wz::build_atlas(canvases, options, wz::ThreadPool::shared());
+        WZ_CHECK(same_pages(reference, parallel) && placements(reference) == placements(parallel));
+
+        auto shuffled = canvases;
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(7));
+        const auto reordered = wz::build_atlas(shuffled, options, wz::ThreadPool::shared());
+        WZ_CHECK(same_pages(reference, reordered) && placements(reference) == placements(reordered));
+        for (size_t i = 0; i < shuffled.size(); ++i)
+        {
+            WZ_CHECK(reordered.entries[i].canvas == shuffled[i]);
+        }
+    }
+
+    // 默认的页面大小：全部画布放进一页，宽条不再独占
+    {
+        const auto atlas = wz::build_atlas(canvases);
+        WZ_CHECK(atlas.pages.size() == 1);
+        check_layout(atlas, {});
+    }
+
+    // BGRA输出与padding为0
+    {
+        options.format  = wz::PixelFormat::BGRA8888;
+        options.padding = 0;
+        check_layout(wz::build_atlas(canvases, options), options);
+    }
+
+    WZ_CHECK(wz::build_atlas({}).pages.empty());
+
+    files.clear();
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
@@ -0,0 +1,152 @@
+#include <cstring>
+#include <vector>
+
+#include <wz/Canvas.hpp>
+#include <wz/Pixel.hpp>
+#include <wz/Property.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// decode_rows与decode_region的结果必须与整块decode的对应区域一致
+
+namespace
+{
+    const char *test_name = "canvas_test";
+
+    constexpr wz::PixelFormat formats[] = {wz::PixelFormat::RGBA8888, wz::PixelFormat::BGRA8888};
+
+    // 从整块解码结果中裁出clip区域，clip之外的部分保持fill
+    std::vector<u8> crop(const std::vector<u8> &full, i32 width, i32 height, const wz::CanvasRect &clip, u8 fill)
+    {
+        std::vector<u8> out(static_cast<size_t>(clip.width) * clip.height * 4, fill);
+        for (i32 y = 0; y < clip.height; ++y)
+        {
+            for (i32 x = 0; x < clip.width; ++x)
+            {
+                const auto sx = clip.x + x;
+                const auto sy = clip.y + y;
+                if (sx < 0 || sy < 0 || sx >= width || sy >= height)
+                    continue;
+                std::memcpy(out.data() + (static_cast<size_t>(y) * clip.width + x) * 4,
+                            full.data() + (static_cast<size_t>(sy) * width + sx) * 4,
+                            4);
+            }
+        }
+        return out;
+    }
+
+    void check_canvas(wz::Property<wz::WzCanvas> *canvas, wz::PixelFormat format)
+    {
+        const auto &info   = canvas->get();
+        const auto  width  = info.width;
+        const auto  height = info.height;
+
+        std::vector<u8> full(wz::pixel::decoded_size(info));
+        if (!WZ_CHECK(canvas->decode(full.data(), full.size(), format)))
+            return;
+
+        // 不裁剪时每行按顺序回调一次
+        std::vector<u8> rows(full.size(), 0xCD);
+        i32             next = 0;
+        WZ_CHECK(canvas->decode_rows(
+            [&](i32 y, const u8 *row) {
+                WZ_CHECK(y == next);
+                next = y + 1;
+                std::memcpy(rows.data() + static_cast<size_t>(y) * width * 4, row, static_cast<size_t>(width) * 4);
+            },
+            format));
+        WZ_CHECK(next == height);
+        WZ_CHECK(rows == full);
+
+        const wz::CanvasRect clips[] = {
+            {0, 0, width, height},
+            {5, 3, 10, 7},
+            {width - 1, height - 1, 1, 1},
+            {0, height / 2, width, height - height / 2}, // 只有下半部分，按行解码不能跳过上半部分的数据
+            {-4, -3, 12, 9},                             // 部分在画布之外
+            {width - 6, height - 5, 10, 10},
+        };
+
+        for (const auto &clip : clips)
+        {
+            // 回调只覆盖clip与画布的交集，每行从交集的左边界开始
+            const auto x0 = std::max(clip.x, 0);
+            const auto x1 = std::min(clip.x + clip.width, width);
+            const auto y0 = std::max(clip.y, 0);
+            const auto y1 = std::min(clip.y + clip.height, height);
+
+            i32  expected_y = y0;
+            bool rows_match = true;
+            WZ_CHECK(canvas->decode_rows(
+                [&](i32 y, const u8 *row) {
+                    rows_match = rows_match && y == expected_y &&
+                                 std::memcmp(row,
+                                             full.data() + (static_cast<size_t>(y) * width + x0) * 4,
+                                             static_cast<size_t>(x1 - x0) * 4) == 0;
+                    ++expected_y;
+                },
+                format,
+                &clip));
+            WZ_CHECK(rows_match);
+            WZ_CHECK(expected_y == y1);
+
+            // decode_region写入带行步长的缓冲区，行尾的填充字节保持不变
+            const size_t    stride = static_cast<size_t>(clip.width) * 4 + 12;
+            std::vector<u8> region(stride * clip.height, 0xCD);
+            WZ_CHECK(canvas->decode_region(region.data(), stride, clip, format));
+
+            std::vector<u8> packed(static_cast<size_t>(clip.width) * clip.height * 4);
+            for (i32 y = 0; y < clip.height; ++y)
+            {
+                std::memcpy(packed.data() + static_cast<size_t>(y) * clip.width * 4,
+                            region.data() + y * stride,
+                            static_cast<size_t>(clip.width) * 4);
+                for (size_t pad = static_cast<size_t>(clip.width) * 4; pad < stride; ++pad)
+                {
+                    rows_match = rows_match && region[y * stride + pad] == 0xCD;
+                }
+            }
+            if (!WZ_CHECK(packed == crop(full, width, height, clip, 0xCD) && rows_match))
+            {
+                std::printf("  format %d, clip %d,%d %dx%d\n", info.format + info.format2, clip.x, clip.y, clip.width,
+                            clip.height);
+            }
+        }
+    }
+}
+
+int main()
+{
+    const auto path = wz::test::temp_path(test_name, "canvas.wz");
+
+    // 两种尺寸：边缘不足一个块的37x21，以及恰好是块大小整数倍的64x48
+    for (const auto &size : {std::pair {37, 21}, std::pair {64, 48}})
+    {
+        auto options          = wz::test::small_archive();
+        options.canvas_width  = size.first;
+        options.canvas_height = size.second;
+        if (!WZ_CHECK(wz::generate_archive(path, options)))
+            break;
+
+        auto file = wz::test::open_archive(path);
+        if (!WZ_CHECK(file != nullptr))
+            break;
+
+        const auto images = wz::collect_images(file->get_root());
+
+        size_t checked = 0;
+        for (auto *canvas : wz::collect_canvases(file->load_image(images.front())))
+        {
+            for (const auto format : formats)
+            {
+                check_canvas(canvas, format);
+            }
+            ++checked;
+        }
+        WZ_CHECK(checked == options.canvases);
+    }
+
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
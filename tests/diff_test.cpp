@@ -0,0 +1,162 @@
+#include <sstream>
+#include <string>
+
+#include <wz/Diff.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// 两个合成归档之间的diff：目录项级别的计数与变化类型，以及deep模式的属性级变化
+
+namespace
+{
+    const char *test_name = "diff_test";
+
+    size_t count(const wz::DiffResult &result, wz::ChangeKind kind)
+    {
+        size_t n = 0;
+        for (const auto &change : result.images)
+        {
+            n += change.kind == kind ? 1 : 0;
+        }
+        return n;
+    }
+
+    bool ends_with(const wz::wzstring &text, const wz::wzstring &suffix)
+    {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // 相对根目录的路径，例如"/Dir1/00000.img"
+    wz::wzstring relative(wz::File &file, const wz::wzstring &path)
+    {
+        return path.substr(file.get_root()->path.size());
+    }
+}
+
+int main()
+{
+    const auto before_path = wz::test::temp_path(test_name, "before.wz");
+    const auto after_path  = wz::test::temp_path(test_name, "after.wz");
+    const auto sounds_path = wz::test::temp_path(test_name, "sounds.wz");
+
+    // 原始归档：根目录、Dir0、Dir1与四个二级目录，各3个image，共21个
+    const auto before_options = wz::test::small_archive();
+
+    // 删除二级目录(12个image)，每个目录新增00003.img(3个)，Dir1下的image改变(3个)，其余6个不变
+    auto after_options        = before_options;
+    after_options.depth       = 1;
+    after_options.images      = 4;
+    after_options.reseed_path = u"Dir1/";
+
+    // 每个image多一个声音，其余属性不变
+    auto sounds_options   = before_options;
+    sounds_options.sounds = before_options.sounds + 1;
+
+    if (!WZ_CHECK(wz::generate_archive(before_path, before_options) &&
+                  wz::generate_archive(after_path, after_options) &&
+                  wz::generate_archive(sounds_path, sounds_options)))
+        return wz::test::result();
+
+    auto before = wz::test::open_archive(before_path);
+    auto after  = wz::test::open_archive(after_path);
+    auto sounds = wz::test::open_archive(sounds_path);
+    if (!WZ_CHECK(before != nullptr && after != nullptr && sounds != nullptr))
+        return wz::test::result();
+
+    // 相同的文件：全部未变
+    {
+        const auto result = wz::diff(*before, *before);
+        WZ_CHECK(result.images.empty() && result.compared == 21 && result.unchanged == 21);
+    }
+
+    // 目录项级别：新增、删除与修改
+    for (const bool deep : {false, true})
+    {
+        wz::DiffOptions options;
+        options.deep      = deep;
+        const auto result = wz::diff(*before, *after, options);
+
+        WZ_CHECK(result.compared == 9 && result.unchanged == 6);
+        WZ_CHECK(count(result, wz::ChangeKind::Added) == 3);
+        WZ_CHECK(count(result, wz::ChangeKind::Removed) == 12);
+        WZ_CHECK(count(result, wz::ChangeKind::Modified) == 3);
+
+        for (size_t i = 1; i < result.images.size(); ++i)
+        {
+            WZ_CHECK(result.images[i - 1].path < result.images[i].path);
+        }
+
+        for (const auto &change : result.images)
+        {
+            const auto path = relative(*after, change.path);
+            switch (change.kind)
+            {
+                case wz::ChangeKind::Added:
+                    WZ_CHECK(ends_with(path, u"/00003.img") && change.new_size > 0 && change.old_size == 0);
+                    break;
+                case wz::ChangeKind::Removed:
+                    WZ_CHECK((path.rfind(u"/Dir0/Dir", 0) == 0 || path.rfind(u"/Dir1/Dir", 0) == 0) &&
+                             change.old_size > 0 && change.new_size == 0);
+                    break;
+                case wz::ChangeKind::Modified:
+                    WZ_CHECK(path.rfind(u"/Dir1/", 0) == 0 && !change.parse_failed);
+                    WZ_CHECK(change.old_checksum != change.new_checksum);
+                    if (!deep)
+                    {
+                        WZ_CHECK(change.properties.empty());
+                        break;
+                    }
+
+                    // 重新生成的image：结构相同，值不同
+                    WZ_CHECK(!change.properties.empty());
+                    bool id_changed = false;
+                    for (const auto &property : change.properties)
+                    {
+                        WZ_CHECK(property.kind == wz::ChangeKind::Modified);
+                        WZ_CHECK(!property.before.empty() && property.before != property.after);
+                        id_changed |= ends_with(property.path, u"/info/id");
+                    }
+                    WZ_CHECK(id_changed);
+                    break;
+            }
+        }
+
+        // JSON中每个变化一项
+        std::ostringstream json;
+        wz::write_json(result, json);
+        const auto text = json.str();
+        WZ_CHECK(text.rfind("{\"compared\":9,\"unchanged\":6,", 0) == 0);
+        size_t entries = 0;
+        for (auto at = text.find("\n{\"path\":"); at != std::string::npos; at = text.find("\n{\"path\":", at + 1))
+        {
+            ++entries;
+        }
+        WZ_CHECK(entries == result.images.size());
+    }
+
+    // 属性级别的新增与删除：每个image只多(少)一个sound2
+    for (const bool reverse : {false, true})
+    {
+        const auto result = reverse ? wz::diff(*sounds, *before) : wz::diff(*before, *sounds);
+        WZ_CHECK(result.compared == 21 && result.unchanged == 0);
+        WZ_CHECK(count(result, wz::ChangeKind::Modified) == 21);
+
+        const auto expected = reverse ? wz::ChangeKind::Removed : wz::ChangeKind::Added;
+        for (const auto &change : result.images)
+        {
+            if (!WZ_CHECK(change.properties.size() == 1))
+                continue;
+            const auto &property = change.properties.front();
+            WZ_CHECK(property.kind == expected && property.path == change.path + u"/sound2");
+            WZ_CHECK(reverse ? property.after.empty() && !property.before.empty()
+                             : property.before.empty() && property.after.rfind("{\"type\":\"sound\"", 0) == 0);
+        }
+    }
+
+    before.reset();
+    after.reset();
+    sounds.reset();
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
@@ -0,0 +1,163 @@
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include <wz/Export.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// NDJSON导出：输出与线程数、批大小无关；同名的兄弟节点得到不同的键与外部文件
+
+namespace
+{
+    const char *test_name = "export_test";
+
+    std::string read_all(const std::filesystem::path &path)
+    {
+        std::ifstream      in(path, std::ios::binary);
+        std::ostringstream out;
+        out << in.rdbuf();
+        return out.str();
+    }
+
+    // 相对路径到内容
+    std::map<std::string, std::string> read_tree(const std::string &dir)
+    {
+        std::map<std::string, std::string> out;
+        for (const auto &entry : std::filesystem::recursive_directory_iterator(dir))
+        {
+            if (entry.is_regular_file())
+                out[std::filesystem::relative(entry.path(), dir).generic_string()] = read_all(entry.path());
+        }
+        return out;
+    }
+
+    std::string run(wz::File &file, wz::ExportOptions options, wz::ThreadPool &pool, wz::ExportResult &result)
+    {
+        std::ostringstream out;
+        result = wz::export_ndjson(file, out, options, pool);
+        return out.str();
+    }
+
+    size_t count(const std::string &text, const std::string &pattern)
+    {
+        size_t n = 0;
+        for (auto at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1))
+        {
+            ++n;
+        }
+        return n;
+    }
+
+    // 单线程与共享线程池(含较小的批)的输出逐字节相同，外部数据文件也相同
+    void check_deterministic(wz::File &file, size_t images)
+    {
+        wz::ThreadPool single(1);
+
+        const wz::ExportLayout layouts[]  = {wz::ExportLayout::ImagePerLine, wz::ExportLayout::PropertyPerLine};
+        const wz::PayloadMode  payloads[] = {wz::PayloadMode::None, wz::PayloadMode::Base64,
+                                             wz::PayloadMode::External};
+        for (auto layout : layouts)
+        {
+            for (auto mode : payloads)
+            {
+                wz::ExportOptions options;
+                options.layout   = layout;
+                options.payloads = mode;
+
+                options.payload_dir = wz::test::temp_path(test_name, "single");
+                std::filesystem::remove_all(options.payload_dir);
+                wz::ExportResult serial_result;
+                const auto       serial = run(file, options, single, serial_result);
+
+                options.payload_dir   = wz::test::temp_path(test_name, "shared");
+                options.max_in_flight = 3;
+                std::filesystem::remove_all(options.payload_dir);
+                wz::ExportResult shared_result;
+                const auto       shared = run(file, options, wz::ThreadPool::shared(), shared_result);
+
+                WZ_CHECK(!serial.empty() && serial == shared);
+                WZ_CHECK(serial_result.images == images && shared_result.images == images);
+                WZ_CHECK(serial_result.failed == 0 && shared_result.failed == 0);
+                WZ_CHECK(serial_result.bytes == serial.size() && shared_result.bytes == shared.size());
+                if (mode == wz::PayloadMode::External)
+                {
+                    const auto files = read_tree(wz::test::temp_path(test_name, "single"));
+                    WZ_CHECK(!files.empty() && files == read_tree(wz::test::temp_path(test_name, "shared")));
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    const auto path    = wz::test::temp_path(test_name, "export.wz");
+    const auto options = wz::test::small_archive();
+    if (!WZ_CHECK(wz::generate_archive(path, options)))
+        return wz::test::result();
+
+    std::vector<wz::Directory *> images;
+    u32                          image_offset = 0;
+    i32                          image_size   = 0;
+    u8                           key          = 0;
+    {
+        auto file = wz::test::open_archive(path);
+        if (!WZ_CHECK(file != nullptr))
+            return wz::test::result();
+        images = wz::collect_images(file->get_root());
+        check_deterministic(*file, images.size());
+
+        image_offset = images.front()->get_offset();
+        image_size   = images.front()->get_size();
+        key          = file->key[0];
+        images.clear();
+    }
+
+    // 把第一个image中名为"1"的画布改名为"0"：单字符名称内联为00 FF c 09，
+    // c为字符与0xAA及密钥首字节的异或，'1'与'0'只差最低位
+    const auto duplicate = wz::test::temp_path(test_name, "duplicate.wz");
+    {
+        auto       bytes   = read_all(path);
+        const auto encoded = static_cast<char>('1' ^ 0xAA ^ key);
+        const auto at      = bytes.find(std::string {'\x00', '\xFF', encoded, '\x09'}, image_offset);
+        if (!WZ_CHECK(at != std::string::npos && at < image_offset + static_cast<size_t>(image_size)))
+            return wz::test::result();
+        bytes[at + 2] = static_cast<char>(encoded ^ 1);
+        std::ofstream(duplicate, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    auto file = wz::test::open_archive(duplicate);
+    if (!WZ_CHECK(file != nullptr))
+        return wz::test::result();
+    images = wz::collect_images(file->get_root());
+
+    auto *frames = file->load_image(images.front())->get_child(u"frames");
+    if (!WZ_CHECK(frames != nullptr && frames->get_children().at(u"0").size() == 2))
+        return wz::test::result();
+    WZ_CHECK(frames->get_child(u"1") == nullptr);
+
+    // 嵌套布局中第二个"0"以"0~1"为键
+    wz::ExportResult result;
+    const auto       nested = run(*file, {}, wz::ThreadPool::shared(), result);
+    WZ_CHECK(result.failed == 0 && count(nested, "\"0~1\":") == 1);
+
+    // 两个画布各自写出外部文件
+    wz::ExportOptions external;
+    external.payloads    = wz::PayloadMode::External;
+    external.payload_dir = wz::test::temp_path(test_name, "duplicate");
+    const auto lines     = run(*file, external, wz::ThreadPool::shared(), result);
+    const auto files     = read_tree(external.payload_dir);
+    WZ_CHECK(result.failed == 0);
+    WZ_CHECK(count(lines, "/frames/0~1.zlib\"") == 1);
+    WZ_CHECK(count(lines, "\"file\":") == files.size());
+
+    check_deterministic(*file, images.size());
+
+    file.reset();
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
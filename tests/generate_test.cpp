@@ -0,0 +1,189 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include <wz/Pixel.hpp>
+#include <wz/Property.hpp>
+#include <wz/Sound.hpp>
+#include <wz/ThreadPool.hpp>
+#include <wz/Verify.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// generate_archive的输出必须能被File完整解析：目录与image数量、全部属性类型、画布解码、声音数据与校验和，
+// 且同样的参数在不同线程数下生成完全相同的字节
+
+namespace
+{
+    const char *test_name = "generate_test";
+
+    std::vector<char> read_file(const std::string &path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    }
+
+    void check_archive(const std::string &path, const wz::GeneratorOptions &options, const wz::GeneratorResult &result)
+    {
+        WZ_CHECK(std::filesystem::file_size(path) == result.bytes);
+
+        auto file = wz::test::open_archive(path);
+        if (!WZ_CHECK(file != nullptr))
+            return;
+
+        size_t directories = 0;
+        wz::test::walk(file->get_root(), [&](wz::Node *node) {
+            if (node->type == wz::Type::Directory)
+                ++directories;
+        });
+        const auto images = wz::collect_images(file->get_root());
+        WZ_CHECK(directories == result.directories);
+        WZ_CHECK(images.size() == result.images);
+
+        std::set<wz::Type>             types;
+        std::set<std::pair<i32, bool>> canvas_kinds; // (format + format2, 是否加密)
+        size_t                         canvases = 0, sounds = 0;
+        for (auto *dir : images)
+        {
+            auto *image = file->load_image(dir);
+            if (!WZ_CHECK(image != nullptr))
+                continue;
+            WZ_CHECK(image->link_uols().empty());
+
+            wz::test::walk(image, [&](wz::Node *node) {
+                types.insert(node->type);
+                if (node->type == wz::Type::Canvas)
+                {
+                    ++canvases;
+                    auto           *canvas = dynamic_cast<wz::Property<wz::WzCanvas> *>(node);
+                    const auto     &info   = canvas->get();
+                    std::vector<u8> pixels(wz::pixel::decoded_size(info));
+                    canvas_kinds.emplace(info.format + info.format2, info.is_encrypted);
+                    // 16x16块格式的宽高向上取整到块大小
+                    WZ_CHECK(info.width == options.canvas_width || info.width == (options.canvas_width + 15) / 16 * 16);
+                    WZ_CHECK(info.height == options.canvas_height ||
+                             info.height == (options.canvas_height + 15) / 16 * 16);
+                    WZ_CHECK(canvas->decode(pixels.data(), pixels.size()));
+                }
+                else if (node->type == wz::Type::Sound)
+                {
+                    ++sounds;
+                    auto       *sound = dynamic_cast<wz::Property<wz::WzSound> *>(node);
+                    const auto &info  = sound->get();
+                    WZ_CHECK(info.codec == wz::SoundCodec::PCM || info.codec == wz::SoundCodec::MP3);
+                    WZ_CHECK(info.size == static_cast<i32>(options.sound_bytes));
+
+                    wz::SoundStream stream(*sound);
+                    std::vector<u8> buffer(1000);
+                    size_t          total = 0, read;
+                    while ((read = stream.read(buffer.data(), buffer.size())) != 0)
+                    {
+                        total += read;
+                    }
+                    WZ_CHECK(total == options.sound_bytes);
+                }
+            });
+        }
+        WZ_CHECK(canvases == result.canvases);
+        WZ_CHECK(sounds == result.sounds);
+
+        // 生成器声明覆盖的全部属性类型都能解析出来
+        for (const auto type : {wz::Type::Int, wz::Type::UnsignedShort, wz::Type::Float, wz::Type::Double,
+                                wz::Type::String, wz::Type::SubProperty, wz::Type::Canvas, wz::Type::Vector2D,
+                                wz::Type::Convex2D, wz::Type::Sound, wz::Type::UOL})
+        {
+            if (!WZ_CHECK(types.count(type) != 0))
+                std::printf("  missing %s\n", wz::type_name(type));
+        }
+
+        // 每种画布格式都有加密与未加密两种
+        for (const auto format : {1, 2, 513, 517, 1026, 2050})
+        {
+            for (const auto encrypted : {false, true})
+            {
+                if (!WZ_CHECK(canvas_kinds.count({format, encrypted}) != 0))
+                    std::printf("  missing format %d %s\n", format, encrypted ? "encrypted" : "plain");
+            }
+        }
+
+        const auto verified = wz::verify(*file);
+        WZ_CHECK(verified.ok() && verified.images == images.size());
+    }
+}
+
+int main()
+{
+    const auto path    = wz::test::temp_path(test_name, "generated.wz");
+    const auto options = wz::test::small_archive();
+
+    wz::GeneratorResult result;
+    if (WZ_CHECK(wz::generate_archive(path, options, &result)))
+        check_archive(path, options, result);
+
+    // 不压缩的画布与gms之外的版本号
+    {
+        auto stored        = options;
+        stored.compression = 0;
+        stored.version     = 176;
+        const auto other   = wz::test::temp_path(test_name, "stored.wz");
+        if (WZ_CHECK(wz::generate_archive(other, stored, &result)))
+            check_archive(other, stored, result);
+    }
+
+    // 与线程数无关：单线程、限制同时生成的image数后字节完全相同
+    {
+        wz::ThreadPool single(1);
+        auto           limited    = options;
+        limited.max_in_flight     = 1;
+        const auto     sequential = wz::test::temp_path(test_name, "sequential.wz");
+        if (WZ_CHECK(wz::generate_archive(sequential, limited, nullptr, single)))
+            WZ_CHECK(read_file(sequential) == read_file(path));
+    }
+
+    // 不同的seed生成不同的内容
+    {
+        auto reseeded    = options;
+        reseeded.seed    = options.seed + 1;
+        const auto other = wz::test::temp_path(test_name, "reseeded.wz");
+        if (WZ_CHECK(wz::generate_archive(other, reseeded)))
+            WZ_CHECK(read_file(other) != read_file(path));
+    }
+
+    // reseed_path只改变该路径下的image，其余image的大小与校验和不变
+    {
+        auto reseeded        = options;
+        reseeded.reseed_path = u"Dir1/";
+        const auto other     = wz::test::temp_path(test_name, "partial.wz");
+        auto       before    = wz::test::open_archive(path);
+        if (WZ_CHECK(wz::generate_archive(other, reseeded)) && WZ_CHECK(before != nullptr))
+        {
+            auto                         after = wz::test::open_archive(other);
+            std::vector<wz::Directory *> old_images, new_images;
+            old_images = wz::collect_images(before->get_root());
+            if (WZ_CHECK(after != nullptr))
+                new_images = wz::collect_images(after->get_root());
+
+            size_t changed = 0;
+            if (WZ_CHECK(old_images.size() == new_images.size()))
+            {
+                for (size_t i = 0; i < old_images.size(); ++i)
+                {
+                    const bool same = old_images[i]->get_size() == new_images[i]->get_size() &&
+                                      old_images[i]->get_checksum() == new_images[i]->get_checksum();
+                    const auto relative = new_images[i]->path.substr(after->get_root()->path.size());
+                    const bool under    = relative.rfind(u"/Dir1/", 0) == 0;
+                    WZ_CHECK(same != under);
+                    changed += same ? 0 : 1;
+                }
+            }
+            // Dir1本身与它的两个子目录，各options.images个image
+            WZ_CHECK(changed == 3 * options.images);
+        }
+    }
+
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
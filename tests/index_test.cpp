@@ -0,0 +1,148 @@
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// save_index/load_index重建的目录树必须与parse的结果一致，过期或损坏的快照必须被拒绝
+
+namespace
+{
+    const char *test_name = "index_test";
+
+    struct Entry
+    {
+        wz::wzstring path;
+        wz::Type     type;
+        bool         image;
+        i32          size;
+        i32          checksum;
+        u32          offset;
+
+        bool operator==(const Entry &other) const
+        {
+            return path == other.path && type == other.type && image == other.image && size == other.size &&
+                   checksum == other.checksum && offset == other.offset;
+        }
+    };
+
+    std::vector<Entry> directory_tree(wz::File &file)
+    {
+        std::vector<Entry> entries;
+        wz::test::walk(file.get_root(), [&](wz::Node *node) {
+            auto *dir = dynamic_cast<wz::Directory *>(node);
+            if (WZ_CHECK(dir != nullptr))
+                entries.push_back({node->path, node->type, dir->is_image(), dir->get_size(), dir->get_checksum(),
+                                   dir->get_offset()});
+        });
+        return entries;
+    }
+
+    // image中全部节点的路径与类型
+    std::vector<std::pair<wz::wzstring, wz::Type>> image_tree(wz::File &file, wz::Directory *dir)
+    {
+        std::vector<std::pair<wz::wzstring, wz::Type>> nodes;
+        auto                                          *image = file.load_image(dir);
+        if (WZ_CHECK(image != nullptr))
+            wz::test::walk(image, [&](wz::Node *node) { nodes.emplace_back(node->path, node->type); });
+        return nodes;
+    }
+
+    bool load_into_new(const std::string &archive, const std::string &index, std::array<u8, 4> iv = wz::test::iv)
+    {
+        wz::File file(iv, archive.c_str());
+        const auto ok = file.load_index(index.c_str());
+        // 失败时目录树保持为空
+        if (!ok)
+            WZ_CHECK(file.get_root()->children_count() == 0);
+        return ok;
+    }
+}
+
+int main()
+{
+    const auto archive = wz::test::temp_path(test_name, "index.wz");
+    const auto index   = wz::test::temp_path(test_name, "index.idx");
+    const auto options = wz::test::small_archive();
+
+    if (!WZ_CHECK(wz::generate_archive(archive, options)))
+        return wz::test::result();
+
+    {
+        auto parsed = wz::test::open_archive(archive);
+        if (!WZ_CHECK(parsed != nullptr) || !WZ_CHECK(parsed->save_index(index.c_str())))
+            return wz::test::result();
+
+        wz::File indexed(wz::test::iv, archive.c_str());
+        WZ_CHECK(indexed.load_index(index.c_str()));
+
+        const auto expected = directory_tree(*parsed);
+        WZ_CHECK(!expected.empty());
+        WZ_CHECK(directory_tree(indexed) == expected);
+
+        // 从快照打开的文件解析出的image与parse后相同
+        const auto parsed_images  = wz::collect_images(parsed->get_root());
+        const auto indexed_images = wz::collect_images(indexed.get_root());
+        if (WZ_CHECK(parsed_images.size() == indexed_images.size()))
+        {
+            for (size_t i = 0; i < parsed_images.size(); ++i)
+            {
+                const auto nodes = image_tree(*parsed, parsed_images[i]);
+                WZ_CHECK(!nodes.empty() && nodes == image_tree(indexed, indexed_images[i]));
+            }
+        }
+    }
+
+    // IV不同
+    WZ_CHECK(!load_into_new(archive, index, {0, 0, 0, 0}));
+
+    // 快照被截断
+    {
+        const auto truncated = wz::test::temp_path(test_name, "truncated.idx");
+        std::filesystem::copy_file(index, truncated, std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::resize_file(truncated, std::filesystem::file_size(truncated) - 7);
+        WZ_CHECK(!load_into_new(archive, truncated));
+        std::filesystem::resize_file(truncated, 16);
+        WZ_CHECK(!load_into_new(archive, truncated));
+    }
+
+    // 名称表长度被篡改为name_units * 2回绕后与原值相同的值，名称偏移指向快照之外
+    {
+        const auto corrupt = wz::test::temp_path(test_name, "corrupt.idx");
+        std::filesystem::copy_file(index, corrupt, std::filesystem::copy_options::overwrite_existing);
+
+        std::fstream file(corrupt, std::ios::binary | std::ios::in | std::ios::out);
+        u64          name_units  = 0;
+        u32          name_offset = 0;
+        file.seekg(56);
+        file.read(reinterpret_cast<char *>(&name_units), sizeof(name_units));
+        name_offset = static_cast<u32>(name_units + 4096);
+        name_units += u64 {1} << 63;
+        file.seekp(56);
+        file.write(reinterpret_cast<const char *>(&name_units), sizeof(name_units));
+        file.seekp(64); // 第一个目录项的name_offset
+        file.write(reinterpret_cast<const char *>(&name_offset), sizeof(name_offset));
+        file.close();
+
+        WZ_CHECK(!load_into_new(archive, corrupt));
+    }
+
+    // 不存在的快照
+    WZ_CHECK(!load_into_new(archive, wz::test::temp_path(test_name, "missing.idx")));
+
+    // wz文件被替换后快照过期
+    {
+        auto changed = options;
+        changed.seed = options.seed + 1;
+        const auto replacement = wz::test::temp_path(test_name, "replacement.wz");
+        if (WZ_CHECK(wz::generate_archive(replacement, changed)))
+        {
+            std::filesystem::rename(replacement, archive);
+            WZ_CHECK(!load_into_new(archive, index));
+        }
+    }
+
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
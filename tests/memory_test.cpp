@@ -0,0 +1,108 @@
+#include <map>
+#include <sstream>
+
+#include <wz/Canvas.hpp>
+#include <wz/Memory.hpp>
+#include <wz/Pixel.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// File::get_memory_usage：目录树、已缓存的image、最大的image与画布缓存
+
+int main()
+{
+    const char *test_name = "memory_test";
+    const auto  path      = wz::test::temp_path(test_name, "memory.wz");
+    if (!WZ_CHECK(wz::generate_archive(path, wz::test::small_archive())))
+        return wz::test::result();
+
+    auto file = wz::test::open_archive(path);
+    if (!WZ_CHECK(file != nullptr))
+        return wz::test::result();
+    const auto images = wz::collect_images(file->get_root());
+
+    // parse之后只有目录树
+    const auto parsed = file->get_memory_usage();
+    WZ_CHECK(parsed.image_count == 0 && parsed.images.nodes == 0 && parsed.largest.empty());
+    WZ_CHECK(parsed.retired.nodes == 0 && parsed.texture_bytes == 0);
+    WZ_CHECK(parsed.keystream_bytes > 0);
+    WZ_CHECK(parsed.directories.total() == wz::measure_tree(file->get_root()).total());
+    {
+        size_t nodes = 1;
+        wz::test::walk(file->get_root(), [&](wz::Node *) { ++nodes; });
+        WZ_CHECK(parsed.directories.nodes == nodes);
+    }
+
+    // 加载一部分image：image_count与已加载的数量一致，每个image的占用与measure_tree相同
+    const size_t                   loaded_count = images.size() / 2;
+    std::map<wz::wzstring, size_t> loaded; // 路径到占用
+    for (size_t i = 0; i < loaded_count; ++i)
+    {
+        auto *image = file->load_image(images[i]);
+        if (WZ_CHECK(image != nullptr))
+            loaded[images[i]->path] = wz::measure_tree(image).total();
+    }
+    {
+        const auto report = file->get_memory_usage();
+        WZ_CHECK(report.image_count == loaded_count);
+        WZ_CHECK(report.directories.total() == parsed.directories.total());
+
+        size_t sum = 0;
+        for (const auto &[_, bytes] : loaded)
+        {
+            sum += bytes;
+        }
+        WZ_CHECK(report.images.total() == sum);
+
+        // largest包含全部已加载的image，按占用降序
+        if (WZ_CHECK(report.largest.size() == loaded_count))
+        {
+            for (size_t i = 0; i < report.largest.size(); ++i)
+            {
+                const auto &entry = report.largest[i];
+                WZ_CHECK(loaded.count(entry.path) == 1 && loaded[entry.path] == entry.memory.total());
+                if (i != 0)
+                    WZ_CHECK(report.largest[i - 1].memory.total() >= entry.memory.total());
+            }
+        }
+
+        // 只取前两个时与完整排序的前两个占用相同
+        const auto top = file->get_memory_usage(2);
+        if (WZ_CHECK(top.largest.size() == 2))
+        {
+            WZ_CHECK(top.largest[0].memory.total() == report.largest[0].memory.total());
+            WZ_CHECK(top.largest[1].memory.total() == report.largest[1].memory.total());
+        }
+        WZ_CHECK(file->get_memory_usage(0).largest.empty());
+
+        std::ostringstream text;
+        wz::write_text(report, text);
+        WZ_CHECK(text.str().find(std::to_string(loaded_count) + " images cached") != std::string::npos);
+    }
+
+    // 加载全部image后image_count等于image总数，各部分之和等于total
+    for (auto *dir : images)
+    {
+        WZ_CHECK(file->load_image(dir) != nullptr);
+    }
+    {
+        const auto report = file->get_memory_usage(images.size());
+        WZ_CHECK(report.image_count == images.size() && report.largest.size() == images.size());
+        WZ_CHECK(report.total() == report.directories.total() + report.images.total() + report.retired.total() +
+                                       report.keystream_bytes + report.texture_bytes);
+    }
+
+    // 画布缓存中的像素计入texture_bytes
+    {
+        auto *canvas = wz::collect_canvases(file->load_image(images.front())).front();
+        WZ_CHECK(canvas->get_pixels() != nullptr);
+        const auto report = file->get_memory_usage();
+        WZ_CHECK(report.texture_bytes == wz::pixel::decoded_size(canvas->get()));
+        WZ_CHECK(report.texture_budget >= report.texture_bytes);
+    }
+
+    file.reset();
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
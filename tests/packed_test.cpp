@@ -0,0 +1,162 @@
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include <wz/Packed.hpp>
+#include <wz/Pixel.hpp>
+#include <wz/Property.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// write_packed生成的.wzp必须与原wz文件逐节点一致：名称、类型、数值、字符串、画布像素、声音数据与UOL目标
+
+namespace
+{
+    const char *test_name = "packed_test";
+
+    struct Comparison
+    {
+        std::unordered_map<const wz::Node *, u32>                         indices; // 已比较的节点在.wzp中的下标
+        std::vector<std::pair<wz::Property<wz::WzUOL> *, wz::PackedNode>> uols;
+        size_t                                                            nodes = 0;
+    };
+
+    void compare_value(wz::Node *node, wz::PackedNode packed, Comparison &comparison)
+    {
+        switch (node->type)
+        {
+            case wz::Type::Int:
+                WZ_CHECK(packed.get_int() == dynamic_cast<wz::Property<i32> *>(node)->get());
+                break;
+            case wz::Type::UnsignedShort:
+                WZ_CHECK(packed.get_int() == dynamic_cast<wz::Property<u16> *>(node)->get());
+                break;
+            case wz::Type::Float:
+                WZ_CHECK(packed.get_double() == dynamic_cast<wz::Property<f32> *>(node)->get());
+                break;
+            case wz::Type::Double:
+                WZ_CHECK(packed.get_double() == dynamic_cast<wz::Property<f64> *>(node)->get());
+                break;
+            case wz::Type::String:
+                WZ_CHECK(packed.get_string() == dynamic_cast<wz::Property<wz::wzstring> *>(node)->get());
+                break;
+            case wz::Type::UOL: {
+                auto *uol = dynamic_cast<wz::Property<wz::WzUOL> *>(node);
+                WZ_CHECK(packed.get_string() == uol->get().uol);
+                comparison.uols.emplace_back(uol, packed);
+            }
+            break;
+            case wz::Type::Vector2D: {
+                const auto &expected = dynamic_cast<wz::Property<wz::WzVec2D> *>(node)->get();
+                const auto  actual   = packed.get_vector();
+                WZ_CHECK(actual.x == expected.x && actual.y == expected.y);
+            }
+            break;
+            case wz::Type::Canvas: {
+                auto       *canvas   = dynamic_cast<wz::Property<wz::WzCanvas> *>(node);
+                const auto &expected = canvas->get();
+                const auto  actual   = packed.get_canvas();
+                WZ_CHECK(actual.width == expected.width && actual.height == expected.height);
+                WZ_CHECK(actual.format + actual.format2 == expected.format + expected.format2);
+                WZ_CHECK(actual.uncompressed_size == expected.uncompressed_size);
+                WZ_CHECK(!actual.is_encrypted);
+
+                std::vector<u8> from_wz(wz::pixel::decoded_size(expected));
+                std::vector<u8> from_wzp(from_wz.size());
+                WZ_CHECK(canvas->decode(from_wz.data(), from_wz.size()));
+                WZ_CHECK(packed.decode(from_wzp.data(), from_wzp.size()));
+                WZ_CHECK(from_wz == from_wzp);
+            }
+            break;
+            case wz::Type::Sound: {
+                auto       *sound    = dynamic_cast<wz::Property<wz::WzSound> *>(node);
+                const auto &expected = sound->get();
+                const auto  actual   = packed.get_sound();
+                WZ_CHECK(actual.length == expected.length && actual.frequency == expected.frequency);
+                WZ_CHECK(actual.codec == expected.codec && actual.channels == expected.channels);
+                WZ_CHECK(actual.byte_rate == expected.byte_rate && actual.bits_per_sample == expected.bits_per_sample);
+
+                const auto original = sound->get_view();
+                const auto copy     = packed.get_sound_data();
+                WZ_CHECK(copy.size == original.size && std::memcmp(copy.data, original.data, copy.size) == 0);
+            }
+            break;
+            default:
+                break;
+        }
+    }
+
+    // 两边的子节点都按名称排序，按顺序一一对应
+    void compare(wz::File &file, wz::Node *node, wz::PackedNode packed, Comparison &comparison)
+    {
+        ++comparison.nodes;
+        comparison.indices[node] = packed.index();
+        compare_value(node, packed, comparison);
+
+        wz::Node *container = node;
+        if (node->type == wz::Type::Image)
+        {
+            container = file.load_image(dynamic_cast<wz::Directory *>(node));
+            if (!WZ_CHECK(container != nullptr))
+                return;
+        }
+
+        size_t i = 0;
+        for (auto &[name, list] : *container)
+        {
+            for (auto *child : list)
+            {
+                if (!WZ_CHECK(i < packed.children_count()))
+                    return;
+                const auto packed_child = packed.child_at(i++);
+                WZ_CHECK(packed_child.get_name() == name);
+                WZ_CHECK(packed_child.get_parent() == packed);
+                if (!WZ_CHECK(packed_child.get_type() == child->type))
+                    continue;
+                compare(file, child, packed_child, comparison);
+            }
+        }
+        WZ_CHECK(i == packed.children_count());
+    }
+}
+
+int main()
+{
+    const auto wz_path  = wz::test::temp_path(test_name, "packed.wz");
+    const auto wzp_path = wz::test::temp_path(test_name, "packed.wzp");
+
+    if (WZ_CHECK(wz::generate_archive(wz_path, wz::test::small_archive())))
+    {
+        auto file = wz::test::open_archive(wz_path);
+        if (WZ_CHECK(file != nullptr) && WZ_CHECK(wz::write_packed(*file, wzp_path.c_str())))
+        {
+            wz::PackedFile packed(wzp_path.c_str());
+            if (WZ_CHECK(packed.load()))
+            {
+                Comparison comparison;
+                compare(*file, file->get_root(), packed.get_root(), comparison);
+                WZ_CHECK(comparison.nodes == packed.node_count());
+                std::printf("compared %zu nodes, %zu UOLs\n", comparison.nodes, comparison.uols.size());
+
+                // UOL在两边解析到同一个节点
+                WZ_CHECK(!comparison.uols.empty());
+                for (auto &[uol, packed_uol] : comparison.uols)
+                {
+                    auto *target   = uol->get_uol();
+                    auto  resolved = packed_uol.resolve_uol();
+                    if (WZ_CHECK(target != nullptr && resolved.valid()))
+                        WZ_CHECK(comparison.indices[target] == resolved.index());
+                }
+
+                // 按路径查找与逐层访问得到同一个节点
+                const auto first = packed.get_root().child_at(0);
+                WZ_CHECK(packed.get_root().find_from_path(first.get_name()) == first);
+                WZ_CHECK(!packed.get_root().find_from_path(u"no/such/node").valid());
+            }
+        }
+    }
+
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
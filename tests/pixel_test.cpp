@@ -0,0 +1,163 @@
+#include <cstring>
+#include <vector>
+
+#include <wz/Pixel.hpp>
+
+#include "Test.hpp"
+
+// SIMD像素转换与画布解码必须与pixel::scalar逐字节一致
+// 长度覆盖0到若干个向量宽度之间的全部值，使每个实现的尾部路径都会执行
+
+namespace
+{
+    using ConvertFn = void (*)(const u8 *, u8 *, size_t, wz::PixelFormat);
+
+    constexpr wz::PixelFormat formats[] = {wz::PixelFormat::RGBA8888, wz::PixelFormat::BGRA8888};
+
+    void check_convert(ConvertFn convert, ConvertFn reference, size_t src_pixel_size, u32 seed)
+    {
+        std::vector<size_t> counts;
+        for (size_t count = 0; count <= 80; ++count)
+        {
+            counts.push_back(count);
+        }
+        counts.insert(counts.end(), {255, 256, 257, 1023, 4099});
+
+        for (const auto format : formats)
+        {
+            for (const auto count : counts)
+            {
+                // 源与目标都从奇数偏移开始，覆盖非对齐访问
+                const auto      src = wz::test::random_bytes(count * src_pixel_size + 1, seed + static_cast<u32>(count));
+                std::vector<u8> actual(count * 4 + 1, 0xCD);
+                std::vector<u8> expected(count * 4 + 1, 0xCD);
+
+                convert(src.data() + 1, actual.data() + 1, count, format);
+                reference(src.data() + 1, expected.data() + 1, count, format);
+                if (!WZ_CHECK(actual == expected))
+                {
+                    std::printf("  count %zu, format %d\n", count, static_cast<int>(format));
+                    return;
+                }
+            }
+        }
+    }
+
+    wz::WzCanvas make_canvas(i32 width, i32 height, wz::CanvasFormat format)
+    {
+        wz::WzCanvas canvas;
+        canvas.width   = width;
+        canvas.height  = height;
+        canvas.format  = static_cast<i32>(format);
+        canvas.format2 = 0;
+        return canvas;
+    }
+
+    size_t raw_size(i32 width, i32 height, wz::CanvasFormat format)
+    {
+        const auto pixels = static_cast<size_t>(width) * height;
+        switch (format)
+        {
+            case wz::CanvasFormat::BGRA4444:
+            case wz::CanvasFormat::RGB565:
+                return pixels * 2;
+            case wz::CanvasFormat::BGRA8888:
+                return pixels * 4;
+            case wz::CanvasFormat::RGB565Block:
+                return static_cast<size_t>(width / 16) * (height / 16) * 2;
+            case wz::CanvasFormat::DXT3:
+            case wz::CanvasFormat::DXT5:
+                return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * 16;
+        }
+        return 0;
+    }
+
+    // 由标量实现拼出的期望结果
+    std::vector<u8> reference_decode(const wz::WzCanvas &canvas, const u8 *src, wz::PixelFormat format)
+    {
+        const auto      width  = static_cast<size_t>(canvas.width);
+        const auto      height = static_cast<size_t>(canvas.height);
+        std::vector<u8> out(width * height * 4, 0);
+
+        switch (static_cast<wz::CanvasFormat>(canvas.format + canvas.format2))
+        {
+            case wz::CanvasFormat::BGRA4444:
+                wz::pixel::scalar::convert_bgra4444(src, out.data(), width * height, format);
+                break;
+            case wz::CanvasFormat::BGRA8888:
+                wz::pixel::scalar::convert_bgra8888(src, out.data(), width * height, format);
+                break;
+            case wz::CanvasFormat::RGB565:
+                wz::pixel::scalar::convert_rgb565(src, out.data(), width * height, format);
+                break;
+            case wz::CanvasFormat::RGB565Block:
+                for (size_t y = 0; y < height / 16 * 16; ++y)
+                {
+                    for (size_t x = 0; x < width / 16 * 16; ++x)
+                    {
+                        const auto block = (y / 16) * (width / 16) + x / 16;
+                        wz::pixel::scalar::convert_rgb565(src + block * 2, out.data() + (y * width + x) * 4, 1, format);
+                    }
+                }
+                break;
+            case wz::CanvasFormat::DXT3:
+                wz::pixel::scalar::decode_dxt3(src, canvas.width, canvas.height, out.data(), format);
+                break;
+            case wz::CanvasFormat::DXT5:
+                wz::pixel::scalar::decode_dxt5(src, canvas.width, canvas.height, out.data(), format);
+                break;
+        }
+        return out;
+    }
+
+    void check_decode(wz::CanvasFormat canvas_format, u32 seed)
+    {
+        const i32 sizes[][2] = {{1, 1}, {3, 5}, {7, 1}, {16, 16}, {17, 33}, {31, 16}, {64, 48}, {100, 3}, {129, 65}};
+
+        for (const auto format : formats)
+        {
+            for (const auto &size : sizes)
+            {
+                const auto canvas = make_canvas(size[0], size[1], canvas_format);
+                const auto src    = wz::test::random_bytes(raw_size(size[0], size[1], canvas_format), seed++);
+
+                // 不足一个16x16块的RGB565Block没有像素数据，decode应拒绝
+                if (src.empty())
+                {
+                    std::vector<u8> dst(wz::pixel::decoded_size(canvas));
+                    WZ_CHECK(!wz::pixel::decode(canvas, src.data(), src.size(), dst.data(), dst.size(), format));
+                    continue;
+                }
+
+                std::vector<u8> actual(wz::pixel::decoded_size(canvas), 0xCD);
+                if (!WZ_CHECK(wz::pixel::decode(canvas, src.data(), src.size(), actual.data(), actual.size(), format)))
+                    continue;
+                if (!WZ_CHECK(actual == reference_decode(canvas, src.data(), format)))
+                {
+                    std::printf("  format %d, %dx%d\n", static_cast<int>(canvas_format), size[0], size[1]);
+                    continue;
+                }
+
+                // 源数据或输出缓冲区不足时必须失败而不是越界
+                WZ_CHECK(!wz::pixel::decode(canvas, src.data(), src.size() - 1, actual.data(), actual.size(), format));
+                WZ_CHECK(!wz::pixel::decode(canvas, src.data(), src.size(), actual.data(), actual.size() - 1, format));
+            }
+        }
+    }
+}
+
+int main()
+{
+    check_convert(wz::pixel::convert_bgra4444, wz::pixel::scalar::convert_bgra4444, 2, 1);
+    check_convert(wz::pixel::convert_bgra8888, wz::pixel::scalar::convert_bgra8888, 4, 1000);
+    check_convert(wz::pixel::convert_rgb565, wz::pixel::scalar::convert_rgb565, 2, 2000);
+
+    check_decode(wz::CanvasFormat::BGRA4444, 10);
+    check_decode(wz::CanvasFormat::BGRA8888, 20);
+    check_decode(wz::CanvasFormat::RGB565, 30);
+    check_decode(wz::CanvasFormat::RGB565Block, 40);
+    check_decode(wz::CanvasFormat::DXT3, 50);
+    check_decode(wz::CanvasFormat::DXT5, 60);
+
+    return wz::test::result();
+}
@@ -0,0 +1,257 @@
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+#include <wz/Canvas.hpp>
+#include <wz/Pixel.hpp>
+#include <wz/Property.hpp>
+#include <wz/Verify.hpp>
+#include <wz/Watcher.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// reload按image比较新旧目录表：未变、移动、修改、新增与删除的计数，
+// 移动的image保留原来的节点并仍能解码，失效的节点与旧映射保留到release_retired
+
+namespace
+{
+    const char *test_name = "reload_test";
+
+    // 与补丁的发布方式相同：写到临时文件再rename到原路径
+    bool replace(const std::string &path, const wz::GeneratorOptions &options)
+    {
+        const auto staging = path + ".new";
+        if (!wz::generate_archive(staging, options))
+            return false;
+        std::filesystem::rename(staging, path);
+        return true;
+    }
+
+    bool same(const wz::ReloadStats &stats, size_t unchanged, size_t moved, size_t modified, size_t added,
+              size_t removed)
+    {
+        const auto ok = stats.unchanged == unchanged && stats.moved == moved && stats.modified == modified &&
+                        stats.added == added && stats.removed == removed;
+        if (!ok)
+        {
+            std::printf("  reload: %zu unchanged, %zu moved, %zu modified, %zu added, %zu removed\n", stats.unchanged,
+                        stats.moved, stats.modified, stats.added, stats.removed);
+        }
+        return ok;
+    }
+
+    std::vector<std::vector<u8>> decode_all(wz::Node *image)
+    {
+        std::vector<std::vector<u8>> out;
+        for (auto *canvas : wz::collect_canvases(image))
+        {
+            std::vector<u8> pixels(wz::pixel::decoded_size(canvas->get()));
+            WZ_CHECK(canvas->decode(pixels.data(), pixels.size()));
+            out.push_back(std::move(pixels));
+        }
+        return out;
+    }
+
+    std::vector<std::vector<u8>> cached_pixels(wz::Node *image)
+    {
+        std::vector<std::vector<u8>> out;
+        for (auto *canvas : wz::collect_canvases(image))
+        {
+            const auto pixels = canvas->get_pixels();
+            if (WZ_CHECK(pixels != nullptr))
+                out.push_back(*pixels);
+        }
+        return out;
+    }
+
+    // 只沿目录树查找，不加载image；find_from_path会加载image并在找不到时抛出异常
+    wz::Directory *find_image(wz::File &file, const wz::wzstring &path)
+    {
+        wz::Node *node  = file.get_root();
+        size_t    start = 0;
+        while (node != nullptr && start <= path.size())
+        {
+            auto end = path.find(u'/', start);
+            if (end == wz::wzstring::npos)
+                end = path.size();
+            node  = node->get_child(path.substr(start, end - start));
+            start = end + 1;
+        }
+        return dynamic_cast<wz::Directory *>(node);
+    }
+
+    size_t image_count(wz::File &file)
+    {
+        return wz::collect_images(file.get_root()).size();
+    }
+
+    void check_verify(wz::File &file)
+    {
+        const auto result = wz::verify(file);
+        WZ_CHECK(result.ok() && result.images == image_count(file));
+    }
+}
+
+int main()
+{
+    const auto path = wz::test::temp_path(test_name, "reload.wz");
+
+    // 原始归档：根目录、Dir0、Dir1与四个二级目录，各3个image，共21个
+    const auto original = wz::test::small_archive();
+
+    // 补丁：删除二级目录(12个image)，每个目录新增00003.img(3个)，Dir1下的image改变(3个)；
+    // 目录表变短，根目录与Dir0下未改变的6个image整体前移
+    auto patched        = original;
+    patched.depth       = 1;
+    patched.images      = 4;
+    patched.reseed_path = u"Dir1/";
+
+    if (!WZ_CHECK(wz::generate_archive(path, original)))
+        return wz::test::result();
+    auto file = wz::test::open_archive(path);
+    if (!WZ_CHECK(file != nullptr))
+        return wz::test::result();
+
+    // 加载全部image并在reload前取得各类节点的指针
+    {
+        const auto images = wz::collect_images(file->get_root());
+        for (auto *dir : images)
+        {
+            WZ_CHECK(file->load_image(dir) != nullptr);
+        }
+    }
+
+    auto *moved_dir    = find_image(*file, u"Dir0/00001.img");
+    auto *modified_dir = find_image(*file, u"Dir1/00000.img");
+    auto *removed_dir  = find_image(*file, u"Dir0/Dir1/00002.img");
+    if (!WZ_CHECK(moved_dir != nullptr && modified_dir != nullptr && removed_dir != nullptr))
+        return wz::test::result();
+
+    const auto removed_path   = removed_dir->path;
+    auto      *moved          = file->load_image(moved_dir);
+    auto      *modified       = file->load_image(modified_dir);
+    const auto moved_pixels   = decode_all(moved);
+    const auto moved_canvases = wz::collect_canvases(moved);
+    // 画布缓存以偏移为键，移动后旧偏移上的缓存必须失效
+    WZ_CHECK(cached_pixels(moved) == moved_pixels);
+
+    auto *modified_sound = dynamic_cast<wz::Property<wz::WzSound> *>(modified->find_from_path(u"sound0"));
+    if (!WZ_CHECK(modified_sound != nullptr))
+        return wz::test::result();
+    const auto            retained_view = modified_sound->get_view();
+    const std::vector<u8> retained_bytes(retained_view.begin(), retained_view.end());
+
+    // 第一次reload：各种改动同时出现
+    {
+        WZ_CHECK(replace(path, patched));
+
+        wz::ReloadStats stats;
+        WZ_CHECK(file->reload(&stats));
+        WZ_CHECK(same(stats, 0, 6, 3, 3, 12));
+        WZ_CHECK(image_count(*file) == 12);
+        check_verify(*file);
+
+        // 移动的image：目录节点、image节点与画布节点都是原来的，按新偏移解码出相同的像素
+        WZ_CHECK(find_image(*file, u"Dir0/00001.img") == moved_dir);
+        WZ_CHECK(file->load_image(moved_dir) == moved);
+        WZ_CHECK(wz::collect_canvases(moved) == moved_canvases);
+        WZ_CHECK(decode_all(moved) == moved_pixels);
+        WZ_CHECK(cached_pixels(moved) == moved_pixels);
+
+        // 修改的image：目录节点保留，image重新解析；旧节点与旧映射中的数据仍然可读
+        WZ_CHECK(find_image(*file, u"Dir1/00000.img") == modified_dir);
+        auto *reparsed = file->load_image(modified_dir);
+        WZ_CHECK(reparsed != nullptr && reparsed != modified);
+        WZ_CHECK(modified_sound->path == modified->path + u"/sound0");
+        WZ_CHECK(std::vector<u8>(retained_view.begin(), retained_view.end()) == retained_bytes);
+
+        // 删除与新增
+        WZ_CHECK(find_image(*file, u"Dir0/Dir1/00002.img") == nullptr);
+        WZ_CHECK(removed_dir->path == removed_path);
+        auto *added = find_image(*file, u"Dir0/00003.img");
+        WZ_CHECK(added != nullptr && file->load_image(added) != nullptr);
+        WZ_CHECK(file->get_memory_usage().retired.nodes != 0);
+    }
+
+    // 再次reload相同的内容：修改过的image的大小与校验和已更新，全部未变
+    {
+        WZ_CHECK(replace(path, patched));
+        wz::ReloadStats stats;
+        WZ_CHECK(file->reload(&stats));
+        WZ_CHECK(same(stats, 12, 0, 0, 0, 0));
+        check_verify(*file);
+    }
+
+    // 释放失效的节点与旧映射后，仍在使用的image不受影响
+    file->release_retired();
+    WZ_CHECK(file->get_memory_usage().retired.nodes == 0);
+    WZ_CHECK(decode_all(moved) == moved_pixels);
+
+    // 恢复原始归档：二级目录整体新增，00003.img被删除
+    {
+        WZ_CHECK(replace(path, original));
+        wz::ReloadStats stats;
+        WZ_CHECK(file->reload(&stats));
+        WZ_CHECK(same(stats, 0, 6, 3, 12, 3));
+        WZ_CHECK(image_count(*file) == 21);
+        check_verify(*file);
+        WZ_CHECK(decode_all(moved) == moved_pixels);
+
+        auto *restored = find_image(*file, u"Dir0/Dir1/00002.img");
+        WZ_CHECK(restored != nullptr && file->load_image(restored) != nullptr);
+    }
+
+    // reload失败(文件不是wz)时目录树保持原状
+    {
+        const auto staging = path + ".new";
+        std::filesystem::copy_file(path, staging);
+        std::filesystem::resize_file(staging, 0);
+        std::filesystem::resize_file(staging, 64);
+        std::filesystem::rename(staging, path);
+        WZ_CHECK(!file->reload());
+        WZ_CHECK(image_count(*file) == 21);
+        WZ_CHECK(find_image(*file, u"Dir0/00001.img") == moved_dir);
+    }
+
+#if defined(__linux__)
+    // FileWatcher：rename到原路径后在后台线程reload
+    {
+        WZ_CHECK(replace(path, original));
+        WZ_CHECK(file->reload());
+
+        std::mutex              guard;
+        std::condition_variable reloaded;
+        bool                    done = false;
+        bool                    ok   = false;
+        wz::ReloadStats         result;
+
+        wz::FileWatcher watcher(*file, guard, [&](bool success, const wz::ReloadStats &stats) {
+            std::lock_guard lock(guard);
+            ok     = success;
+            result = stats;
+            done   = true;
+            reloaded.notify_all();
+        });
+        if (WZ_CHECK(watcher.start(std::chrono::milliseconds(50))))
+        {
+            WZ_CHECK(replace(path, patched));
+
+            std::unique_lock lock(guard);
+            WZ_CHECK(reloaded.wait_for(lock, std::chrono::seconds(10), [&] { return done; }));
+            WZ_CHECK(ok && same(result, 0, 6, 3, 3, 12));
+            WZ_CHECK(image_count(*file) == 12);
+            lock.unlock();
+
+            watcher.stop();
+            WZ_CHECK(!watcher.running() && watcher.error() == 0);
+        }
+    }
+#endif
+
+    file.reset();
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
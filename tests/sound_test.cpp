@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include <wz/Canvas.hpp>
+#include <wz/Sound.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// SoundStream：分块read、next_chunk与seek的结果对照get_view，多个游标互相独立
+
+namespace
+{
+    const char *test_name = "sound_test";
+
+    bool equals(const std::vector<u8> &bytes, const u8 *data, size_t size)
+    {
+        return bytes.size() == size && (size == 0 || std::memcmp(bytes.data(), data, size) == 0);
+    }
+
+    // 以chunk字节为单位读到末尾
+    std::vector<u8> read_rest(wz::SoundStream &stream, size_t chunk)
+    {
+        std::vector<u8> out;
+        std::vector<u8> buffer(chunk);
+        while (const auto n = stream.read(buffer.data(), buffer.size()))
+        {
+            out.insert(out.end(), buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(n));
+        }
+        return out;
+    }
+}
+
+int main()
+{
+    // 大小不是块大小的倍数；PCM与MP3交替
+    auto options        = wz::test::small_archive();
+    options.sound_bytes = 5001;
+
+    const auto path = wz::test::temp_path(test_name, "sound.wz");
+    if (!WZ_CHECK(wz::generate_archive(path, options)))
+        return wz::test::result();
+
+    auto file = wz::test::open_archive(path);
+    if (!WZ_CHECK(file != nullptr))
+        return wz::test::result();
+
+    std::vector<wz::Property<wz::WzSound> *> sounds;
+    for (auto *dir : wz::collect_images(file->get_root()))
+    {
+        wz::test::walk(file->load_image(dir), [&](wz::Node *node) {
+            if (node->type == wz::Type::Sound)
+                sounds.push_back(dynamic_cast<wz::Property<wz::WzSound> *>(node));
+        });
+    }
+    if (!WZ_CHECK(sounds.size() == 21 * options.sounds))
+        return wz::test::result();
+
+    for (auto *sound : sounds)
+    {
+        const auto  view = sound->get_view();
+        const auto &info = sound->get();
+        WZ_CHECK(view.size == options.sound_bytes && static_cast<size_t>(info.size) == view.size);
+        WZ_CHECK(equals(sound->get_raw_data(), view.data, view.size));
+
+        wz::SoundStream stream(*sound);
+        WZ_CHECK(stream.size() == view.size && stream.tell() == 0 && !stream.eof());
+        WZ_CHECK(stream.format().codec == info.codec && stream.format().byte_rate == info.byte_rate);
+        WZ_CHECK(info.codec == wz::SoundCodec::PCM || info.codec == wz::SoundCodec::MP3);
+        WZ_CHECK(info.length == static_cast<i32>(static_cast<u64>(info.size) * 1000 / info.byte_rate));
+
+        // 分块read拼接后与视图相同，到达末尾后返回0
+        for (size_t chunk : {1, 7, 4096, 1 << 20})
+        {
+            stream.seek(0);
+            WZ_CHECK(equals(read_rest(stream, chunk), view.data, view.size));
+            WZ_CHECK(stream.eof() && stream.tell() == view.size);
+            u8 byte = 0;
+            WZ_CHECK(stream.read(&byte, 1) == 0);
+        }
+
+        // next_chunk直接指向mmap中的数据
+        stream.seek(0);
+        size_t position = 0;
+        bool   in_place = true;
+        for (auto chunk = stream.next_chunk(1000); !chunk.empty(); chunk = stream.next_chunk(1000))
+        {
+            in_place &= chunk.data == view.data + position && chunk.size == std::min<size_t>(1000, view.size - position);
+            position += chunk.size;
+        }
+        WZ_CHECK(in_place && position == view.size);
+
+        // seek到中间后读取剩余部分；长度为0的读取不移动游标；超出末尾时停在末尾
+        const auto middle = view.size / 2 + 3;
+        stream.seek(middle);
+        WZ_CHECK(stream.tell() == middle && stream.read(nullptr, 0) == 0 && stream.tell() == middle);
+        WZ_CHECK(equals(read_rest(stream, 64), view.data + middle, view.size - middle));
+        stream.seek(view.size + 100);
+        WZ_CHECK(stream.tell() == view.size && stream.eof() && stream.next_chunk(16).empty());
+
+        // 两个游标互不影响
+        wz::SoundStream other(*sound);
+        stream.seek(10);
+        u8 a[4], b[4];
+        WZ_CHECK(other.read(b, 4) == 4 && stream.read(a, 4) == 4);
+        WZ_CHECK(std::memcmp(a, view.data + 10, 4) == 0 && std::memcmp(b, view.data, 4) == 0);
+    }
+
+    // 多个线程同时读取同一个文件中的声音
+    {
+        std::atomic<size_t> matched {0};
+        wz::ThreadPool::shared().parallel_for(sounds.size() * 4, [&](size_t i) {
+            auto           *sound = sounds[i % sounds.size()];
+            wz::SoundStream stream(*sound);
+            const auto      view = sound->get_view();
+            if (equals(read_rest(stream, 333 + i), view.data, view.size))
+                matched.fetch_add(1);
+        });
+        WZ_CHECK(matched.load() == sounds.size() * 4);
+    }
+
+    file.reset();
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
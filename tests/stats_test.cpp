@@ -0,0 +1,104 @@
+#include <vector>
+
+#include <wz/Canvas.hpp>
+#include <wz/Pixel.hpp>
+#include <wz/Stats.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// File::get_stats：目录解析、load_image、画布解压与两级缓存的计数
+
+int main()
+{
+    const char *test_name = "stats_test";
+    const auto  path      = wz::test::temp_path(test_name, "stats.wz");
+    const auto  options   = wz::test::small_archive();
+
+    wz::GeneratorResult generated;
+    if (!WZ_CHECK(wz::generate_archive(path, options, &generated)))
+        return wz::test::result();
+
+    auto file = wz::test::open_archive(path);
+    if (!WZ_CHECK(file != nullptr))
+        return wz::test::result();
+
+    // parse之后：只有目录表被解析
+    const auto parsed = file->get_stats();
+    WZ_CHECK(parsed.directory_bytes > 0 && parsed.image_bytes == 0);
+    WZ_CHECK(parsed.bytes_read() == parsed.directory_bytes);
+    WZ_CHECK(parsed.nodes_of(wz::Type::Directory) == generated.directories);
+    WZ_CHECK(parsed.nodes_of(wz::Type::Image) == generated.images);
+    WZ_CHECK(parsed.nodes_of(wz::Type::Canvas) == 0);
+    WZ_CHECK(parsed.images_parsed == 0 && parsed.image_cache_hits == 0 && parsed.image_cache_misses == 0);
+    WZ_CHECK(parsed.canvases_inflated == 0);
+    WZ_CHECK(parsed.strings_decrypted > 0 && parsed.keystream_bytes > 0);
+
+    const auto images = wz::collect_images(file->get_root());
+    auto      *dir    = images.front();
+
+    // 第一次load_image解析image，第二次命中缓存
+    auto *image = file->load_image(dir);
+    if (!WZ_CHECK(image != nullptr))
+        return wz::test::result();
+    const auto loaded = file->get_stats();
+    WZ_CHECK(loaded.images_parsed == 1 && loaded.image_parse_failures == 0);
+    WZ_CHECK(loaded.image_cache_misses == 1 && loaded.image_cache_hits == 0);
+    WZ_CHECK(loaded.image_bytes == static_cast<u64>(dir->get_size()));
+    WZ_CHECK(loaded.directory_bytes == parsed.directory_bytes);
+    WZ_CHECK(loaded.strings_decrypted > parsed.strings_decrypted && loaded.string_block_refs > 0);
+    WZ_CHECK(loaded.nodes_of(wz::Type::Canvas) == options.canvases);
+    WZ_CHECK(loaded.nodes_of(wz::Type::Sound) == options.sounds);
+    WZ_CHECK(loaded.nodes_of(wz::Type::Convex2D) == 1);
+    WZ_CHECK(loaded.nodes_of(wz::Type::UOL) == 3); // frames/last、link与info/back
+    WZ_CHECK(loaded.total_nodes() > parsed.total_nodes());
+
+    WZ_CHECK(file->load_image(dir) == image);
+    const auto cached = file->get_stats();
+    WZ_CHECK(cached.images_parsed == 1 && cached.image_cache_hits == 1 && cached.image_cache_misses == 1);
+    WZ_CHECK(cached.total_nodes() == loaded.total_nodes());
+
+    // 解码：每个画布解压一次，字节数为压缩数据与解压结果的大小之和
+    const auto canvases   = wz::collect_canvases(image);
+    u64        compressed = 0, inflated = 0;
+    for (auto *canvas : canvases)
+    {
+        const auto &info = canvas->get();
+        compressed += static_cast<u64>(info.size);
+        inflated += static_cast<u64>(info.uncompressed_size);
+
+        std::vector<u8> pixels(wz::pixel::decoded_size(info));
+        WZ_CHECK(canvas->decode(pixels.data(), pixels.size()));
+    }
+    const auto decoded = file->get_stats();
+    WZ_CHECK(decoded.canvases_inflated == canvases.size());
+    WZ_CHECK(decoded.canvas_compressed_bytes == compressed);
+    WZ_CHECK(decoded.canvas_bytes_inflated == inflated);
+    WZ_CHECK(decoded.texture_cache_hits == 0 && decoded.texture_cache_misses == 0);
+
+    // 画布缓存：第一次get_pixels解压并缓存，第二次命中
+    WZ_CHECK(canvases.front()->get_pixels() != nullptr);
+    WZ_CHECK(canvases.front()->get_pixels() != nullptr);
+    const auto textures = file->get_stats();
+    WZ_CHECK(textures.texture_cache_misses == 1 && textures.texture_cache_hits == 1);
+    WZ_CHECK(textures.canvases_inflated == canvases.size() + 1);
+
+    // 多个线程同时加载：每个image只解析一次，计数不丢失
+    wz::ThreadPool::shared().parallel_for(images.size(), [&](size_t i) { (void) file->load_image(images[i]); });
+    const auto all = file->get_stats();
+    WZ_CHECK(all.images_parsed == generated.images);
+    WZ_CHECK(all.image_cache_misses == generated.images && all.image_cache_hits == 2);
+    WZ_CHECK(all.nodes_of(wz::Type::Canvas) == generated.canvases);
+    WZ_CHECK(all.nodes_of(wz::Type::Sound) == generated.sounds);
+
+    u64 image_bytes = 0;
+    for (auto *each : images)
+    {
+        image_bytes += static_cast<u64>(each->get_size());
+    }
+    WZ_CHECK(all.image_bytes == image_bytes);
+
+    file.reset();
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
@@ -0,0 +1,123 @@
+#include <vector>
+
+#include <wz/TextureCache.hpp>
+
+#include "Test.hpp"
+
+// 按LRU淘汰与内存预算；去重只在压缩数据、宽高与原始格式都相同时共享像素缓冲区
+
+namespace
+{
+    wz::TextureCache::Content content(i32 width, i32 height, i32 format)
+    {
+        return {0x1234567890ABCDEFull, 100, width, height, format};
+    }
+
+    std::vector<u8> pixels(i32 width, i32 height)
+    {
+        return std::vector<u8>(static_cast<size_t>(width) * height * 4, 0x5A);
+    }
+}
+
+int main()
+{
+    constexpr auto rgba = wz::PixelFormat::RGBA8888;
+
+    wz::TextureCache cache;
+    cache.set_deduplicate(true);
+
+    const auto original = content(16, 8, 2);
+    const auto shared   = cache.insert(0x100, rgba, pixels(16, 8), original);
+    WZ_CHECK(shared != nullptr);
+
+    // 完全相同的内容共享同一个缓冲区
+    WZ_CHECK(cache.find_duplicate(0x200, rgba, original) == shared);
+    WZ_CHECK(cache.find(0x200, rgba) == shared);
+
+    // 压缩数据相同但原始格式、宽高或输出格式不同时不能共享
+    WZ_CHECK(cache.find_duplicate(0x300, rgba, content(16, 8, 1)) == nullptr);
+    WZ_CHECK(cache.find_duplicate(0x300, rgba, content(16, 8, 517)) == nullptr);
+    WZ_CHECK(cache.find_duplicate(0x300, rgba, content(8, 16, 2)) == nullptr);
+    WZ_CHECK(cache.find_duplicate(0x300, rgba, content(32, 8, 2)) == nullptr);
+    WZ_CHECK(cache.find_duplicate(0x300, wz::PixelFormat::BGRA8888, original) == nullptr);
+
+    auto other_size            = original;
+    other_size.compressed_size = 101;
+    WZ_CHECK(cache.find_duplicate(0x300, rgba, other_size) == nullptr);
+
+    // 缓冲区大小与宽高不符时不共享
+    const auto short_content = content(4, 4, 1);
+    WZ_CHECK(cache.insert(0x400, rgba, std::vector<u8>(10), short_content) != nullptr);
+    WZ_CHECK(cache.find_duplicate(0x500, rgba, short_content) == nullptr);
+
+    WZ_CHECK(cache.stats().dedup_hits == 1);
+
+    // 关闭去重后不再按内容查找
+    cache.set_deduplicate(false);
+    WZ_CHECK(cache.find_duplicate(0x600, rgba, original) == nullptr);
+
+    // 预算为三个10x10画布：命中把项移到队首，超出预算时淘汰最久未使用的项
+    constexpr size_t tile = 10 * 10 * 4;
+    wz::TextureCache lru(tile * 3);
+    const auto       first = lru.insert(0x10, rgba, pixels(10, 10));
+    WZ_CHECK(lru.insert(0x20, rgba, pixels(10, 10)) != nullptr);
+    WZ_CHECK(lru.insert(0x30, rgba, pixels(10, 10)) != nullptr);
+    WZ_CHECK(lru.find(0x10, rgba) == first);
+    WZ_CHECK(lru.insert(0x40, rgba, pixels(10, 10)) != nullptr);
+    {
+        const auto stats = lru.stats();
+        WZ_CHECK(stats.entries == 3 && stats.resident_bytes == tile * 3 && stats.evictions == 1);
+    }
+    WZ_CHECK(lru.find(0x20, rgba) == nullptr);
+    WZ_CHECK(lru.find(0x30, rgba) != nullptr && lru.find(0x40, rgba) != nullptr);
+
+    // 已有相同键时返回已缓存的缓冲区，不重复计入内存
+    WZ_CHECK(lru.insert(0x10, rgba, pixels(10, 10)) == first);
+    WZ_CHECK(lru.stats().resident_bytes == tile * 3);
+
+    // 输出格式不同是不同的项
+    WZ_CHECK(lru.find(0x10, wz::PixelFormat::BGRA8888) == nullptr);
+    {
+        const auto stats = lru.stats();
+        WZ_CHECK(stats.hits == 3 && stats.misses == 2 && stats.hit_rate() == 3.0 / 5.0);
+    }
+
+    // 缩小预算立即淘汰：此时由新到旧为0x10、0x40、0x30
+    lru.set_budget(tile * 2);
+    WZ_CHECK(lru.find(0x30, rgba) == nullptr && lru.find(0x40, rgba) != nullptr);
+    {
+        const auto stats = lru.stats();
+        WZ_CHECK(stats.entries == 2 && stats.resident_bytes == tile * 2 && stats.evictions == 2);
+        WZ_CHECK(stats.budget_bytes == tile * 2);
+    }
+
+    // 超出预算的单个画布仍被保留，被淘汰的缓冲区在使用者释放前保持有效
+    const auto large = lru.insert(0x50, rgba, pixels(20, 20));
+    WZ_CHECK(lru.find(0x50, rgba) == large);
+    {
+        const auto stats = lru.stats();
+        WZ_CHECK(stats.entries == 1 && stats.resident_bytes == large->size() && stats.evictions == 4);
+    }
+    WZ_CHECK(lru.find(0x10, rgba) == nullptr && first->size() == tile && first->front() == 0x5A);
+
+    // 去重共享的缓冲区只计入一次，erase移除该偏移的所有格式
+    wz::TextureCache shared_cache(tile * 3);
+    shared_cache.set_deduplicate(true);
+    const auto tile_content = content(10, 10, 2);
+    const auto tile_pixels  = shared_cache.insert(0x10, rgba, pixels(10, 10), tile_content);
+    WZ_CHECK(shared_cache.find_duplicate(0x20, rgba, tile_content) == tile_pixels);
+    WZ_CHECK(shared_cache.insert(0x20, wz::PixelFormat::BGRA8888, pixels(10, 10)) != nullptr);
+    {
+        const auto stats = shared_cache.stats();
+        WZ_CHECK(stats.entries == 3 && stats.resident_bytes == tile * 2 && stats.evictions == 0);
+    }
+    shared_cache.erase(0x20);
+    WZ_CHECK(shared_cache.stats().entries == 1 && shared_cache.stats().resident_bytes == tile);
+    WZ_CHECK(shared_cache.find(0x10, rgba) == tile_pixels);
+
+    shared_cache.clear();
+    WZ_CHECK(shared_cache.stats().entries == 0 && shared_cache.stats().resident_bytes == 0);
+    WZ_CHECK(shared_cache.find_duplicate(0x30, rgba, tile_content) == nullptr);
+
+    return wz::test::result();
+}
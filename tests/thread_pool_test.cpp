@@ -0,0 +1,155 @@
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <wz/Canvas.hpp>
+#include <wz/Pixel.hpp>
+#include <wz/ThreadPool.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// ThreadPool：每个下标恰好执行一次、嵌套与当前线程内执行、异常传播，以及decode_canvases对照逐个解码
+
+namespace
+{
+    const char *test_name = "thread_pool_test";
+
+    // 每个下标恰好执行一次
+    bool covers(wz::ThreadPool &pool, size_t count)
+    {
+        std::unique_ptr<std::atomic<int>[]> calls(new std::atomic<int>[count]());
+        pool.parallel_for(count, [&](size_t i) { calls[i].fetch_add(1); });
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (calls[i].load() != 1)
+                return false;
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    wz::ThreadPool single(1);
+    wz::ThreadPool pool(4);
+    wz::ThreadPool other(2);
+    WZ_CHECK(single.size() == 1 && pool.size() == 4);
+    WZ_CHECK(wz::ThreadPool(0).size() >= 1);
+
+    // 不同的数量，包括少于线程数与不能整除的情况；同一个线程池可以反复使用
+    for (auto *each : {&single, &pool})
+    {
+        for (size_t count : {0, 1, 3, 4, 5, 100, 1001})
+        {
+            WZ_CHECK(covers(*each, count));
+        }
+    }
+
+    // 单线程线程池与只有一个任务时在调用线程上执行
+    {
+        const auto caller      = std::this_thread::get_id();
+        bool       inline_only = true;
+        single.parallel_for(8, [&](size_t) { inline_only &= std::this_thread::get_id() == caller; });
+        pool.parallel_for(1, [&](size_t) { inline_only &= std::this_thread::get_id() == caller; });
+        WZ_CHECK(inline_only);
+    }
+
+    // 嵌套调用：内层在外层任务所在的线程上顺序执行，不会死锁
+    {
+        constexpr size_t outer = 16, inner = 32;
+        std::atomic<int> calls[outer * inner] {};
+        std::atomic<int> foreign {0};
+        pool.parallel_for(outer, [&](size_t i) {
+            const auto thread = std::this_thread::get_id();
+            pool.parallel_for(inner, [&](size_t j) {
+                calls[i * inner + j].fetch_add(1);
+                foreign += std::this_thread::get_id() != thread ? 1 : 0;
+            });
+            // 工作线程中调用其他线程池同样直接执行
+            other.parallel_for(2, [&](size_t) { foreign += std::this_thread::get_id() != thread ? 1 : 0; });
+        });
+        bool once = true;
+        for (const auto &call : calls)
+        {
+            once &= call.load() == 1;
+        }
+        WZ_CHECK(once && foreign.load() == 0);
+    }
+
+    // 异常：其余任务照常执行，结束后在调用线程重新抛出，之后线程池仍可使用
+    {
+        constexpr size_t count = 200;
+        std::atomic<int> calls[count] {};
+        bool             thrown = false;
+        try
+        {
+            pool.parallel_for(count, [&](size_t i) {
+                calls[i].fetch_add(1);
+                if (i % 50 == 7)
+                    throw std::runtime_error("task failed");
+            });
+        }
+        catch (const std::runtime_error &error)
+        {
+            thrown = std::string(error.what()) == "task failed";
+        }
+        WZ_CHECK(thrown);
+        bool once = true;
+        for (const auto &call : calls)
+        {
+            once &= call.load() == 1;
+        }
+        WZ_CHECK(once);
+        WZ_CHECK(covers(pool, 100));
+
+        thrown = false;
+        try
+        {
+            single.parallel_for(4, [](size_t i) {
+                if (i == 2)
+                    throw std::runtime_error("inline");
+            });
+        }
+        catch (const std::runtime_error &)
+        {
+            thrown = true;
+        }
+        WZ_CHECK(thrown && covers(single, 4));
+    }
+
+    // decode_canvases与逐个decode的结果逐字节相同，与线程数无关
+    const auto path = wz::test::temp_path(test_name, "decode.wz");
+    if (!WZ_CHECK(wz::generate_archive(path, wz::test::small_archive())))
+        return wz::test::result();
+    {
+        auto file = wz::test::open_archive(path);
+        if (!WZ_CHECK(file != nullptr))
+            return wz::test::result();
+
+        const auto canvases = wz::collect_canvases(file->get_root());
+        WZ_CHECK(!canvases.empty());
+        for (const auto format : {wz::PixelFormat::RGBA8888, wz::PixelFormat::BGRA8888})
+        {
+            std::vector<std::vector<u8>> serial(canvases.size());
+            for (size_t i = 0; i < canvases.size(); ++i)
+            {
+                serial[i].resize(wz::pixel::decoded_size(canvases[i]->get()));
+                WZ_CHECK(canvases[i]->decode(serial[i].data(), serial[i].size(), format));
+            }
+
+            for (auto *each : {&single, &pool, &wz::ThreadPool::shared()})
+            {
+                std::vector<std::vector<u8>> outputs;
+                WZ_CHECK(wz::decode_canvases(canvases, outputs, format, *each) == canvases.size());
+                WZ_CHECK(outputs == serial);
+            }
+        }
+    }
+
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
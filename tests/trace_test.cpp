@@ -0,0 +1,138 @@
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <wz/Trace.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// trace::Scope与ChromeTraceSink；开启WZLIB_TRACING编译时检查库内部的parse_image等span
+
+namespace
+{
+    const char *test_name = "trace_test";
+
+    std::string write(const wz::trace::ChromeTraceSink &sink)
+    {
+        std::ostringstream out;
+        sink.write(out);
+        return out.str();
+    }
+
+    // 每行一个事件
+    std::vector<std::string> events(const std::string &json)
+    {
+        std::vector<std::string> out;
+        std::istringstream       in(json);
+        for (std::string line; std::getline(in, line);)
+        {
+            if (line.rfind("{\"name\":", 0) == 0)
+                out.push_back(line);
+        }
+        return out;
+    }
+
+    // "key":后的值，字符串去掉引号；值中不含引号与逗号
+    std::string field(const std::string &event, const std::string &key)
+    {
+        const auto pattern = "\"" + key + "\":";
+        auto       at      = event.find(pattern);
+        if (at == std::string::npos)
+            return {};
+        at += pattern.size();
+        if (event[at] == '"')
+            return event.substr(at + 1, event.find('"', at + 1) - at - 1);
+        return event.substr(at, event.find_first_of(",}", at) - at);
+    }
+}
+
+int main()
+{
+    wz::trace::ChromeTraceSink sink;
+    wz::trace::set_sink(&sink);
+    WZ_CHECK(wz::trace::get_sink() == &sink);
+
+    // Scope不依赖WZLIB_TRACING，用户代码可以记录自己的阶段
+    {
+        wz::trace::Scope scope("load map");
+        WZ_CHECK(scope.active());
+        scope.set_path(u"Map/Map0/000010000.img");
+        scope.set_bytes(100, 400);
+    }
+    {
+        wz::trace::Scope scope("cancelled");
+        scope.cancel();
+    }
+    {
+        wz::trace::Scope scope("finished");
+        scope.finish();
+        scope.finish();
+    }
+    {
+        const auto list = events(write(sink));
+        if (WZ_CHECK(sink.size() == 2 && list.size() == 2))
+        {
+            WZ_CHECK(field(list[0], "name") == "load map" && field(list[0], "ph") == "X");
+            WZ_CHECK(field(list[0], "path") == "Map/Map0/000010000.img");
+            WZ_CHECK(field(list[0], "bytes") == "100" && field(list[0], "output_bytes") == "400");
+            WZ_CHECK(field(list[1], "name") == "finished" && field(list[1], "path").empty());
+        }
+        sink.clear();
+        WZ_CHECK(sink.size() == 0 && events(write(sink)).empty());
+    }
+
+    // 没有sink时不记录
+    wz::trace::set_sink(nullptr);
+    {
+        wz::trace::Scope scope("ignored");
+        WZ_CHECK(!scope.active());
+    }
+    wz::trace::set_sink(&sink);
+
+    // 库内部的span：每个image一个带路径与字节数的parse_image
+    const auto path = wz::test::temp_path(test_name, "trace.wz");
+    if (!WZ_CHECK(wz::generate_archive(path, wz::test::small_archive())))
+        return wz::test::result();
+    sink.clear();
+    {
+        auto file = wz::test::open_archive(path);
+        if (!WZ_CHECK(file != nullptr))
+            return wz::test::result();
+
+        std::map<std::string, std::string> expected; // image路径到字节数
+        for (auto *dir : wz::collect_images(file->get_root()))
+        {
+            expected[wz::to_utf8(dir->path)] = std::to_string(dir->get_size());
+            WZ_CHECK(file->load_image(dir) != nullptr);
+        }
+
+        const auto list = events(write(sink));
+        WZ_CHECK(list.size() == sink.size());
+        if (!wz::trace::enabled())
+        {
+            // 未开启WZLIB_TRACING时库内部不产生span
+            WZ_CHECK(list.empty());
+        }
+        else
+        {
+            std::map<std::string, std::string> images;
+            size_t                             parses = 0;
+            for (const auto &event : list)
+            {
+                const auto name = field(event, "name");
+                if (name == "parse_image")
+                    images[field(event, "path")] = field(event, "bytes");
+                else if (name == "File::parse")
+                    parses += field(event, "path") == path ? 1 : 0;
+            }
+            WZ_CHECK(images == expected);
+            WZ_CHECK(parses == 1);
+        }
+    }
+
+    wz::trace::set_sink(nullptr);
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
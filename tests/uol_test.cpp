@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <vector>
+
+#include <wz/Canvas.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// link_uols与get_uol：循环引用(a->b->a)、不存在的目标、经过UOL的路径与正常解析
+
+namespace
+{
+    const char *test_name = "uol_test";
+
+    wz::Property<wz::WzUOL> *add_uol(wz::Node *parent, const wz::wzstring &name, const wz::wzstring &target)
+    {
+        auto *node = new wz::Property<wz::WzUOL>(wz::Type::UOL, parent->file, wz::WzUOL {target});
+        parent->appendChild(name, node);
+        return node;
+    }
+
+    wz::UolState state(const wz::Property<wz::WzUOL> *node)
+    {
+        return node->get().state;
+    }
+}
+
+int main()
+{
+    const auto path = wz::test::temp_path(test_name, "uol.wz");
+    if (!WZ_CHECK(wz::generate_archive(path, wz::test::small_archive())))
+        return wz::test::result();
+
+    auto file = wz::test::open_archive(path);
+    if (!WZ_CHECK(file != nullptr))
+        return wz::test::result();
+
+    // 生成的image中的UOL全部可以解析
+    auto *image = file->load_image(wz::collect_images(file->get_root()).front());
+    if (!WZ_CHECK(image != nullptr))
+        return wz::test::result();
+    WZ_CHECK(image->link_uols().empty());
+    auto *info = image->get_child(u"info");
+    WZ_CHECK(info != nullptr);
+
+    // 在已加载的image下追加链接
+    auto *fixtures = new wz::Property<wz::WzSubProp>(wz::Type::SubProperty, file.get());
+    image->appendChild(u"fixtures", fixtures);
+
+    auto *a       = add_uol(fixtures, u"a", u"b");
+    auto *b       = add_uol(fixtures, u"b", u"a");
+    auto *self    = add_uol(fixtures, u"self", u"self");
+    auto *through = add_uol(fixtures, u"through", u"a/x"); // 路径途经循环链接
+    auto *missing = add_uol(fixtures, u"missing", u"nothing/here");
+    auto *above   = add_uol(fixtures, u"above", u"../../../../../../../../x"); // 越过根目录
+    auto *ok      = add_uol(fixtures, u"ok", u"../info");
+    auto *alias   = add_uol(fixtures, u"alias", u"ok"); // 指向UOL时解析到最终目标
+
+    WZ_CHECK(state(a) == wz::UolState::Unresolved && state(missing) == wz::UolState::Unresolved);
+
+    // 返回值恰好是断开的链接
+    auto broken = image->link_uols();
+    std::sort(broken.begin(), broken.end());
+    std::vector<wz::Node *> expected {a, b, self, through, missing, above};
+    std::sort(expected.begin(), expected.end());
+    WZ_CHECK(broken == expected);
+
+    WZ_CHECK(state(a) == wz::UolState::Cyclic && state(b) == wz::UolState::Cyclic);
+    WZ_CHECK(state(self) == wz::UolState::Cyclic && state(through) == wz::UolState::Cyclic);
+    WZ_CHECK(state(missing) == wz::UolState::Dangling && state(above) == wz::UolState::Dangling);
+    for (auto *node : {a, b, self, through, missing, above})
+    {
+        WZ_CHECK(node->get_uol() == nullptr && node->get().target == nullptr);
+    }
+
+    WZ_CHECK(state(ok) == wz::UolState::Resolved && ok->get_uol() == info);
+    WZ_CHECK(state(alias) == wz::UolState::Resolved && alias->get_uol() == info);
+
+    // 状态已缓存：再次链接结果相同，生成的UOL不受影响
+    auto again = image->link_uols();
+    std::sort(again.begin(), again.end());
+    WZ_CHECK(again == expected);
+    WZ_CHECK(fixtures->link_uols().size() == expected.size());
+
+    file.reset();
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <wz/Verify.hpp>
+
+#include "Archive.hpp"
+#include "Test.hpp"
+
+// 校验和检查：完好的文件、改动一个字节、截断的文件与进度回调的约定
+
+namespace
+{
+    const char *test_name = "verify_test";
+
+    std::string read_all(const std::string &path)
+    {
+        std::ifstream      in(path, std::ios::binary);
+        std::ostringstream out;
+        out << in.rdbuf();
+        return out.str();
+    }
+
+    void write_all(const std::string &path, const std::string &bytes)
+    {
+        std::ofstream(path, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    // 进度单调不减，总量不变，最后一次调用时全部完成
+    wz::VerifyResult verify_with_progress(const wz::File &file, wz::ThreadPool &pool)
+    {
+        std::vector<wz::VerifyProgress> calls;
+        const auto result = wz::verify(file, [&](const wz::VerifyProgress &progress) { calls.push_back(progress); }, pool);
+
+        if (!WZ_CHECK(!calls.empty()))
+            return result;
+        for (size_t i = 0; i < calls.size(); ++i)
+        {
+            const auto &call = calls[i];
+            WZ_CHECK(call.images_total == result.images && call.bytes_total == result.bytes);
+            WZ_CHECK(call.images_done <= call.images_total && call.bytes_done <= call.bytes_total);
+            if (i != 0)
+            {
+                const auto &previous = calls[i - 1];
+                WZ_CHECK(call.images_done >= previous.images_done);
+                WZ_CHECK(call.bytes_done >= previous.bytes_done);
+                WZ_CHECK(call.issues >= previous.issues);
+            }
+        }
+
+        const auto &last = calls.back();
+        WZ_CHECK(last.images_done == last.images_total && last.bytes_done == last.bytes_total);
+        WZ_CHECK(last.issues == result.issues.size());
+        // 只有最后一次调用报告全部完成
+        WZ_CHECK(std::count_if(calls.begin(), calls.end(), [](const wz::VerifyProgress &call) {
+                     return call.images_done == call.images_total;
+                 }) == 1);
+        return result;
+    }
+
+    std::vector<wz::Directory *> by_offset(wz::File &file)
+    {
+        auto images = wz::collect_images(file.get_root());
+        std::sort(images.begin(), images.end(),
+                  [](wz::Directory *a, wz::Directory *b) { return a->get_offset() < b->get_offset(); });
+        return images;
+    }
+}
+
+int main()
+{
+    // 多路累加与逐字节求和相同，包括不足8字节的尾部
+    for (size_t size : {0, 1, 7, 8, 9, 4096 + 5})
+    {
+        const auto bytes = wz::test::random_bytes(size, static_cast<u32>(size));
+        i32        sum   = 0;
+        for (auto byte : bytes)
+        {
+            sum += byte;
+        }
+        WZ_CHECK(wz::image_checksum(bytes.data(), bytes.size()) == sum);
+    }
+
+    const auto path = wz::test::temp_path(test_name, "verify.wz");
+    if (!WZ_CHECK(wz::generate_archive(path, wz::test::small_archive())))
+        return wz::test::result();
+
+    wz::ThreadPool single(1);
+
+    // 完好的文件：全部image通过，字节数为各image大小之和
+    wz::wzstring middle_path, last_path;
+    u32          middle_offset = 0, last_offset = 0;
+    i32          middle_size = 0, last_size = 0;
+    {
+        auto file = wz::test::open_archive(path);
+        if (!WZ_CHECK(file != nullptr))
+            return wz::test::result();
+
+        const auto images = by_offset(*file);
+        u64        bytes  = 0;
+        for (auto *image : images)
+        {
+            bytes += static_cast<u64>(image->get_size());
+        }
+
+        for (auto *pool : {&single, &wz::ThreadPool::shared()})
+        {
+            const auto result = verify_with_progress(*file, *pool);
+            WZ_CHECK(result.ok() && result.images == images.size() && result.bytes == bytes);
+        }
+        WZ_CHECK(wz::verify(*file).ok());
+
+        const auto *middle = images[images.size() / 2];
+        const auto *last   = images.back();
+        middle_path        = middle->path;
+        middle_offset      = middle->get_offset();
+        middle_size        = middle->get_size();
+        last_path          = last->path;
+        last_offset        = last->get_offset();
+        last_size          = last->get_size();
+    }
+    const auto original = read_all(path);
+
+    // 改动一个字节：只有该image的校验和不符，差值为改动量
+    {
+        auto       bytes = original;
+        const auto at    = middle_offset + static_cast<size_t>(middle_size) / 2;
+        const auto old   = static_cast<u8>(bytes[at]);
+        const auto now   = static_cast<u8>(old ^ 0x10);
+        bytes[at]        = static_cast<char>(now);
+
+        const auto flipped = wz::test::temp_path(test_name, "flipped.wz");
+        write_all(flipped, bytes);
+        auto file = wz::test::open_archive(flipped);
+        if (WZ_CHECK(file != nullptr))
+        {
+            for (auto *pool : {&single, &wz::ThreadPool::shared()})
+            {
+                const auto result = verify_with_progress(*file, *pool);
+                if (WZ_CHECK(result.issues.size() == 1))
+                {
+                    const auto &issue = result.issues.front();
+                    WZ_CHECK(issue.path == middle_path && issue.offset == middle_offset && issue.size == middle_size);
+                    WZ_CHECK(!issue.out_of_range);
+                    WZ_CHECK(issue.actual - issue.expected == static_cast<i32>(now) - static_cast<i32>(old));
+                }
+            }
+        }
+    }
+
+    // 截断的文件：最后一个image超出文件末尾，不计算校验和
+    {
+        const auto truncated = wz::test::temp_path(test_name, "truncated.wz");
+        write_all(truncated, original.substr(0, last_offset + static_cast<size_t>(last_size) / 2));
+        auto file = wz::test::open_archive(truncated);
+        if (WZ_CHECK(file != nullptr))
+        {
+            const auto result = verify_with_progress(*file, wz::ThreadPool::shared());
+            if (WZ_CHECK(result.issues.size() == 1))
+            {
+                const auto &issue = result.issues.front();
+                WZ_CHECK(issue.path == last_path && issue.out_of_range && issue.actual == 0);
+            }
+        }
+    }
+
+    wz::test::remove_temp(test_name);
+    return wz::test::result();
+}
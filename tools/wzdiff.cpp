@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <wz/Diff.hpp>
+#include <wz/File.hpp>
+
+// 比较同一wz文件的两个版本，输出JSON变更集
+// 用法: wzdiff <old.wz> <new.wz> [iv] [--shallow] [-o out.json]
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::printf("usage: %s <old.wz> <new.wz> [iv] [--shallow] [-o out.json]\n", argv[0]);
+        return 1;
+    }
+
+    const char*     iv     = "00000000";
+    const char*     output = nullptr;
+    wz::DiffOptions options;
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--shallow")
+            options.deep = false;
+        else if (arg == "-o" && i + 1 < argc)
+            output = argv[++i];
+        else
+            iv = argv[i];
+    }
+
+    wz::File before(wz::keys::parse_iv(iv), argv[1]);
+    wz::File after(wz::keys::parse_iv(iv), argv[2]);
+    if (!before.parse() || !after.parse())
+    {
+        std::fprintf(stderr, "failed to parse input files\n");
+        return 1;
+    }
+
+    const auto start  = std::chrono::steady_clock::now();
+    const auto result = wz::diff(before, after, options);
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::fprintf(stderr,
+                 "%zu images compared, %zu unchanged, %zu changes in %.3f s\n",
+                 result.compared,
+                 result.unchanged,
+                 result.images.size(),
+                 elapsed.count());
+
+    if (output != nullptr)
+    {
+        std::ofstream out(output, std::ios::binary | std::ios::trunc);
+        wz::write_json(result, out);
+        return out ? 0 : 2;
+    }
+    wz::write_json(result, std::cout);
+    return 0;
+}
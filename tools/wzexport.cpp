@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <wz/Export.hpp>
+#include <wz/File.hpp>
+
+// 将wz文件导出为NDJSON
+// 用法: wzexport <file.wz> <out.ndjson|-> [iv] [--properties] [--base64|--payloads DIR] [--in-flight N]
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::printf("usage: %s <file.wz> <out.ndjson|-> [iv] [--properties] [--base64|--payloads DIR] [--in-flight N]\n", argv[0]);
+        return 1;
+    }
+
+    const char*       iv = "00000000";
+    wz::ExportOptions options;
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--properties")
+        {
+            options.layout = wz::ExportLayout::PropertyPerLine;
+        }
+        else if (arg == "--base64")
+        {
+            options.payloads = wz::PayloadMode::Base64;
+        }
+        else if (arg == "--payloads" && i + 1 < argc)
+        {
+            options.payloads    = wz::PayloadMode::External;
+            options.payload_dir = argv[++i];
+        }
+        else if (arg == "--in-flight" && i + 1 < argc)
+        {
+            options.max_in_flight = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            iv = argv[i];
+        }
+    }
+
+    wz::File file(wz::keys::parse_iv(iv), argv[1]);
+    if (!file.parse())
+    {
+        std::fprintf(stderr, "failed to parse %s\n", argv[1]);
+        return 1;
+    }
+
+    std::ofstream file_out;
+    std::ostream* out = &std::cout;
+    if (std::string(argv[2]) != "-")
+    {
+        file_out.open(argv[2], std::ios::binary | std::ios::trunc);
+        out = &file_out;
+    }
+
+    const auto start  = std::chrono::steady_clock::now();
+    const auto result = wz::export_ndjson(file, *out, options);
+    out->flush();
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::fprintf(stderr,
+                 "exported %zu images (%zu failed), %.2f MiB in %.3f s\n",
+                 result.images,
+                 result.failed,
+                 result.bytes / 1048576.0,
+                 elapsed.count());
+
+    return result.failed == 0 && *out ? 0 : 2;
+}
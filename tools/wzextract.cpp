@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <wz/Extract.hpp>
+#include <wz/File.hpp>
+
+// 将wz文件中的声音与画布原始数据导出为文件
+// 用法: wzextract <file.wz> <out_dir> [iv: gms|kms|8位十六进制, 默认00000000] [--sounds|--canvases] [--threads N]
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::printf("usage: %s <file.wz> <out_dir> [iv] [--sounds|--canvases] [--threads N]\n", argv[0]);
+        return 1;
+    }
+
+    const char* iv       = "00000000";
+    bool        sounds   = true;
+    bool        canvases = true;
+    size_t      threads  = 0;
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--sounds")
+            canvases = false;
+        else if (arg == "--canvases")
+            sounds = false;
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        else
+            iv = argv[i];
+    }
+
+    wz::File file(wz::keys::parse_iv(iv), argv[1]);
+    if (!file.parse())
+    {
+        std::printf("failed to parse %s\n", argv[1]);
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto tasks = wz::collect_raw_assets(file, argv[2], sounds, canvases);
+    const auto parsed = std::chrono::steady_clock::now();
+
+    wz::ThreadPool pool(threads);
+    const auto     result = wz::extract(file, tasks, pool);
+
+    const std::chrono::duration<double> collect_time = parsed - start;
+    const std::chrono::duration<double> write_time   = std::chrono::steady_clock::now() - parsed;
+
+    std::printf("collected %zu assets in %.3f s\n", tasks.size(), collect_time.count());
+    std::printf("wrote %zu files (%zu failed), %.2f MiB in %.3f s, %.1f MiB/s\n",
+                result.written,
+                result.failed,
+                result.bytes / 1048576.0,
+                write_time.count(),
+                result.bytes / 1048576.0 / write_time.count());
+
+    return result.failed == 0 ? 0 : 2;
+}
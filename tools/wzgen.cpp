@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <wz/Generate.hpp>
+#include <wz/Wz.hpp>
+
+// 生成合成的wz文件，用于测试与性能测量
+// 用法: wzgen <out.wz> [--iv gms|kms|<hex>] [--version N] [--depth N] [--fanout N] [--images N]
+//             [--canvases N] [--canvas WxH] [--sounds N] [--sound-bytes N] [--level 0-9] [--seed N]
+// 文件大小约为 目录数 * images * (canvases * 画布压缩后大小 + sounds * sound-bytes)，
+// 例如 --depth 3 --fanout 8 --images 4 --canvas 512x512 --level 0 约为3GB
+
+namespace
+{
+    void usage(const char* program)
+    {
+        std::printf("usage: %s <out.wz> [--iv gms|kms|<hex>] [--version N] [--depth N] [--fanout N] [--images N]\n"
+                    "       [--canvases N] [--canvas WxH] [--sounds N] [--sound-bytes N] [--level 0-9] [--seed N]\n",
+                    program);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    wz::GeneratorOptions options;
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+
+        const std::string value = argv[++i];
+        const auto        number = std::strtoull(value.c_str(), nullptr, 10);
+        if (arg == "--iv")
+            options.iv = wz::keys::parse_iv(value);
+        else if (arg == "--version")
+            options.version = static_cast<i16>(number);
+        else if (arg == "--depth")
+            options.depth = static_cast<u32>(number);
+        else if (arg == "--fanout")
+            options.fanout = static_cast<u32>(number);
+        else if (arg == "--images")
+            options.images = static_cast<u32>(number);
+        else if (arg == "--canvases")
+            options.canvases = static_cast<u32>(number);
+        else if (arg == "--canvas")
+        {
+            options.canvas_width  = std::atoi(value.c_str());
+            const auto separator  = value.find('x');
+            options.canvas_height = separator == std::string::npos ? options.canvas_width : std::atoi(value.c_str() + separator + 1);
+        }
+        else if (arg == "--sounds")
+            options.sounds = static_cast<u32>(number);
+        else if (arg == "--sound-bytes")
+            options.sound_bytes = static_cast<u32>(number);
+        else if (arg == "--level")
+            options.compression = static_cast<int>(number);
+        else if (arg == "--seed")
+            options.seed = number;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const auto           start = std::chrono::steady_clock::now();
+    wz::GeneratorResult result;
+    if (!wz::generate_archive(argv[1], options, &result))
+    {
+        std::printf("failed to write %s\n", argv[1]);
+        return 1;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("%zu directories, %zu images, %zu canvases, %zu sounds, %.2f MiB in %.3f s (%.1f MiB/s)\n",
+                result.directories,
+                result.images,
+                result.canvases,
+                result.sounds,
+                result.bytes / 1048576.0,
+                elapsed.count(),
+                result.bytes / 1048576.0 / elapsed.count());
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <wz/Canvas.hpp>
+#include <wz/Directory.hpp>
+#include <wz/File.hpp>
+#include <wz/Memory.hpp>
+#include <wz/ThreadPool.hpp>
+
+// 加载wz文件中的全部image，输出目录树、image、密钥流与画布缓存的内存占用以及占用最多的image
+// 用法: wzmem <file.wz> [iv] [--top N] [--decode]
+// --decode 同时把全部画布解码进画布缓存(受缓存预算限制)
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::printf("usage: %s <file.wz> [iv] [--top N] [--decode]\n", argv[0]);
+        return 1;
+    }
+
+    const char* iv     = "00000000";
+    size_t      top    = 20;
+    bool        decode = false;
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--top" && i + 1 < argc)
+            top = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--decode")
+            decode = true;
+        else
+            iv = argv[i];
+    }
+
+    wz::File file(wz::keys::parse_iv(iv), argv[1]);
+    if (!file.parse())
+    {
+        std::printf("failed to parse %s\n", argv[1]);
+        return 1;
+    }
+
+    const auto images = wz::collect_images(file.get_root());
+    wz::ThreadPool::shared().parallel_for(images.size(), [&](size_t i) {
+        auto* image = file.load_image(images[i]);
+        if (decode && image != nullptr)
+        {
+            for (auto* canvas : wz::collect_canvases(image))
+            {
+                (void) canvas->get_pixels();
+            }
+        }
+    });
+
+    wz::write_text(file.get_memory_usage(top), std::cout);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <wz/File.hpp>
+#include <wz/Packed.hpp>
+
+// 将wz文件转换为预解析的.wzp格式，并重新加载以确认输出可用
+// 用法: wzpack <file.wz> <out.wzp> [iv: gms|kms|8位十六进制, 默认00000000]
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::printf("usage: %s <file.wz> <out.wzp> [iv]\n", argv[0]);
+        return 1;
+    }
+
+    auto     start = std::chrono::steady_clock::now();
+    wz::File file(wz::keys::parse_iv(argc > 3 ? argv[3] : "00000000"), argv[1]);
+    if (!file.parse())
+    {
+        std::printf("failed to parse %s\n", argv[1]);
+        return 1;
+    }
+    std::printf("parsed %s in %.3f s\n", argv[1], seconds_since(start));
+
+    start = std::chrono::steady_clock::now();
+    if (!wz::write_packed(file, argv[2]))
+    {
+        std::printf("failed to write %s\n", argv[2]);
+        return 1;
+    }
+    std::printf("wrote %s in %.3f s\n", argv[2], seconds_since(start));
+
+    start = std::chrono::steady_clock::now();
+    wz::PackedFile packed(argv[2]);
+    if (!packed.load())
+    {
+        std::printf("failed to load %s\n", argv[2]);
+        return 1;
+    }
+    std::printf("loaded %zu nodes in %.3f ms\n", packed.node_count(), seconds_since(start) * 1e3);
+
+    return 0;
+}
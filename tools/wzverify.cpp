@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <wz/File.hpp>
+#include <wz/Verify.hpp>
+
+// 校验wz文件中每个image的校验和，发现损坏时返回非0
+// 用法: wzverify <file.wz> [iv] [--quiet]
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::printf("usage: %s <file.wz> [iv] [--quiet]\n", argv[0]);
+        return 1;
+    }
+
+    const char* iv    = "00000000";
+    bool        quiet = false;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--quiet")
+            quiet = true;
+        else
+            iv = argv[i];
+    }
+
+    wz::File file(wz::keys::parse_iv(iv), argv[1]);
+    if (!file.parse())
+    {
+        std::printf("failed to parse %s\n", argv[1]);
+        return 1;
+    }
+
+    const auto start  = std::chrono::steady_clock::now();
+    const auto result = wz::verify(file, [&](const wz::VerifyProgress& progress) {
+        if (!quiet)
+        {
+            std::fprintf(stderr,
+                         "\r%zu/%zu images, %.1f%%, %zu bad",
+                         progress.images_done,
+                         progress.images_total,
+                         progress.bytes_total == 0 ? 100.0 : 100.0 * progress.bytes_done / progress.bytes_total,
+                         progress.issues);
+        }
+    });
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (!quiet)
+        std::fprintf(stderr, "\n");
+
+    for (const auto& issue : result.issues)
+    {
+        if (issue.out_of_range)
+        {
+            std::printf("TRUNCATED %s offset=%u size=%d\n", wz::to_utf8(issue.path).c_str(), issue.offset, issue.size);
+        }
+        else
+        {
+            std::printf("CHECKSUM  %s offset=%u size=%d expected=%d actual=%d\n",
+                        wz::to_utf8(issue.path).c_str(),
+                        issue.offset,
+                        issue.size,
+                        issue.expected,
+                        issue.actual);
+        }
+    }
+
+    std::printf("%zu images, %.2f MiB in %.3f s (%.1f MiB/s), %zu bad\n",
+                result.images,
+                result.bytes / 1048576.0,
+                elapsed.count(),
+                result.bytes / 1048576.0 / elapsed.count(),
+                result.issues.size());
+
+    return result.ok() ? 0 : 2;
+}